@@ -0,0 +1,113 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <vector>
+#include <amx/amx.h>
+#include "amxhandler.h"
+#include "benchmark.h"
+
+// Compares looking up the handler of an AMX in one of its user data slots
+// with the map lookup that is used when all slots are taken.
+
+using namespace amxprof;
+
+namespace {
+
+const int kNumScripts = 20;
+const int kNumLookups = 256;
+
+// AMXHandler keeps a separate map for each handler type, so each case
+// gets its own type.
+class SlotHandler : public AMXHandler<SlotHandler> {
+ public:
+  explicit SlotHandler(AMX *amx) : AMXHandler<SlotHandler>(amx) {}
+};
+
+class MapHandler : public AMXHandler<MapHandler> {
+ public:
+  explicit MapHandler(AMX *amx) : AMXHandler<MapHandler>(amx) {}
+};
+
+// Hooks run for scripts in no particular order.
+std::vector<AMX*> GetLookupOrder(std::vector<AMX> &amxs) {
+  std::vector<AMX*> order;
+  unsigned long state = 12345;
+  for (int i = 0; i < kNumLookups; i++) {
+    state = state * 1103515245 + 12345;
+    order.push_back(&amxs[(state >> 8) % amxs.size()]);
+  }
+  return order;
+}
+
+template<typename T>
+class HandlerLookup : public benchmark::Benchmark {
+ public:
+  explicit HandlerLookup(const std::vector<AMX*> &order) : order_(order) {}
+
+  virtual void Run(long iterations) {
+    long result = 0;
+    for (long i = 0; i < iterations; i++) {
+      result += T::GetHandler(order_[i % kNumLookups]) != 0;
+    }
+    benchmark::UseResult(result);
+  }
+
+ private:
+  const std::vector<AMX*> &order_;
+};
+
+} // anonymous namespace
+
+BENCHMARK(AMXHandler) {
+  AMX zero_amx;
+  std::memset(&zero_amx, 0, sizeof(zero_amx));
+
+  std::vector<AMX> slot_amxs(kNumScripts, zero_amx);
+  for (int i = 0; i < kNumScripts; i++) {
+    SlotHandler::CreateHandler(&slot_amxs[i]);
+  }
+
+  // Other plugins have taken all user data slots of these.
+  std::vector<AMX> map_amxs(kNumScripts, zero_amx);
+  for (int i = 0; i < kNumScripts; i++) {
+    for (int j = 0; j < AMX_USERNUM; j++) {
+      map_amxs[i].usertags[j] = AMX_USERTAG('T', 'a', 'g', '0' + j);
+    }
+    MapHandler::CreateHandler(&map_amxs[i]);
+  }
+
+  std::vector<AMX*> slot_order = GetLookupOrder(slot_amxs);
+  HandlerLookup<SlotHandler> slot_lookup(slot_order);
+  benchmark::Run("GetHandler (user data slot)", &slot_lookup);
+
+  std::vector<AMX*> map_order = GetLookupOrder(map_amxs);
+  HandlerLookup<MapHandler> map_lookup(map_order);
+  benchmark::Run("GetHandler (map)", &map_lookup);
+
+  for (int i = 0; i < kNumScripts; i++) {
+    SlotHandler::DestroyHandler(&slot_amxs[i]);
+    MapHandler::DestroyHandler(&map_amxs[i]);
+  }
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "amxprof/clock.h"
+#include "amxprof/duration.h"
+#include "benchmark.h"
+
+namespace amxprof {
+namespace benchmark {
+
+namespace {
+
+// Each benchmark runs for at least this long.
+const Milliseconds kMinRunTime(500);
+
+struct GroupInfo {
+  const char *name;
+  BenchmarkGroup group;
+};
+
+std::vector<GroupInfo> &GetGroups() {
+  // Registrars run during static initialization, possibly before globals
+  // of this file are constructed.
+  static std::vector<GroupInfo> groups;
+  return groups;
+}
+
+volatile long result_sink = 0;
+
+} // anonymous namespace
+
+BenchmarkRegistrar::BenchmarkRegistrar(const char *name,
+                                       BenchmarkGroup group) {
+  GroupInfo info;
+  info.name = name;
+  info.group = group;
+  GetGroups().push_back(info);
+}
+
+void RunAllBenchmarks(const char *filter) {
+  const std::vector<GroupInfo> &groups = GetGroups();
+  for (std::size_t i = 0; i < groups.size(); i++) {
+    if (filter == 0 || std::strstr(groups[i].name, filter) != 0) {
+      std::cout << groups[i].name << ":" << std::endl;
+      groups[i].group();
+    }
+  }
+}
+
+void Run(const char *name, Benchmark *benchmark) {
+  long iterations = 1;
+  Nanoseconds time;
+
+  for (;;) {
+    TimePoint start = Clock::Now();
+    benchmark->Run(iterations);
+    time = Clock::Now() - start;
+    if (!(time < kMinRunTime)) {
+      break;
+    }
+    iterations *= 2;
+  }
+
+  double ns_per_iteration =
+    static_cast<double>(time.count()) / static_cast<double>(iterations);
+  std::cout << "  " << std::left << std::setw(40) << name
+            << std::right << std::setw(12) << std::fixed
+            << std::setprecision(1) << ns_per_iteration << " ns"
+            << std::endl;
+}
+
+void UseResult(long result) {
+  result_sink += result;
+}
+
+} // namespace benchmark
+} // namespace amxprof
+
+int main(int argc, char **argv) {
+  amxprof::benchmark::RunAllBenchmarks(argc > 1 ? argv[1] : 0);
+  return 0;
+}
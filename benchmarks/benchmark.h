@@ -0,0 +1,70 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_BENCHMARK_H
+#define AMXPROF_BENCHMARK_H
+
+namespace amxprof {
+namespace benchmark {
+
+// A piece of code to be timed. Run() must do the same amount of work in
+// each of the given number of iterations.
+class Benchmark {
+ public:
+  virtual ~Benchmark() {}
+  virtual void Run(long iterations) = 0;
+};
+
+typedef void (*BenchmarkGroup)();
+
+// Adds a group of benchmarks to the list run by RunAllBenchmarks(). Use
+// the BENCHMARK macro instead of creating these directly.
+class BenchmarkRegistrar {
+ public:
+  BenchmarkRegistrar(const char *name, BenchmarkGroup group);
+};
+
+// Runs the groups whose names contain the filter (all if it's null).
+void RunAllBenchmarks(const char *filter);
+
+// Runs the benchmark with more and more iterations until it takes long
+// enough to be measured, then prints the time per iteration.
+void Run(const char *name, Benchmark *benchmark);
+
+// Keeps the compiler from optimizing away a computation whose result is
+// otherwise unused.
+void UseResult(long result);
+
+} // namespace benchmark
+} // namespace amxprof
+
+// Defines a function that sets up and runs one or more benchmarks with
+// benchmark::Run().
+#define BENCHMARK(name) \
+  static void name##Benchmark(); \
+  static amxprof::benchmark::BenchmarkRegistrar \
+    name##Registrar(#name, name##Benchmark); \
+  static void name##Benchmark()
+
+#endif // !AMXPROF_BENCHMARK_H
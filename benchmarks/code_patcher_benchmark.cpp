@@ -0,0 +1,221 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <vector>
+#include <amx/amx.h>
+#include "amxhandler.h"
+#include "amxprof/amx_utils.h"
+#include "amxprof/code_patcher.h"
+#include "amxprof/profiler.h"
+#include "benchmark.h"
+#include "fake_amx.h"
+
+// Measures what removing redundant BREAK instructions (bytecode mode)
+// saves per iteration of a tight loop. The VM isn't part of the plugin, so
+// the code is run by a minimal interpreter that, like amx_Exec(), calls
+// the debug hook on every BREAK. The hook goes through the same handler
+// lookup as the plugin's.
+
+using namespace amxprof;
+
+namespace {
+
+// Locals of the function, relative to the frame.
+const cell kSum = -4;
+const cell kIndex = -8;
+const cell kCount = 12;
+
+class DebugHandler : public AMXHandler<DebugHandler> {
+ public:
+  explicit DebugHandler(AMX *amx)
+   : AMXHandler<DebugHandler>(amx),
+     profiler_(amx, false)
+  {
+  }
+
+  int Debug() { return profiler_.DebugHook(); }
+
+ private:
+  Profiler profiler_;
+};
+
+int AMXAPI DebugHook(AMX *amx) {
+  return DebugHandler::GetHandler(amx)->Debug();
+}
+
+// f(count) {
+//   new sum = 0;
+//   for (new i = 0; i < count; i++) {
+//     sum += i;
+//   }
+//   return sum;
+// }
+//
+// with a BREAK before every statement and loop condition, as the compiler
+// emits them with debug info.
+test::CodeBuilder GetLoopCode() {
+  test::CodeBuilder code;
+  code.Emit(OP_PROC);
+  code.Emit(OP_BREAK);
+  code.Emit(OP_STACK, -8);
+  code.Emit(OP_ZERO_S, kSum);
+  code.Emit(OP_BREAK);
+  code.Emit(OP_ZERO_S, kIndex);
+  Address loop = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_LOAD_S_PRI, kIndex);
+  code.Emit(OP_LOAD_S_ALT, kCount);
+  Address exit_jump = code.offset();
+  code.EmitJump(OP_JSGEQ);
+  code.Emit(OP_BREAK);
+  code.Emit(OP_LOAD_S_PRI, kSum);
+  code.Emit(OP_LOAD_S_ALT, kIndex);
+  code.Emit(OP_ADD);
+  code.Emit(OP_STOR_S_PRI, kSum);
+  code.Emit(OP_BREAK);
+  code.Emit(OP_INC_S, kIndex);
+  code.EmitJump(OP_JUMP, loop);
+  code.SetTarget(exit_jump, code.offset());
+  code.Emit(OP_BREAK);
+  code.Emit(OP_LOAD_S_PRI, kSum);
+  code.Emit(OP_STACK, 8);
+  code.Emit(OP_RETN);
+  return code;
+}
+
+// Runs the code from the start to the first RETN and returns PRI. Only
+// the instructions of GetLoopCode() are supported.
+cell Interpret(AMX *amx, cell count) {
+  const cell *code = reinterpret_cast<const cell*>(GetAmxCodePtr(amx));
+  cell locals[3] = {0, 0, count};  // sum, i, count
+  cell pri = 0;
+  cell alt = 0;
+  Address cip = 0;
+
+  for (;;) {
+    const cell *ip = code + cip / sizeof(cell);
+    cell opcode = RelocateOpcode(ip[0]);
+    switch (opcode) {
+      case OP_PROC:
+      case OP_NOP:
+        cip += sizeof(cell);
+        break;
+      case OP_BREAK:
+        if (amx->debug != 0) {
+          amx->cip = cip;
+          amx->debug(amx);
+        }
+        cip += sizeof(cell);
+        break;
+      case OP_STACK:
+        cip += 2 * sizeof(cell);
+        break;
+      case OP_ZERO_S:
+        locals[ip[1] == kSum ? 0 : 1] = 0;
+        cip += 2 * sizeof(cell);
+        break;
+      case OP_LOAD_S_PRI:
+        pri = locals[ip[1] == kSum ? 0 : 1];
+        cip += 2 * sizeof(cell);
+        break;
+      case OP_LOAD_S_ALT:
+        alt = locals[ip[1] == kIndex ? 1 : 2];
+        cip += 2 * sizeof(cell);
+        break;
+      case OP_STOR_S_PRI:
+        locals[0] = pri;
+        cip += 2 * sizeof(cell);
+        break;
+      case OP_INC_S:
+        locals[1]++;
+        cip += 2 * sizeof(cell);
+        break;
+      case OP_ADD:
+        pri += alt;
+        cip += sizeof(cell);
+        break;
+      case OP_JSGEQ:
+        if (pri >= alt) {
+          cip = GetCodeOffset(amx, ip[1]);
+        } else {
+          cip += 2 * sizeof(cell);
+        }
+        break;
+      case OP_JUMP:
+        cip = GetCodeOffset(amx, ip[1]);
+        break;
+      case OP_RETN:
+        return pri;
+      default:
+        std::printf("  Unsupported opcode %d\n", static_cast<int>(opcode));
+        return 0;
+    }
+  }
+}
+
+// Each iteration is one iteration of the loop.
+class LoopBenchmark : public benchmark::Benchmark {
+ public:
+  explicit LoopBenchmark(AMX *amx) : amx_(amx) {}
+
+  virtual void Run(long iterations) {
+    benchmark::UseResult(Interpret(amx_, static_cast<cell>(iterations)));
+  }
+
+ private:
+  AMX *amx_;
+};
+
+} // anonymous namespace
+
+BENCHMARK(CodePatcher) {
+  test::CodeBuilder code = GetLoopCode();
+  test::FakeAmx fake_amx;
+  fake_amx.SetCode(code.code(), code.targets());
+
+  // The hook sees the same frame on every BREAK, like it would in the
+  // middle of a function, which is the cheapest case for it.
+  AMX *amx = fake_amx.amx();
+  amx->stk = 0;
+  amx->stp = 1024;
+  amx->frm = amx->stp;
+  DebugHandler::CreateHandler(amx);
+
+  LoopBenchmark loop(amx);
+
+  amx->debug = 0;
+  benchmark::Run("Loop iteration (no debug hook)", &loop);
+
+  amx->debug = DebugHook;
+  benchmark::Run("Loop iteration (all BREAKs)", &loop);
+
+  CodePatcher patcher(amx);
+  int num_removed = patcher.RemoveRedundantBreaks();
+  benchmark::Run("Loop iteration (redundant BREAKs removed)", &loop);
+  std::printf("  Removed %d of 6 BREAK instructions\n", num_removed);
+
+  patcher.Restore();
+  DebugHandler::DestroyHandler(amx);
+}
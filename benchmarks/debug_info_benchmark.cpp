@@ -0,0 +1,219 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <amx/amx.h>
+#include <amx/amxdbg.h>
+#include "amxprof/amx_types.h"
+#include "amxprof/debug_info.h"
+#include "benchmark.h"
+#include "debug_info_builder.h"
+
+// Compares DebugInfo lookups with the linear searches of amxdbg, which the
+// profiler used before, on debug info of a generated script.
+
+using namespace amxprof;
+
+namespace {
+
+const char kFilename[] = "debug_info_benchmark.amx";
+
+const int kNumFiles = 50;
+const int kNumFunctions = 5000;
+const int kLinesPerFunction = 10;
+const ucell kFunctionSize = 40 * sizeof(cell);
+const int kNumAddresses = 4096;
+
+// Writes an AMX file without code but with debug info for kNumFunctions
+// functions spread over kNumFiles files.
+bool WriteDebugInfoFile() {
+  test::DebugInfoBuilder builder;
+  for (int i = 0; i < kNumFiles; i++) {
+    std::ostringstream name;
+    name << "include/file" << i << ".inc";
+    builder.AddFile(i * kNumFunctions / kNumFiles * kFunctionSize,
+                    name.str());
+  }
+  for (int i = 0; i < kNumFunctions * kLinesPerFunction; i++) {
+    builder.AddLine(i * kFunctionSize / kLinesPerFunction, i);
+  }
+  for (int i = 0; i < kNumFunctions; i++) {
+    std::ostringstream name;
+    name << "function" << i;
+    builder.AddFunction(name.str(),
+                        i * kFunctionSize,
+                        (i + 1) * kFunctionSize);
+  }
+  return builder.Write(kFilename);
+}
+
+// Code addresses in random order, so that lookups don't benefit from
+// caching more than they would in a real script.
+std::vector<Address> GetRandomAddresses() {
+  std::vector<Address> addresses;
+  unsigned long state = 12345;
+  for (int i = 0; i < kNumAddresses; i++) {
+    state = state * 1103515245 + 12345;
+    ucell offset = static_cast<ucell>((state >> 8) % (kNumFunctions * 40));
+    addresses.push_back(static_cast<Address>(offset * sizeof(cell)));
+  }
+  return addresses;
+}
+
+enum Lookup {
+  LOOKUP_FUNCTION,
+  LOOKUP_LINE,
+  LOOKUP_FILE
+};
+
+class DebugInfoLookup : public benchmark::Benchmark {
+ public:
+  DebugInfoLookup(const DebugInfo *debug_info,
+                  Lookup lookup,
+                  const std::vector<Address> &addresses)
+   : debug_info_(debug_info),
+     lookup_(lookup),
+     addresses_(addresses)
+  {
+  }
+
+  virtual void Run(long iterations) {
+    long result = 0;
+    for (long i = 0; i < iterations; i++) {
+      Address address = addresses_[i % kNumAddresses];
+      switch (lookup_) {
+        case LOOKUP_FUNCTION:
+          result += debug_info_->LookupFunction(address).length();
+          break;
+        case LOOKUP_LINE:
+          result += debug_info_->LookupLine(address);
+          break;
+        case LOOKUP_FILE:
+          result += debug_info_->LookupFile(address).length();
+          break;
+      }
+    }
+    benchmark::UseResult(result);
+  }
+
+ private:
+  const DebugInfo *debug_info_;
+  Lookup lookup_;
+  const std::vector<Address> &addresses_;
+};
+
+// Same as what DebugInfo used to do: call amxdbg and copy the name.
+class AmxDbgLookup : public benchmark::Benchmark {
+ public:
+  AmxDbgLookup(const AMX_DBG *amxdbg,
+               Lookup lookup,
+               const std::vector<Address> &addresses)
+   : amxdbg_(amxdbg),
+     lookup_(lookup),
+     addresses_(addresses)
+  {
+  }
+
+  virtual void Run(long iterations) {
+    long result = 0;
+    for (long i = 0; i < iterations; i++) {
+      ucell address = static_cast<ucell>(addresses_[i % kNumAddresses]);
+      const char *name = 0;
+      long line = 0;
+      std::string s;
+      switch (lookup_) {
+        case LOOKUP_FUNCTION:
+          if (dbg_LookupFunction(amxdbg_, address, &name) == AMX_ERR_NONE) {
+            s.assign(name);
+          }
+          result += s.length();
+          break;
+        case LOOKUP_LINE:
+          dbg_LookupLine(amxdbg_, address, &line);
+          result += line;
+          break;
+        case LOOKUP_FILE:
+          if (dbg_LookupFile(amxdbg_, address, &name) == AMX_ERR_NONE) {
+            s.assign(name);
+          }
+          result += s.length();
+          break;
+      }
+    }
+    benchmark::UseResult(result);
+  }
+
+ private:
+  const AMX_DBG *amxdbg_;
+  Lookup lookup_;
+  const std::vector<Address> &addresses_;
+};
+
+} // anonymous namespace
+
+BENCHMARK(DebugInfo) {
+  if (!WriteDebugInfoFile()) {
+    std::printf("  Could not write %s\n", kFilename);
+    return;
+  }
+
+  DebugInfo debug_info(kFilename);
+  AMX_DBG amxdbg;
+  FILE *fp = std::fopen(kFilename, "rb");
+  int error = fp != 0 ? dbg_LoadInfo(&amxdbg, fp) : AMX_ERR_NOTFOUND;
+  if (fp != 0) {
+    std::fclose(fp);
+  }
+
+  if (debug_info.is_loaded() && error == AMX_ERR_NONE) {
+    std::vector<Address> addresses = GetRandomAddresses();
+
+    DebugInfoLookup function(&debug_info, LOOKUP_FUNCTION, addresses);
+    benchmark::Run("DebugInfo::LookupFunction", &function);
+    AmxDbgLookup dbg_function(&amxdbg, LOOKUP_FUNCTION, addresses);
+    benchmark::Run("dbg_LookupFunction", &dbg_function);
+
+    DebugInfoLookup line(&debug_info, LOOKUP_LINE, addresses);
+    benchmark::Run("DebugInfo::LookupLine", &line);
+    AmxDbgLookup dbg_line(&amxdbg, LOOKUP_LINE, addresses);
+    benchmark::Run("dbg_LookupLine", &dbg_line);
+
+    DebugInfoLookup file(&debug_info, LOOKUP_FILE, addresses);
+    benchmark::Run("DebugInfo::LookupFile", &file);
+    AmxDbgLookup dbg_file(&amxdbg, LOOKUP_FILE, addresses);
+    benchmark::Run("dbg_LookupFile", &dbg_file);
+  } else {
+    std::printf("  Could not load debug info from %s\n", kFilename);
+  }
+
+  if (error == AMX_ERR_NONE) {
+    dbg_FreeInfo(&amxdbg);
+  }
+  debug_info.Unload();
+  std::remove(kFilename);
+}
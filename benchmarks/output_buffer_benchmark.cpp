@@ -0,0 +1,131 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "amxprof/output_buffer.h"
+#include "benchmark.h"
+
+// Compares formatting a row of a text profile with std::ostream and with
+// OutputBuffer, which replaced it in the writers.
+
+using namespace amxprof;
+
+namespace {
+
+const int kNumRows = 256;
+
+// Discards everything, so that only formatting is measured.
+class NullBuffer : public std::streambuf {
+ protected:
+  virtual int overflow(int c) { return c; }
+  virtual std::streamsize xsputn(const char *, std::streamsize n) {
+    return n;
+  }
+};
+
+struct Row {
+  std::string name;
+  long calls;
+  double self_time;
+  double total_time;
+  double percent;
+};
+
+std::vector<Row> GetRows() {
+  std::vector<Row> rows;
+  for (int i = 0; i < kNumRows; i++) {
+    std::ostringstream name;
+    name << "SomeFunctionName" << i;
+    Row row;
+    row.name = name.str();
+    row.calls = 1000L * i + 7;
+    row.self_time = 0.123456 * i;
+    row.total_time = 1.5 * i + 0.001;
+    row.percent = 100.0 * i / kNumRows;
+    rows.push_back(row);
+  }
+  return rows;
+}
+
+class StreamRows : public benchmark::Benchmark {
+ public:
+  explicit StreamRows(const std::vector<Row> &rows) : rows_(rows) {}
+
+  virtual void Run(long iterations) {
+    NullBuffer buffer;
+    std::ostream stream(&buffer);
+    for (long i = 0; i < iterations; i++) {
+      const Row &row = rows_[i % kNumRows];
+      stream << std::left << std::setw(32) << row.name
+             << std::right << std::setw(10) << row.calls
+             << std::fixed << std::setprecision(3)
+             << std::setw(12) << row.self_time
+             << std::setw(12) << row.total_time
+             << std::setprecision(2)
+             << std::setw(8) << row.percent << '\n';
+    }
+  }
+
+ private:
+  const std::vector<Row> &rows_;
+};
+
+class OutputBufferRows : public benchmark::Benchmark {
+ public:
+  explicit OutputBufferRows(const std::vector<Row> &rows) : rows_(rows) {}
+
+  virtual void Run(long iterations) {
+    NullBuffer buffer;
+    std::ostream stream(&buffer);
+    OutputBuffer out(&stream);
+    for (long i = 0; i < iterations; i++) {
+      const Row &row = rows_[i % kNumRows];
+      out << Left(32) << row.name
+          << Right(10) << row.calls
+          << Right(12) << Fixed(row.self_time, 3)
+          << Right(12) << Fixed(row.total_time, 3)
+          << Right(8) << Fixed(row.percent, 2) << '\n';
+    }
+  }
+
+ private:
+  const std::vector<Row> &rows_;
+};
+
+} // anonymous namespace
+
+BENCHMARK(OutputBuffer) {
+  std::vector<Row> rows = GetRows();
+
+  StreamRows stream_rows(rows);
+  benchmark::Run("std::ostream (one row)", &stream_rows);
+
+  OutputBufferRows output_buffer_rows(rows);
+  benchmark::Run("OutputBuffer (one row)", &output_buffer_rows);
+}
@@ -28,6 +28,12 @@
 #include <map>
 #include <amx/amx.h>
 
+// AMXHandler associates an instance of T with each AMX.
+//
+// GetHandler() is called on every hook, so besides keeping handlers in
+// a map, the handler pointer is stored in one of the AMX's user data slots
+// where it can be found without a tree lookup. If all slots are taken by
+// other plugins, the map is used instead.
 template<typename T>
 class AMXHandler {
  public:
@@ -44,6 +50,8 @@ class AMXHandler {
   AMX *amx_;
 
  private:
+  static const long kUserTag = AMX_USERTAG('P', 'r', 'o', 'f');
+
   typedef std::map<AMX*, T*> HandlerMap;
   static HandlerMap handlers_;
 };
@@ -56,12 +64,24 @@ template<typename T>
 T *AMXHandler<T>::CreateHandler(AMX *amx) {
   T *handler = new T(amx);
   handlers_.insert(std::make_pair(amx, handler));
+  for (int i = 0; i < AMX_USERNUM; i++) {
+    if (amx->usertags[i] == 0 || amx->usertags[i] == kUserTag) {
+      amx->usertags[i] = kUserTag;
+      amx->userdata[i] = handler;
+      break;
+    }
+  }
   return handler;
 }
 
 // static
 template<typename T>
 T *AMXHandler<T>::GetHandler(AMX *amx) {
+  for (int i = 0; i < AMX_USERNUM; i++) {
+    if (amx->usertags[i] == kUserTag) {
+      return static_cast<T*>(amx->userdata[i]);
+    }
+  }
   typename HandlerMap::const_iterator iterator = handlers_.find(amx);
   if (iterator != handlers_.end()) {
     return iterator->second;
@@ -72,6 +92,12 @@ T *AMXHandler<T>::GetHandler(AMX *amx) {
 // static
 template<typename T>
 void AMXHandler<T>::DestroyHandler(AMX *amx) {
+  for (int i = 0; i < AMX_USERNUM; i++) {
+    if (amx->usertags[i] == kUserTag) {
+      amx->usertags[i] = 0;
+      amx->userdata[i] = 0;
+    }
+  }
   typename HandlerMap::iterator iterator = handlers_.find(amx);
   if (iterator != handlers_.end()) {
     T *handler = iterator->second;
@@ -22,41 +22,56 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <cstdlib>
 #include <cstring>
-#include <iterator>
-#include <list>
+#include <fstream>
+#include <sstream>
 #include <vector>
-#include <amx/amxaux.h>
 #include "amxpathfinder.h"
 #include "fileutils.h"
 
-AMXPathFinder::AMXFile::AMXFile(const std::string &name)
- : amx_(reinterpret_cast<AMX*>(std::malloc(sizeof(*amx_)))),
-   name_(name),
-   mtime_(fileutils::GetModificationTime(name))
-{
-  if (amx_ != 0) {
-    if (aux_LoadProgram(amx_, name.c_str(), 0) != AMX_ERR_NONE) {
-      std::free(amx_);
-      amx_ = 0;
-    }
-  }
+namespace {
+
+const char kCacheHeader[] = "# AMX fingerprints: hash mtime size path";
+
+// Flags that may differ between the file and the header of a loaded AMX.
+const int16_t kRuntimeFlags = static_cast<int16_t>(AMX_FLAG_COMPACT
+                                                 | AMX_FLAG_NTVREG
+                                                 | AMX_FLAG_JITC
+                                                 | AMX_FLAG_BROWSE
+                                                 | AMX_FLAG_RELOC);
+
+AMX_HEADER NormalizeHeader(const AMX_HEADER &header) {
+  AMX_HEADER result = header;
+  result.flags &= ~kRuntimeFlags;
+  return result;
 }
 
-AMXPathFinder::AMXFile::~AMXFile() {
-  if (amx_ != 0) {
-    aux_FreeProgram(amx_);
-    std::free(amx_);
+// 32-bit FNV-1a hash of the header.
+unsigned long HashHeader(const AMX_HEADER &header) {
+  AMX_HEADER normalized = NormalizeHeader(header);
+  const unsigned char *bytes =
+    reinterpret_cast<const unsigned char*>(&normalized);
+  unsigned long hash = 2166136261UL;
+  for (std::size_t i = 0; i < sizeof(normalized); i++) {
+    hash ^= bytes[i];
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
   }
+  return hash;
 }
 
-AMXPathFinder::~AMXPathFinder() {
-  for (StringToAMXFileMap::const_iterator mapIter = string_to_amx_file_.begin();
-      mapIter != string_to_amx_file_.end(); ++mapIter)
-  {
-    delete mapIter->second;
+bool ReadHeader(const std::string &path, AMX_HEADER &header) {
+  std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
   }
+  return header.magic == AMX_MAGIC;
+}
+
+} // anonymous namespace
+
+AMXPathFinder::AMXPathFinder()
+ : cache_dirty_(false)
+{
 }
 
 void AMXPathFinder::AddSearchPath(std::string path) {
@@ -67,6 +82,11 @@ void AMXPathFinder::AddKnownFile(AMX *amx, std::string path) {
   amx_to_string_[amx] = path;
 }
 
+void AMXPathFinder::SetCacheFile(std::string path) {
+  cache_path_ = path;
+  LoadCache();
+}
+
 std::string AMXPathFinder::Find(AMX *amx) {
   // Look up in cache first.
   AMXToStringMap::const_iterator cache_iterator = amx_to_string_.find(amx);
@@ -74,49 +94,153 @@ std::string AMXPathFinder::Find(AMX *amx) {
     return cache_iterator->second;
   }
 
+  const AMX_HEADER &header = *reinterpret_cast<AMX_HEADER*>(amx->base);
+  unsigned long header_hash = HashHeader(header);
+
   std::string result;
 
-  // Load all .amx files in each of the current search paths (non-recursive).
+  // Try the files that had a matching header when they were last seen,
+  // possibly by a previous run of the server.
+  std::vector<std::string> candidates;
+  for (FingerprintMap::const_iterator iterator = fingerprints_.begin();
+       iterator != fingerprints_.end(); ++iterator) {
+    if (iterator->second.header_hash == header_hash) {
+      candidates.push_back(iterator->first);
+    }
+  }
+  for (std::vector<std::string>::const_iterator iterator = candidates.begin();
+       iterator != candidates.end(); ++iterator) {
+    if (UpdateFingerprint(*iterator)
+        && fingerprints_[*iterator].header_hash == header_hash
+        && MatchHeader(*iterator, header)) {
+      result = *iterator;
+      break;
+    }
+  }
+
+  // Check all .amx files in each of the search paths (non-recursive).
   for (std::list<std::string>::const_iterator dir_iterator = search_paths_.begin();
-      dir_iterator != search_paths_.end(); ++dir_iterator)
+       dir_iterator != search_paths_.end() && result.empty(); ++dir_iterator)
   {
     std::vector<std::string> files;
     fileutils::GetDirectoryFiles(*dir_iterator, "*.amx", files);
 
     for (std::vector<std::string>::iterator file_iterator = files.begin();
-        file_iterator != files.end(); ++file_iterator)
+         file_iterator != files.end(); ++file_iterator)
     {
       std::string filename;
       filename.append(*dir_iterator);
       filename.append(fileutils::kNativePathSepString);
       filename.append(*file_iterator);
 
-      std::time_t mtime = fileutils::GetModificationTime(filename);
-
-      StringToAMXFileMap::iterator script_it = string_to_amx_file_.find(filename);
-      if (script_it == string_to_amx_file_.end() ||
-          script_it->second->mtime() < mtime) {
-        if (script_it != string_to_amx_file_.end()) {
-          string_to_amx_file_.erase(script_it);
-        }
-        AMXFile *script = new AMXFile(filename);
-        if (script != 0 && script->IsLoaded()) {
-          string_to_amx_file_.insert(std::make_pair(filename, script));
-        }
+      if (UpdateFingerprint(filename)
+          && fingerprints_[filename].header_hash == header_hash
+          && MatchHeader(filename, header)) {
+        result = filename;
+        break;
       }
     }
   }
 
-  for (StringToAMXFileMap::const_iterator mapIter = string_to_amx_file_.begin();
-      mapIter != string_to_amx_file_.end(); ++mapIter)
-  {
-    const AMX *otherAmx = mapIter->second->amx();
-    if (std::memcmp(amx->base, otherAmx->base, sizeof(AMX_HEADER)) == 0) {
-      result = mapIter->first;
-      amx_to_string_.insert(std::make_pair(amx, result));
-      break;
-    }
+  if (!result.empty()) {
+    amx_to_string_.insert(std::make_pair(amx, result));
+  }
+  if (cache_dirty_) {
+    SaveCache();
   }
 
   return result;
 }
+
+bool AMXPathFinder::UpdateFingerprint(const std::string &path) {
+  std::time_t mtime = fileutils::GetModificationTime(path);
+  long size = fileutils::GetFileSize(path);
+
+  FingerprintMap::iterator iterator = fingerprints_.find(path);
+  if (iterator != fingerprints_.end()
+      && iterator->second.mtime == mtime
+      && iterator->second.size == size) {
+    return true;
+  }
+
+  AMX_HEADER header;
+  if (!ReadHeader(path, header)) {
+    if (iterator != fingerprints_.end()) {
+      fingerprints_.erase(iterator);
+      cache_dirty_ = true;
+    }
+    return false;
+  }
+
+  Fingerprint fingerprint;
+  fingerprint.mtime = mtime;
+  fingerprint.size = size;
+  fingerprint.header_hash = HashHeader(header);
+  fingerprints_[path] = fingerprint;
+  cache_dirty_ = true;
+
+  return true;
+}
+
+// static
+bool AMXPathFinder::MatchHeader(const std::string &path,
+                                const AMX_HEADER &header) {
+  AMX_HEADER file_header;
+  if (!ReadHeader(path, file_header)) {
+    return false;
+  }
+  AMX_HEADER lhs = NormalizeHeader(header);
+  AMX_HEADER rhs = NormalizeHeader(file_header);
+  return std::memcmp(&lhs, &rhs, sizeof(AMX_HEADER)) == 0;
+}
+
+void AMXPathFinder::LoadCache() {
+  std::ifstream stream(cache_path_.c_str());
+  std::string line;
+
+  while (std::getline(stream, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream line_stream(line);
+    unsigned long header_hash;
+    long mtime;
+    long size;
+    std::string path;
+
+    line_stream >> std::hex >> header_hash >> std::dec >> mtime >> size;
+    line_stream.ignore(1);
+    if (!line_stream || !std::getline(line_stream, path) || path.empty()) {
+      continue;
+    }
+
+    Fingerprint fingerprint;
+    fingerprint.mtime = static_cast<std::time_t>(mtime);
+    fingerprint.size = size;
+    fingerprint.header_hash = header_hash;
+    fingerprints_[path] = fingerprint;
+  }
+}
+
+void AMXPathFinder::SaveCache() {
+  if (cache_path_.empty()) {
+    return;
+  }
+
+  std::ofstream stream(cache_path_.c_str());
+  if (!stream.is_open()) {
+    return;
+  }
+
+  stream << kCacheHeader << '\n';
+  for (FingerprintMap::const_iterator iterator = fingerprints_.begin();
+       iterator != fingerprints_.end(); ++iterator) {
+    const Fingerprint &fingerprint = iterator->second;
+    stream << std::hex << fingerprint.header_hash << std::dec
+           << ' ' << static_cast<long>(fingerprint.mtime)
+           << ' ' << fingerprint.size
+           << ' ' << iterator->first << '\n';
+  }
+  cache_dirty_ = false;
+}
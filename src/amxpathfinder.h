@@ -31,48 +31,50 @@
 #include <string>
 #include <amx/amx.h>
 
+// AMXPathFinder finds the file an AMX instance was loaded from by comparing
+// its header with the headers of .amx files in the search paths.
+//
+// Only file headers are read. The header hash of each file is remembered
+// along with its modification time and size, and can be persisted in a
+// cache file, so that after a restart scripts are usually found without
+// scanning the search paths.
 class AMXPathFinder {
  public:
-  ~AMXPathFinder();
+  AMXPathFinder();
 
   void AddSearchPath(std::string path);
   void AddKnownFile(AMX *amx, std::string path);
 
+  // Loads fingerprints from the specified file and saves them there
+  // whenever new files are seen.
+  void SetCacheFile(std::string path);
+
   std::string Find(AMX *amx);
 
  private:
-  std::list<std::string> search_paths_;
-
-  class AMXFile {
-   public:
-    explicit AMXFile(const std::string &name);
-    ~AMXFile();
-
-    bool IsLoaded() const { return amx_ != 0; }
+  struct Fingerprint {
+    std::time_t mtime;
+    long size;
+    unsigned long header_hash;
+  };
 
-    const AMX *amx() const {
-      return amx_;
-    }
-    const std::string &name() const {
-      return name_;
-    }
-    std::time_t mtime() const {
-      return mtime_;
-    }
+  // Updates the fingerprint of the file if it changed since it was last
+  // seen. Returns false if the file is not a valid AMX file.
+  bool UpdateFingerprint(const std::string &path);
 
-   private:
-    AMXFile(const AMXFile &other);
-    AMXFile &operator=(const AMXFile &other);
+  // Checks the header of the file against the specified one.
+  static bool MatchHeader(const std::string &path, const AMX_HEADER &header);
 
-   private:
-    AMX *amx_;
-    std::string name_;
-    std::time_t mtime_;
-  };
+  void LoadCache();
+  void SaveCache();
 
  private:
-  typedef std::map<std::string, AMXFile*> StringToAMXFileMap;
-  StringToAMXFileMap string_to_amx_file_;
+  std::list<std::string> search_paths_;
+  std::string cache_path_;
+  bool cache_dirty_;
+
+  typedef std::map<std::string, Fingerprint> FingerprintMap;
+  FingerprintMap fingerprints_;
 
   typedef std::map<AMX*, std::string> AMXToStringMap;
   AMXToStringMap amx_to_string_;
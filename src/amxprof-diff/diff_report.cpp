@@ -0,0 +1,120 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include "diff_report.h"
+
+namespace {
+
+bool IsBelowMinTime(const FunctionDiff &fn, double min_time) {
+  return fn.old_absolute_values[METRIC_SELF_TIME] < min_time
+      && fn.old_absolute_values[METRIC_TOTAL_TIME] < min_time
+      && fn.new_absolute_values[METRIC_SELF_TIME] < min_time
+      && fn.new_absolute_values[METRIC_TOTAL_TIME] < min_time;
+}
+
+} // anonymous namespace
+
+ReportOptions::ReportOptions()
+ : metric(METRIC_SELF_TIME),
+   threshold(5),
+   min_time(1e6),
+   budget(-1),
+   total_budget(-1),
+   fail_on_new(false)
+{
+}
+
+DiffReport::DiffReport(const ReportOptions &options)
+ : options_(options),
+   num_matched_(0),
+   num_added_(0),
+   num_removed_(0),
+   num_over_budget_(0),
+   num_new_over_min_time_(0),
+   total_over_budget_(false)
+{
+}
+
+void DiffReport::Compute(const ProfileDiff &diff) {
+  num_matched_ = 0;
+  num_added_ = 0;
+  num_removed_ = 0;
+  regressions_.clear();
+  improvements_.clear();
+  num_over_budget_ = 0;
+  num_new_over_min_time_ = 0;
+
+  const std::vector<FunctionDiff> &functions = diff.functions();
+  for (std::vector<FunctionDiff>::const_iterator iterator = functions.begin();
+       iterator != functions.end(); ++iterator) {
+    const FunctionDiff &fn = *iterator;
+    bool matched = fn.in_old && fn.in_new;
+    if (matched) {
+      num_matched_++;
+    } else if (fn.in_new) {
+      num_added_++;
+    } else {
+      num_removed_++;
+    }
+
+    if (IsBelowMinTime(fn, options_.min_time)) {
+      continue;
+    }
+    if (!fn.in_old) {
+      num_new_over_min_time_++;
+    }
+
+    // Average times of functions that only exist in one of the profiles
+    // can't be compared.
+    if (options_.metric == METRIC_AVERAGE_TIME && !matched) {
+      continue;
+    }
+    double change = fn.GetChange(options_.metric);
+    double relative_change = fn.GetRelativeChange(options_.metric);
+    if (change == 0 || std::fabs(relative_change) < options_.threshold) {
+      continue;
+    }
+    if (change > 0) {
+      regressions_.push_back(&fn);
+      if (matched
+          && options_.budget >= 0
+          && relative_change > options_.budget) {
+        num_over_budget_++;
+      }
+    } else {
+      improvements_.push_back(&fn);
+    }
+  }
+
+  total_over_budget_ = options_.total_budget >= 0
+    && diff.total().GetRelativeChange(METRIC_SELF_TIME)
+         > options_.total_budget;
+}
+
+bool DiffReport::budget_exceeded() const {
+  return num_over_budget_ > 0
+      || total_over_budget_
+      || (options_.fail_on_new && num_new_over_min_time_ > 0);
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_DIFF_DIFF_REPORT_H
+#define AMXPROF_DIFF_DIFF_REPORT_H
+
+#include <vector>
+#include "profile_diff.h"
+
+// Decides which changes are reported and which ones exceed the budget.
+struct ReportOptions {
+  ReportOptions();
+
+  Metric metric;
+  double threshold;     // percent
+  double min_time;      // nanoseconds, compared with absolute times
+  double budget;        // percent, negative if not set
+  double total_budget;  // percent, negative if not set
+  bool fail_on_new;
+};
+
+// DiffReport picks the functions of a ProfileDiff whose change in the
+// selected metric is large enough to report, and checks the changes
+// against the budgets.
+//
+// Functions whose self and total times are below the minimum in both
+// profiles are ignored. A function that only exists in the new profile
+// has no relative change, so it is not checked against the per-function
+// budget; its time counts towards the total budget, and with fail_on_new
+// it exceeds the budget on its own.
+class DiffReport {
+ public:
+  explicit DiffReport(const ReportOptions &options);
+
+  void Compute(const ProfileDiff &diff);
+
+  int num_matched() const { return num_matched_; }
+  int num_added() const { return num_added_; }
+  int num_removed() const { return num_removed_; }
+
+  // Functions that got slower or were added, and functions that got
+  // faster or were removed, in no particular order.
+  const std::vector<const FunctionDiff*> &regressions() const {
+    return regressions_;
+  }
+  const std::vector<const FunctionDiff*> &improvements() const {
+    return improvements_;
+  }
+
+  // Functions in both profiles that regressed by more than the budget.
+  int num_over_budget() const { return num_over_budget_; }
+
+  // Added functions that aren't below the minimum time.
+  int num_new_over_min_time() const { return num_new_over_min_time_; }
+
+  bool total_over_budget() const { return total_over_budget_; }
+
+  bool budget_exceeded() const;
+
+ private:
+  ReportOptions options_;
+  int num_matched_;
+  int num_added_;
+  int num_removed_;
+  std::vector<const FunctionDiff*> regressions_;
+  std::vector<const FunctionDiff*> improvements_;
+  int num_over_budget_;
+  int num_new_over_min_time_;
+  bool total_over_budget_;
+};
+
+#endif // !AMXPROF_DIFF_DIFF_REPORT_H
@@ -0,0 +1,386 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <amxprof/output_buffer.h>
+#include "diff_report.h"
+#include "profile.h"
+#include "profile_diff.h"
+
+using amxprof::Fixed;
+using amxprof::Left;
+using amxprof::OutputBuffer;
+using amxprof::Right;
+
+namespace {
+
+// Exit codes.
+const int kExitOk = 0;
+const int kExitBudgetExceeded = 1;
+const int kExitError = 2;
+
+struct MetricInfo {
+  const char *option;      // value of --metric
+  const char *title;       // column and table title
+  const char *unit;
+  const char *normalized_unit;
+  double scale;            // from nanoseconds (or calls) to unit
+  int precision;
+};
+
+const MetricInfo kMetrics[NUM_METRICS] = {
+  {"self",    "Self time",  "ms",    "ms/s",    1e-6, 3},
+  {"total",   "Total time", "ms",    "ms/s",    1e-6, 3},
+  {"calls",   "Calls",      "calls", "calls/s", 1,    0},
+  {"average", "Avg. time",  "us",    "us",      1e-3, 3}
+};
+
+struct Options {
+  Options()
+   : limit(20),
+     normalize(true)
+  {
+  }
+
+  ReportOptions report;
+  int limit;
+  bool normalize;
+  std::string old_filename;
+  std::string new_filename;
+};
+
+void PrintUsage(const char *program) {
+  std::fprintf(stderr,
+    "Usage: %s [options] <old-profile.json> <new-profile.json>\n"
+    "\n"
+    "Compares two profiles written with profiler_outputformat json and lists\n"
+    "functions that got slower or faster.\n"
+    "\n"
+    "Options:\n"
+    "  -m, --metric <metric>         rank functions by self, total, calls or\n"
+    "                                average time per call (default: self)\n"
+    "  -t, --threshold <percent>     hide changes smaller than this\n"
+    "                                (default: 5)\n"
+    "  -T, --min-time <ms>           hide functions whose self and total\n"
+    "                                time is below this in both profiles,\n"
+    "                                before dividing by the run time\n"
+    "                                (default: 1)\n"
+    "  -n, --limit <count>           show at most this many regressions and\n"
+    "                                improvements, 0 means all (default: 20)\n"
+    "  -b, --budget <percent>        fail if a function that is in both\n"
+    "                                profiles regresses by more than this\n"
+    "  -B, --total-budget <percent>  fail if the total self time grows by\n"
+    "                                more than this, including the time of\n"
+    "                                new functions\n"
+    "  -N, --fail-on-new             fail if a function that is not in the\n"
+    "                                old profile takes at least --min-time\n"
+    "  -a, --absolute                compare absolute times and call counts\n"
+    "                                instead of values per second of run\n"
+    "                                time\n"
+    "  -h, --help                    show this message\n"
+    "\n"
+    "Exit status is 0 if the budgets are met, 1 if they are exceeded and 2\n"
+    "on errors.\n",
+    program);
+}
+
+bool ParseNumber(const char *s, double &value) {
+  char *end;
+  value = std::strtod(s, &end);
+  return end != s && *end == '\0' && value >= 0;
+}
+
+// Returns false if the command line is invalid.
+bool ParseOptions(int argc, char **argv, Options &options) {
+  std::vector<std::string> filenames;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.empty() || arg[0] != '-' || arg == "-") {
+      filenames.push_back(arg);
+      continue;
+    }
+    if (arg == "-h" || arg == "--help") {
+      return false;
+    }
+    if (arg == "-a" || arg == "--absolute") {
+      options.normalize = false;
+      continue;
+    }
+    if (arg == "-N" || arg == "--fail-on-new") {
+      options.report.fail_on_new = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      std::fprintf(stderr, "Option %s requires a value\n", arg.c_str());
+      return false;
+    }
+    const char *value = argv[++i];
+    double number = 0;
+    bool ok = true;
+
+    if (arg == "-m" || arg == "--metric") {
+      ok = false;
+      for (int j = 0; j < NUM_METRICS; j++) {
+        if (std::strcmp(value, kMetrics[j].option) == 0) {
+          options.report.metric = static_cast<Metric>(j);
+          ok = true;
+        }
+      }
+    } else if (arg == "-t" || arg == "--threshold") {
+      ok = ParseNumber(value, options.report.threshold);
+    } else if (arg == "-T" || arg == "--min-time") {
+      ok = ParseNumber(value, number);
+      options.report.min_time = number * 1e6;
+    } else if (arg == "-n" || arg == "--limit") {
+      ok = ParseNumber(value, number);
+      options.limit = static_cast<int>(number);
+    } else if (arg == "-b" || arg == "--budget") {
+      ok = ParseNumber(value, options.report.budget);
+    } else if (arg == "-B" || arg == "--total-budget") {
+      ok = ParseNumber(value, options.report.total_budget);
+    } else {
+      std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+      return false;
+    }
+
+    if (!ok) {
+      std::fprintf(stderr, "Invalid value for %s: %s\n", arg.c_str(), value);
+      return false;
+    }
+  }
+
+  if (filenames.size() != 2) {
+    return false;
+  }
+  options.old_filename = filenames[0];
+  options.new_filename = filenames[1];
+  return true;
+}
+
+bool LoadProfile(const std::string &filename, Profile &profile) {
+  std::string error;
+  if (!profile.Load(filename, error)) {
+    std::fprintf(stderr, "Error loading %s: %s\n",
+                 filename.c_str(), error.c_str());
+    return false;
+  }
+  return true;
+}
+
+class FunctionPrinter {
+ public:
+  FunctionPrinter(OutputBuffer *out, const Options &options)
+   : out_(out),
+     options_(options),
+     metric_(kMetrics[options.report.metric])
+  {
+  }
+
+  void PrintHeader() {
+    std::string unit = options_.normalize ? metric_.normalized_unit
+                                          : metric_.unit;
+    *out_ << Right(12) << ("Old " + unit)
+          << Right(12) << ("New " + unit);
+    for (int i = 0; i < NUM_METRICS; i++) {
+      *out_ << Right(12) << kMetrics[i].title;
+    }
+    *out_ << "  Function\n";
+  }
+
+  void PrintFunction(const FunctionDiff &diff) {
+    *out_ << Right(12) << Fixed(diff.old_values[options_.report.metric]
+                                * metric_.scale, metric_.precision)
+          << Right(12) << Fixed(diff.new_values[options_.report.metric]
+                                * metric_.scale, metric_.precision);
+    for (int i = 0; i < NUM_METRICS; i++) {
+      PrintChange(diff, static_cast<Metric>(i));
+    }
+    *out_ << "  " << diff.type << " " << diff.name << "\n";
+  }
+
+  void PrintChange(const FunctionDiff &diff, Metric metric) {
+    char buffer[32];
+    if (!diff.in_old) {
+      std::strcpy(buffer, "new");
+    } else if (!diff.in_new) {
+      std::strcpy(buffer, "gone");
+    } else {
+      double change = diff.GetRelativeChange(metric);
+      if (std::fabs(change) == HUGE_VAL) {
+        std::strcpy(buffer, "n/a");
+      } else {
+        std::sprintf(buffer, "%+.1f%%", change);
+      }
+    }
+    *out_ << Right(12) << buffer;
+  }
+
+ private:
+  OutputBuffer *out_;
+  const Options &options_;
+  const MetricInfo &metric_;
+};
+
+class CompareChange {
+ public:
+  explicit CompareChange(Metric metric) : metric_(metric) {}
+
+  // Largest absolute changes first.
+  bool operator()(const FunctionDiff *lhs, const FunctionDiff *rhs) const {
+    return std::fabs(lhs->GetChange(metric_))
+         > std::fabs(rhs->GetChange(metric_));
+  }
+
+ private:
+  Metric metric_;
+};
+
+void PrintTable(OutputBuffer &out,
+                const char *title,
+                std::vector<const FunctionDiff*> functions,
+                const Options &options) {
+  std::size_t num_shown = functions.size();
+  if (options.limit > 0
+      && num_shown > static_cast<std::size_t>(options.limit)) {
+    num_shown = static_cast<std::size_t>(options.limit);
+  }
+
+  // Only the rows that are shown need to be in order.
+  CompareChange compare(options.report.metric);
+  std::partial_sort(functions.begin(),
+                    functions.begin() + num_shown,
+                    functions.end(),
+                    compare);
+
+  out << title << " by " << kMetrics[options.report.metric].title
+      << " (" << static_cast<unsigned long>(num_shown) << " of "
+      << static_cast<unsigned long>(functions.size()) << "):\n";
+  if (functions.empty()) {
+    out << "  none\n\n";
+    return;
+  }
+
+  FunctionPrinter printer(&out, options);
+  printer.PrintHeader();
+  for (std::size_t i = 0; i < num_shown; i++) {
+    printer.PrintFunction(*functions[i]);
+  }
+  out << "\n";
+}
+
+void PrintProfileInfo(OutputBuffer &out,
+                      const char *label,
+                      const std::string &filename,
+                      const Profile &profile) {
+  out << label << filename;
+  if (!profile.script().empty()) {
+    out << " (" << profile.script();
+    if (profile.duration() > 0) {
+      out << ", " << Fixed(profile.duration(), 1) << " s";
+    }
+    out << ")";
+  }
+  out << ", " << static_cast<unsigned long>(profile.functions().size())
+      << " functions\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage(argv[0]);
+    return kExitError;
+  }
+
+  Profile old_profile;
+  Profile new_profile;
+  if (!LoadProfile(options.old_filename, old_profile)
+      || !LoadProfile(options.new_filename, new_profile)) {
+    return kExitError;
+  }
+
+  if (options.normalize
+      && (old_profile.duration() <= 0 || new_profile.duration() <= 0)) {
+    std::fprintf(stderr, "Warning: run time is missing, comparing absolute "
+                         "values\n");
+    options.normalize = false;
+  }
+
+  ProfileDiff diff;
+  diff.set_normalize(options.normalize);
+  diff.Compute(old_profile, new_profile);
+
+  DiffReport report(options.report);
+  report.Compute(diff);
+
+  OutputBuffer out(&std::cout);
+
+  PrintProfileInfo(out, "Old: ", options.old_filename, old_profile);
+  PrintProfileInfo(out, "New: ", options.new_filename, new_profile);
+  out << "Functions: " << report.num_matched() << " matched, "
+      << report.num_added() << " new, " << report.num_removed() << " gone\n";
+  if (options.normalize) {
+    out << "Times and calls are per second of run time.\n";
+  }
+  out << "\n";
+
+  FunctionDiff total = diff.total();
+  total.type = "all";
+  total.name = "functions";
+  out << "Total:\n";
+  FunctionPrinter printer(&out, options);
+  printer.PrintHeader();
+  printer.PrintFunction(total);
+  out << "\n";
+
+  PrintTable(out, "Regressions", report.regressions(), options);
+  PrintTable(out, "Improvements", report.improvements(), options);
+
+  if (report.num_over_budget() > 0) {
+    out << "Budget exceeded: " << report.num_over_budget()
+        << " function(s) regressed by more than "
+        << Fixed(options.report.budget, 1) << "%\n";
+  }
+  if (options.report.fail_on_new && report.num_new_over_min_time() > 0) {
+    out << "Budget exceeded: " << report.num_new_over_min_time()
+        << " new function(s) take at least "
+        << Fixed(options.report.min_time * 1e-6, 3) << " ms\n";
+  }
+  if (report.total_over_budget()) {
+    out << "Budget exceeded: total self time grew by more than "
+        << Fixed(options.report.total_budget, 1) << "%\n";
+  }
+
+  return report.budget_exceeded() ? kExitBudgetExceeded : kExitOk;
+}
@@ -0,0 +1,356 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "profile.h"
+
+namespace {
+
+// A minimal JSON reader, just enough to read profiles. The input must be
+// null-terminated.
+class JsonReader {
+ public:
+  explicit JsonReader(const char *data)
+   : data_(data),
+     pos_(data)
+  {
+  }
+
+  // Returns a description of the first error and where it occurred.
+  std::string error() const { return error_; }
+
+  bool ReadChar(char c) {
+    SkipSpace();
+    if (*pos_ != c) {
+      return Fail(std::string("expected '") + c + "'");
+    }
+    pos_++;
+    return true;
+  }
+
+  // Returns true and consumes the character if it's next in the input.
+  bool ConsumeChar(char c) {
+    SkipSpace();
+    if (*pos_ == c) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  // Reads the opening brace of an object (or bracket of an array). Each
+  // element is then preceded by a call to NextElement().
+  bool BeginObject() { return ReadChar('{'); }
+  bool BeginArray() { return ReadChar('['); }
+
+  // Returns true if there is another element in the current object or
+  // array, and false (with no error) at the closing brace or bracket.
+  bool NextElement(char close, bool first) {
+    if (ConsumeChar(close)) {
+      return false;
+    }
+    if (!first && !ReadChar(',')) {
+      return false;
+    }
+    return true;
+  }
+
+  bool ReadKey(std::string &key) {
+    return ReadString(key) && ReadChar(':');
+  }
+
+  bool ReadString(std::string &s);
+  bool ReadNumber(double &value);
+  bool SkipValue();
+
+  bool ok() const { return error_.empty(); }
+
+ private:
+  void SkipSpace() {
+    while (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t') {
+      pos_++;
+    }
+  }
+
+  bool Fail(const std::string &message);
+  static void AppendUtf8(std::string &s, unsigned long code_point);
+
+ private:
+  const char *data_;
+  const char *pos_;
+  std::string error_;
+};
+
+bool JsonReader::Fail(const std::string &message) {
+  if (error_.empty()) {
+    char offset[32];
+    std::sprintf(offset, " at offset %lu",
+                 static_cast<unsigned long>(pos_ - data_));
+    error_ = message + offset;
+  }
+  return false;
+}
+
+void JsonReader::AppendUtf8(std::string &s, unsigned long code_point) {
+  if (code_point < 0x80) {
+    s.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    s.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    s.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    s.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    s.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    s.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+bool JsonReader::ReadString(std::string &s) {
+  if (!ReadChar('"')) {
+    return false;
+  }
+  s.clear();
+  for (;;) {
+    // Copy runs of ordinary characters at once.
+    const char *start = pos_;
+    while (*pos_ != '"' && *pos_ != '\\' && *pos_ != '\0') {
+      pos_++;
+    }
+    s.append(start, pos_);
+
+    switch (*pos_++) {
+      case '"':
+        return true;
+      case '\0':
+        pos_--;
+        return Fail("unterminated string");
+    }
+
+    // Escape sequence.
+    switch (*pos_++) {
+      case '"':  s.push_back('"');  break;
+      case '\\': s.push_back('\\'); break;
+      case '/':  s.push_back('/');  break;
+      case 'b':  s.push_back('\b'); break;
+      case 'f':  s.push_back('\f'); break;
+      case 'n':  s.push_back('\n'); break;
+      case 'r':  s.push_back('\r'); break;
+      case 't':  s.push_back('\t'); break;
+      case 'u': {
+        char digits[5] = {0};
+        for (int i = 0; i < 4; i++) {
+          if (*pos_ == '\0') {
+            return Fail("unterminated string");
+          }
+          digits[i] = *pos_++;
+        }
+        char *end;
+        unsigned long code_point = std::strtoul(digits, &end, 16);
+        if (end != digits + 4) {
+          return Fail("invalid escape sequence");
+        }
+        AppendUtf8(s, code_point);
+        break;
+      }
+      default:
+        pos_--;
+        return Fail("invalid escape sequence");
+    }
+  }
+}
+
+bool JsonReader::ReadNumber(double &value) {
+  SkipSpace();
+  char *end;
+  value = std::strtod(pos_, &end);
+  if (end == pos_) {
+    return Fail("expected a number");
+  }
+  pos_ = end;
+  return true;
+}
+
+bool JsonReader::SkipValue() {
+  SkipSpace();
+  switch (*pos_) {
+    case '{': {
+      BeginObject();
+      std::string key;
+      for (bool first = true; NextElement('}', first); first = false) {
+        if (!ReadKey(key) || !SkipValue()) {
+          return false;
+        }
+      }
+      return ok();
+    }
+    case '[': {
+      BeginArray();
+      for (bool first = true; NextElement(']', first); first = false) {
+        if (!SkipValue()) {
+          return false;
+        }
+      }
+      return ok();
+    }
+    case '"': {
+      std::string s;
+      return ReadString(s);
+    }
+    case 't':
+    case 'f':
+    case 'n': {
+      static const char *const kLiterals[] = {"true", "false", "null"};
+      for (int i = 0; i < 3; i++) {
+        std::size_t length = std::strlen(kLiterals[i]);
+        if (std::strncmp(pos_, kLiterals[i], length) == 0) {
+          pos_ += length;
+          return true;
+        }
+      }
+      return Fail("invalid literal");
+    }
+    default: {
+      double value;
+      return ReadNumber(value);
+    }
+  }
+}
+
+bool ReadFunction(JsonReader &reader, FunctionProfile &fn) {
+  if (!reader.BeginObject()) {
+    return false;
+  }
+  std::string key;
+  for (bool first = true; reader.NextElement('}', first); first = false) {
+    if (!reader.ReadKey(key)) {
+      return false;
+    }
+    bool ok;
+    if (key == "type") {
+      ok = reader.ReadString(fn.type);
+    } else if (key == "name") {
+      ok = reader.ReadString(fn.name);
+    } else if (key == "calls") {
+      ok = reader.ReadNumber(fn.calls);
+    } else if (key == "selfTime") {
+      ok = reader.ReadNumber(fn.self_time);
+    } else if (key == "totalTime") {
+      ok = reader.ReadNumber(fn.total_time);
+    } else {
+      ok = reader.SkipValue();
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+  return reader.ok();
+}
+
+} // anonymous namespace
+
+Profile::Profile()
+ : duration_(0)
+{
+}
+
+bool Profile::Load(const std::string &filename, std::string &error) {
+  std::FILE *file = std::fopen(filename.c_str(), "rb");
+  if (file == 0) {
+    error = "could not open file";
+    return false;
+  }
+
+  std::string data;
+  long size = -1;
+  if (std::fseek(file, 0, SEEK_END) == 0) {
+    size = std::ftell(file);
+    std::rewind(file);
+  }
+  if (size > 0) {
+    data.resize(static_cast<std::size_t>(size));
+    size = static_cast<long>(std::fread(&data[0], 1, size, file));
+  }
+  std::fclose(file);
+  if (size < 0 || static_cast<std::size_t>(size) != data.size()) {
+    error = "could not read file";
+    return false;
+  }
+
+  return Parse(data, error);
+}
+
+bool Profile::Parse(const std::string &json, std::string &error) {
+  script_.clear();
+  duration_ = 0;
+  functions_.clear();
+
+  JsonReader reader(json.c_str());
+  bool have_functions = false;
+
+  if (reader.BeginObject()) {
+    std::string key;
+    for (bool first = true; reader.NextElement('}', first); first = false) {
+      if (!reader.ReadKey(key)) {
+        break;
+      }
+      if (key == "script") {
+        reader.ReadString(script_);
+      } else if (key == "duration") {
+        reader.ReadNumber(duration_);
+      } else if (key == "functions") {
+        have_functions = true;
+        if (!reader.BeginArray()) {
+          break;
+        }
+        for (bool first_fn = true; reader.NextElement(']', first_fn);
+             first_fn = false) {
+          FunctionProfile fn;
+          if (!ReadFunction(reader, fn)) {
+            break;
+          }
+          // The list ends with an empty object.
+          if (!fn.name.empty()) {
+            functions_.push_back(fn);
+          }
+        }
+      } else {
+        reader.SkipValue();
+      }
+      if (!reader.ok()) {
+        break;
+      }
+    }
+  }
+
+  if (!reader.ok()) {
+    error = reader.error();
+    return false;
+  }
+  if (!have_functions) {
+    error = "no function list, is this a JSON profile?";
+    return false;
+  }
+  return true;
+}
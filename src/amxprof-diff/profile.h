@@ -0,0 +1,69 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_DIFF_PROFILE_H
+#define AMXPROF_DIFF_PROFILE_H
+
+#include <string>
+#include <vector>
+
+// Statistics of a single function as written by StatisticsWriterJson.
+struct FunctionProfile {
+  FunctionProfile() : calls(0), self_time(0), total_time(0) {}
+
+  std::string type;
+  std::string name;
+  double calls;
+  double self_time;   // nanoseconds
+  double total_time;  // nanoseconds
+};
+
+// A profile loaded from a file written with profiler_outputformat json.
+class Profile {
+ public:
+  Profile();
+
+  // Reads the profile from a file. Returns false and sets error if the
+  // file can't be read or isn't a valid profile.
+  bool Load(const std::string &filename, std::string &error);
+
+  // Same as Load() but reads the profile from a string.
+  bool Parse(const std::string &json, std::string &error);
+
+  const std::string &script() const { return script_; }
+
+  // Run time of the profile in seconds, or zero if unknown.
+  double duration() const { return duration_; }
+
+  const std::vector<FunctionProfile> &functions() const {
+    return functions_;
+  }
+
+ private:
+  std::string script_;
+  double duration_;
+  std::vector<FunctionProfile> functions_;
+};
+
+#endif // !AMXPROF_DIFF_PROFILE_H
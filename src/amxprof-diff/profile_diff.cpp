@@ -0,0 +1,198 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include "profile.h"
+#include "profile_diff.h"
+
+namespace {
+
+bool CompareFunctions(const FunctionProfile *lhs,
+                      const FunctionProfile *rhs) {
+  int result = lhs->type.compare(rhs->type);
+  if (result != 0) {
+    return result < 0;
+  }
+  return lhs->name < rhs->name;
+}
+
+bool SameFunction(const FunctionProfile *lhs, const FunctionProfile *rhs) {
+  return lhs->type == rhs->type && lhs->name == rhs->name;
+}
+
+// Returns the functions of a profile sorted by type and name.
+void SortFunctions(const Profile &profile,
+                   std::vector<const FunctionProfile*> &functions) {
+  const std::vector<FunctionProfile> &all_functions = profile.functions();
+  functions.reserve(all_functions.size());
+  for (std::vector<FunctionProfile>::const_iterator iterator =
+         all_functions.begin();
+       iterator != all_functions.end(); ++iterator) {
+    functions.push_back(&*iterator);
+  }
+  std::sort(functions.begin(), functions.end(), CompareFunctions);
+}
+
+double GetScale(const Profile &profile, bool normalize) {
+  if (normalize && profile.duration() > 0) {
+    return 1.0 / profile.duration();
+  }
+  return 1.0;
+}
+
+// Adds up the counters of functions [first, last) and scales them. The
+// average time is computed before scaling.
+void AddValues(std::vector<const FunctionProfile*>::const_iterator first,
+               std::vector<const FunctionProfile*>::const_iterator last,
+               double scale,
+               double *values,
+               double *absolute_values) {
+  for (; first != last; ++first) {
+    absolute_values[METRIC_SELF_TIME] += (*first)->self_time;
+    absolute_values[METRIC_TOTAL_TIME] += (*first)->total_time;
+    absolute_values[METRIC_CALLS] += (*first)->calls;
+  }
+  if (absolute_values[METRIC_CALLS] > 0) {
+    absolute_values[METRIC_AVERAGE_TIME] =
+      absolute_values[METRIC_TOTAL_TIME] / absolute_values[METRIC_CALLS];
+  }
+  for (int i = 0; i < NUM_METRICS; i++) {
+    values[i] = absolute_values[i];
+    if (i != METRIC_AVERAGE_TIME) {
+      values[i] *= scale;
+    }
+  }
+}
+
+// Sets the average time of the total to the total self time per call.
+void SetTotalAverage(double *values) {
+  if (values[METRIC_CALLS] > 0) {
+    values[METRIC_AVERAGE_TIME] =
+      values[METRIC_SELF_TIME] / values[METRIC_CALLS];
+  }
+}
+
+} // anonymous namespace
+
+FunctionDiff::FunctionDiff()
+ : in_old(false),
+   in_new(false)
+{
+  for (int i = 0; i < NUM_METRICS; i++) {
+    old_values[i] = 0;
+    new_values[i] = 0;
+    old_absolute_values[i] = 0;
+    new_absolute_values[i] = 0;
+  }
+}
+
+double FunctionDiff::GetRelativeChange(Metric metric) const {
+  double change = GetChange(metric);
+  if (old_values[metric] == 0) {
+    if (change == 0) {
+      return 0;
+    }
+    return change > 0 ? HUGE_VAL : -HUGE_VAL;
+  }
+  return change / old_values[metric] * 100.0;
+}
+
+ProfileDiff::ProfileDiff()
+ : normalize_(true)
+{
+}
+
+void ProfileDiff::Compute(const Profile &old_profile,
+                          const Profile &new_profile) {
+  typedef std::vector<const FunctionProfile*>::const_iterator Iterator;
+
+  std::vector<const FunctionProfile*> old_functions;
+  std::vector<const FunctionProfile*> new_functions;
+  SortFunctions(old_profile, old_functions);
+  SortFunctions(new_profile, new_functions);
+
+  double old_scale = GetScale(old_profile, normalize_);
+  double new_scale = GetScale(new_profile, normalize_);
+
+  functions_.clear();
+  functions_.reserve(std::max(old_functions.size(), new_functions.size()));
+
+  // Merge the two sorted lists, taking runs of equal functions from each.
+  Iterator old_it = old_functions.begin();
+  Iterator new_it = new_functions.begin();
+  while (old_it != old_functions.end() || new_it != new_functions.end()) {
+    const FunctionProfile *fn;
+    if (new_it == new_functions.end()
+        || (old_it != old_functions.end()
+            && !CompareFunctions(*new_it, *old_it))) {
+      fn = *old_it;
+    } else {
+      fn = *new_it;
+    }
+
+    FunctionDiff diff;
+    diff.type = fn->type;
+    diff.name = fn->name;
+
+    Iterator old_last = old_it;
+    while (old_last != old_functions.end() && SameFunction(*old_last, fn)) {
+      ++old_last;
+    }
+    Iterator new_last = new_it;
+    while (new_last != new_functions.end() && SameFunction(*new_last, fn)) {
+      ++new_last;
+    }
+
+    diff.in_old = old_last != old_it;
+    diff.in_new = new_last != new_it;
+    AddValues(old_it, old_last, old_scale,
+              diff.old_values, diff.old_absolute_values);
+    AddValues(new_it, new_last, new_scale,
+              diff.new_values, diff.new_absolute_values);
+    old_it = old_last;
+    new_it = new_last;
+
+    functions_.push_back(diff);
+  }
+
+  total_ = FunctionDiff();
+  total_.in_old = true;
+  total_.in_new = true;
+  for (std::vector<FunctionDiff>::const_iterator iterator = functions_.begin();
+       iterator != functions_.end(); ++iterator) {
+    for (int i = 0; i < NUM_METRICS; i++) {
+      if (i != METRIC_AVERAGE_TIME) {
+        total_.old_values[i] += iterator->old_values[i];
+        total_.new_values[i] += iterator->new_values[i];
+        total_.old_absolute_values[i] += iterator->old_absolute_values[i];
+        total_.new_absolute_values[i] += iterator->new_absolute_values[i];
+      }
+    }
+  }
+  SetTotalAverage(total_.old_values);
+  SetTotalAverage(total_.new_values);
+  SetTotalAverage(total_.old_absolute_values);
+  SetTotalAverage(total_.new_absolute_values);
+}
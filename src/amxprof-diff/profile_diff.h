@@ -0,0 +1,95 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_DIFF_PROFILE_DIFF_H
+#define AMXPROF_DIFF_PROFILE_DIFF_H
+
+#include <string>
+#include <vector>
+
+class Profile;
+
+enum Metric {
+  METRIC_SELF_TIME,
+  METRIC_TOTAL_TIME,
+  METRIC_CALLS,
+  METRIC_AVERAGE_TIME,
+  NUM_METRICS
+};
+
+// Changes of a function between two profiles. Times are in nanoseconds,
+// or nanoseconds per second of run time if the profiles are normalized
+// (same for calls). The average time is the total time per call.
+struct FunctionDiff {
+  FunctionDiff();
+
+  // Absolute change of a metric.
+  double GetChange(Metric metric) const {
+    return new_values[metric] - old_values[metric];
+  }
+
+  // Change of a metric in percent. Returns +/-HUGE_VAL if the old value
+  // is zero.
+  double GetRelativeChange(Metric metric) const;
+
+  std::string type;
+  std::string name;
+  bool in_old;
+  bool in_new;
+  double old_values[NUM_METRICS];
+  double new_values[NUM_METRICS];
+
+  // Same as above but never normalized.
+  double old_absolute_values[NUM_METRICS];
+  double new_absolute_values[NUM_METRICS];
+};
+
+// ProfileDiff matches functions of two profiles by name and type.
+// Functions that occur more than once in a profile (e.g. static functions
+// with the same name in different files) are merged.
+class ProfileDiff {
+ public:
+  ProfileDiff();
+
+  // If enabled, times and call counts are divided by the run time of each
+  // profile, so that profiles of different length can be compared.
+  // Profiles without run time are not normalized.
+  void set_normalize(bool normalize) { normalize_ = normalize; }
+
+  void Compute(const Profile &old_profile, const Profile &new_profile);
+
+  // Functions in the order of their type and name.
+  const std::vector<FunctionDiff> &functions() const { return functions_; }
+
+  // Sum of all functions; the average time is the total self time per
+  // call.
+  const FunctionDiff &total() const { return total_; }
+
+ private:
+  bool normalize_;
+  std::vector<FunctionDiff> functions_;
+  FunctionDiff total_;
+};
+
+#endif // !AMXPROF_DIFF_PROFILE_DIFF_H
@@ -56,14 +56,61 @@ cell FindOpcode(cell *opcode_table, cell opcode) {
   #endif
 }
 
+// Number of operands of each instruction, -1 for invalid instructions and
+// instructions with a variable number of operands.
+const signed char kNumOperands[NUM_OPCODES] = {
+  -1,  1,  1,  // OP_NONE, OP_LOAD_PRI, OP_LOAD_ALT
+   1,  1,  1,  // OP_LOAD_S_PRI, OP_LOAD_S_ALT, OP_LREF_PRI
+   1,  1,  1,  // OP_LREF_ALT, OP_LREF_S_PRI, OP_LREF_S_ALT
+   0,  1,  1,  // OP_LOAD_I, OP_LODB_I, OP_CONST_PRI
+   1,  1,  1,  // OP_CONST_ALT, OP_ADDR_PRI, OP_ADDR_ALT
+   1,  1,  1,  // OP_STOR_PRI, OP_STOR_ALT, OP_STOR_S_PRI
+   1,  1,  1,  // OP_STOR_S_ALT, OP_SREF_PRI, OP_SREF_ALT
+   1,  1,  0,  // OP_SREF_S_PRI, OP_SREF_S_ALT, OP_STOR_I
+   1,  0,  1,  // OP_STRB_I, OP_LIDX, OP_LIDX_B
+   0,  1,  1,  // OP_IDXADDR, OP_IDXADDR_B, OP_ALIGN_PRI
+   1,  1,  1,  // OP_ALIGN_ALT, OP_LCTRL, OP_SCTRL
+   0,  0,  0,  // OP_MOVE_PRI, OP_MOVE_ALT, OP_XCHG
+   0,  0,  1,  // OP_PUSH_PRI, OP_PUSH_ALT, OP_PUSH_R
+   1,  1,  1,  // OP_PUSH_C, OP_PUSH, OP_PUSH_S
+   0,  0,  1,  // OP_POP_PRI, OP_POP_ALT, OP_STACK
+   1,  0,  0,  // OP_HEAP, OP_PROC, OP_RET
+   0,  1,  0,  // OP_RETN, OP_CALL, OP_CALL_PRI
+   1,  1,  1,  // OP_JUMP, OP_JREL, OP_JZER
+   1,  1,  1,  // OP_JNZ, OP_JEQ, OP_JNEQ
+   1,  1,  1,  // OP_JLESS, OP_JLEQ, OP_JGRTR
+   1,  1,  1,  // OP_JGEQ, OP_JSLESS, OP_JSLEQ
+   1,  1,  0,  // OP_JSGRTR, OP_JSGEQ, OP_SHL
+   0,  0,  1,  // OP_SHR, OP_SSHR, OP_SHL_C_PRI
+   1,  1,  1,  // OP_SHL_C_ALT, OP_SHR_C_PRI, OP_SHR_C_ALT
+   0,  0,  0,  // OP_SMUL, OP_SDIV, OP_SDIV_ALT
+   0,  0,  0,  // OP_UMUL, OP_UDIV, OP_UDIV_ALT
+   0,  0,  0,  // OP_ADD, OP_SUB, OP_SUB_ALT
+   0,  0,  0,  // OP_AND, OP_OR, OP_XOR
+   0,  0,  0,  // OP_NOT, OP_NEG, OP_INVERT
+   1,  1,  0,  // OP_ADD_C, OP_SMUL_C, OP_ZERO_PRI
+   0,  1,  1,  // OP_ZERO_ALT, OP_ZERO, OP_ZERO_S
+   0,  0,  0,  // OP_SIGN_PRI, OP_SIGN_ALT, OP_EQ
+   0,  0,  0,  // OP_NEQ, OP_LESS, OP_LEQ
+   0,  0,  0,  // OP_GRTR, OP_GEQ, OP_SLESS
+   0,  0,  0,  // OP_SLEQ, OP_SGRTR, OP_SGEQ
+   1,  1,  0,  // OP_EQ_C_PRI, OP_EQ_C_ALT, OP_INC_PRI
+   0,  1,  1,  // OP_INC_ALT, OP_INC, OP_INC_S
+   0,  0,  0,  // OP_INC_I, OP_DEC_PRI, OP_DEC_ALT
+   1,  1,  0,  // OP_DEC, OP_DEC_S, OP_DEC_I
+   1,  1,  1,  // OP_MOVS, OP_CMPS, OP_FILL
+   1,  1,  0,  // OP_HALT, OP_BOUNDS, OP_SYSREQ_PRI
+   1, -1, -1,  // OP_SYSREQ_C, OP_FILE, OP_LINE
+  -1, -1,  0,  // OP_SYMBOL, OP_SRANGE, OP_JUMP_PRI
+   1, -1,  0,  // OP_SWITCH, OP_CASETBL, OP_SWAP_PRI
+   0,  1,  0,  // OP_SWAP_ALT, OP_PUSH_ADR, OP_NOP
+   1,  1,  0,  // OP_SYSREQ_D, OP_SYMTAG, OP_BREAK
+};
+
 AMX_HEADER *GetAmxHeader(AMX *amx) {
   return reinterpret_cast<AMX_HEADER*>(amx->base);
 }
 
-unsigned char *GetAmxCodePtr(AMX *amx) {
-  return amx->base + GetAmxHeader(amx)->cod;
-}
-
 unsigned char *GetAmxDataPtr(AMX *amx) {
   return (amx->data != 0) ? amx->data
                           : amx->base + GetAmxHeader(amx)->dat;
@@ -79,6 +126,61 @@ cell RelocateOpcode(cell opcode) {
 	return opcode;
 }
 
+cell EncodeOpcode(cell opcode) {
+  #ifdef AMXPROF_RELOCATE_OPCODES
+    static cell *opcode_table = GetOpcodeTable();
+    assert(opcode >= 0 && opcode < NUM_OPCODES);
+    opcode = opcode_table[opcode];
+  #endif
+  return opcode;
+}
+
+unsigned char *GetAmxCodePtr(AMX *amx) {
+  return amx->base + GetAmxHeader(amx)->cod;
+}
+
+cell GetCodeSize(AMX *amx) {
+  AMX_HEADER *amxhdr = GetAmxHeader(amx);
+  return amxhdr->dat - amxhdr->cod;
+}
+
+Address GetCodeOffset(AMX *amx, cell address) {
+  return address - reinterpret_cast<Address>(GetAmxCodePtr(amx));
+}
+
+bool ScanCode(AMX *amx, InstructionVisitor *visitor) {
+  const unsigned char *code = GetAmxCodePtr(amx);
+  const cell num_cells = GetCodeSize(amx) / sizeof(cell);
+
+  cell index = 0;
+  while (index < num_cells) {
+    const cell *instr = reinterpret_cast<const cell*>(code) + index;
+    cell opcode = RelocateOpcode(instr[0]);
+
+    int num_operands = -1;
+    if (opcode == OP_CASETBL) {
+      // OP_CASETBL <number of cases> <default> [<value> <address>]...
+      if (index + 1 < num_cells) {
+        num_operands = 2 * instr[1] + 2;
+      }
+    } else if (opcode >= 0 && opcode < NUM_OPCODES) {
+      num_operands = kNumOperands[opcode];
+    }
+
+    if (num_operands < 0 || num_operands >= num_cells - index) {
+      return false;
+    }
+    if (!visitor->Visit(index * sizeof(cell), opcode, instr + 1,
+                        num_operands)) {
+      break;
+    }
+
+    index += 1 + num_operands;
+  }
+
+  return true;
+}
+
 Address GetNativeAddress(AMX *amx, NativeTableIndex index) {
   AMX_HEADER *amxhdr = GetAmxHeader(amx);
 
@@ -145,6 +247,14 @@ Address GetReturnAddress(AMX *amx, Address frame) {
   return 0;
 }
 
+Address GetCallerFrame(AMX *amx, Address frame) {
+  if (frame >= 0 && frame >= amx->stk && frame < amx->stp) {
+    unsigned char *data = GetAmxDataPtr(amx);
+    return *reinterpret_cast<cell*>(data + frame);
+  }
+  return 0;
+}
+
 Address GetCalleeAddress(AMX *amx, Address frame) {
   AMX_HEADER *amxhdr = GetAmxHeader(amx);
   cell code_size = amxhdr->dat - amxhdr->cod;
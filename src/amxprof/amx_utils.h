@@ -79,7 +79,35 @@ enum {
   NUM_OPCODES
 };
 
+// Converts an opcode as stored in the loaded code to its number and back.
+// The VM may replace opcode numbers with addresses of their handlers.
 cell RelocateOpcode(cell opcode);
+cell EncodeOpcode(cell opcode);
+
+unsigned char *GetAmxCodePtr(AMX *amx);
+
+// Returns the size of the code section in bytes.
+cell GetCodeSize(AMX *amx);
+
+// Converts an absolute jump or call target, as stored in the operands of
+// relocated instructions, to an address relative to the code section.
+Address GetCodeOffset(AMX *amx, cell address);
+
+class InstructionVisitor {
+ public:
+  virtual ~InstructionVisitor() {}
+
+  // Called for each instruction with its address, relocated opcode and
+  // operands. Returning false stops the scan.
+  virtual bool Visit(Address address,
+                     cell opcode,
+                     const cell *operands,
+                     int num_operands) = 0;
+};
+
+// Walks through the code section instruction by instruction. Returns false
+// if an invalid or unsupported instruction is encountered.
+bool ScanCode(AMX *amx, InstructionVisitor *visitor);
 
 Address GetNativeAddress(AMX *amx, NativeTableIndex index);
 Address GetPublicAddress(AMX *amx, PublicTableIndex index);
@@ -88,6 +116,7 @@ const char *GetNativeName(AMX *amx, NativeTableIndex index);
 const char *GetPublicName(AMX *amx, PublicTableIndex index);
 
 Address GetReturnAddress(AMX *amx, Address frame);
+Address GetCallerFrame(AMX *amx, Address frame);
 Address GetCalleeAddress(AMX *amx, Address frame);
 
 } // naemspace amxprof
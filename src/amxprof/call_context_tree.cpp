@@ -0,0 +1,183 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include "call_context_tree.h"
+#include "function_statistics.h"
+#include "statistics.h"
+
+namespace amxprof {
+
+CallContextNode::CallContextNode(FunctionStatistics *stats,
+                                 int parent,
+                                 int depth)
+ : stats_(stats),
+   parent_(parent),
+   first_child_(-1),
+   next_sibling_(-1),
+   depth_(depth),
+   num_calls_(0)
+{
+}
+
+CallContextTree::CallContextTree(int max_depth, int max_nodes)
+ : max_depth_(max_depth),
+   max_nodes_(max_nodes),
+   num_truncated_calls_(0),
+   num_truncated_frames_(0)
+{
+  // Everything is allocated up front, so that PushCall() never allocates
+  // memory. The hash table is kept at most half full.
+  std::size_t table_size = 2;
+  while (table_size < 2 * static_cast<std::size_t>(max_nodes_)) {
+    table_size <<= 1;
+  }
+  table_.resize(table_size, -1);
+  nodes_.reserve(max_nodes_ > 1 ? max_nodes_ : 1);
+  stack_.reserve(max_depth_ > 0 ? max_depth_ : 0);
+  nodes_.push_back(CallContextNode(0, -1, 0));
+}
+
+CallContextTree::CallContextTree(const CallContextTree &tree,
+                                 const Statistics *stats)
+ : max_depth_(tree.max_depth_),
+   max_nodes_(tree.max_nodes_),
+   num_truncated_calls_(tree.num_truncated_calls_),
+   num_truncated_frames_(0),
+   nodes_(tree.nodes_)
+{
+  // Snapshots are never added to, so they don't need the hash table and
+  // only take as much memory as their nodes.
+  for (std::vector<CallContextNode>::iterator iterator = nodes_.begin();
+       iterator != nodes_.end(); ++iterator) {
+    if (iterator->stats_ != 0) {
+      iterator->stats_ =
+        stats->GetFunctionStatisticsByIndex(iterator->stats_->index());
+    }
+  }
+}
+
+CallContextTree::~CallContextTree() {
+}
+
+CallContextTree *CallContextTree::Snapshot(const Statistics *stats) const {
+  return new CallContextTree(*this, stats);
+}
+
+void CallContextTree::PushCall(FunctionStatistics *stats) {
+  // Once a call is truncated, so are all calls made from it. Only their
+  // number is kept, which also bounds the stack by the maximum depth.
+  if (num_truncated_frames_ == 0) {
+    int child = GetChild(stack_.empty() ? 0 : stack_.back().node, stats);
+    if (child >= 0) {
+      Frame frame;
+      frame.node = child;
+      nodes_[child].num_calls_++;
+      stack_.push_back(frame);
+      return;
+    }
+  }
+  num_truncated_frames_++;
+  num_truncated_calls_++;
+}
+
+void CallContextTree::PopCall(Nanoseconds total_time) {
+  // The time of truncated calls is already included in the time of the
+  // deepest non-truncated call and shows up as its self time.
+  if (num_truncated_frames_ > 0) {
+    num_truncated_frames_--;
+    return;
+  }
+  if (stack_.empty()) {
+    return;
+  }
+
+  Frame frame = stack_.back();
+  stack_.pop_back();
+
+  CallContextNode &node = nodes_[frame.node];
+  node.total_time_ += total_time;
+  node.self_time_ += total_time - frame.child_time;
+
+  if (!stack_.empty()) {
+    stack_.back().child_time += total_time;
+  }
+}
+
+void CallContextTree::AddSample(FunctionStatistics *const *stack,
+                                int depth,
+                                Nanoseconds duration) {
+  int node = 0;
+  for (int i = depth - 1; i >= 0; i--) {
+    int child = GetChild(node, stack[i]);
+    if (child < 0) {
+      num_truncated_calls_++;
+      break;
+    }
+    node = child;
+    nodes_[node].total_time_ += duration;
+  }
+  if (node != 0) {
+    nodes_[node].self_time_ += duration;
+  }
+}
+
+std::size_t CallContextTree::Hash(int parent,
+                                  const FunctionStatistics *stats) const {
+  unsigned long key = static_cast<unsigned long>(parent) * 2654435761UL
+                    ^ static_cast<unsigned long>(stats->index());
+  return static_cast<std::size_t>(key) & (table_.size() - 1);
+}
+
+int CallContextTree::GetChild(int parent, FunctionStatistics *stats) {
+  std::size_t mask = table_.size() - 1;
+  std::size_t slot = Hash(parent, stats);
+
+  for (;;) {
+    int index = table_[slot];
+    if (index < 0) {
+      break;
+    }
+    const CallContextNode &node = nodes_[index];
+    if (node.parent_ == parent && node.stats_ == stats) {
+      return index;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (nodes_[parent].depth_ >= max_depth_
+      || static_cast<int>(nodes_.size()) >= max_nodes_) {
+    return -1;
+  }
+
+  int index = static_cast<int>(nodes_.size());
+  nodes_.push_back(CallContextNode(stats, parent, nodes_[parent].depth_ + 1));
+
+  CallContextNode &node = nodes_.back();
+  node.next_sibling_ = nodes_[parent].first_child_;
+  nodes_[parent].first_child_ = index;
+
+  table_[slot] = index;
+  return index;
+}
+
+} // namespace amxprof
@@ -0,0 +1,141 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef AMXPROF_CALL_CONTEXT_TREE_H
+#define AMXPROF_CALL_CONTEXT_TREE_H
+
+#include <cstddef>
+#include <vector>
+#include "duration.h"
+#include "macros.h"
+
+namespace amxprof {
+
+class FunctionStatistics;
+class Statistics;
+
+// A node of the calling-context tree represents a unique call path
+// starting from the root (host) to the node's function.
+class CallContextNode {
+ public:
+  CallContextNode(FunctionStatistics *stats, int parent, int depth);
+
+  // Returns null for the root node.
+  FunctionStatistics *stats() const { return stats_; }
+
+  // Node indexes, or -1 if there's no such node.
+  int parent() const { return parent_; }
+  int first_child() const { return first_child_; }
+  int next_sibling() const { return next_sibling_; }
+
+  int depth() const { return depth_; }
+
+  long num_calls() const { return num_calls_; }
+  Nanoseconds self_time() const { return self_time_; }
+  Nanoseconds total_time() const { return total_time_; }
+
+ private:
+  friend class CallContextTree;
+
+  FunctionStatistics *stats_;
+  int parent_;
+  int first_child_;
+  int next_sibling_;
+  int depth_;
+  long num_calls_;
+  Nanoseconds self_time_;
+  Nanoseconds total_time_;
+};
+
+// CallContextTree records call counts and times for each distinct call
+// path. Nodes are stored in a single array and children are looked up in
+// a hash table keyed by (parent node, function index).
+//
+// To bound memory usage the tree has a maximum depth and a maximum number
+// of nodes. Calls that would exceed either limit are accounted to the
+// deepest node that could be created for them. Memory for the maximum
+// number of nodes is allocated by the constructor, so that recording calls
+// doesn't allocate.
+class CallContextTree {
+ public:
+  CallContextTree(int max_depth, int max_nodes);
+  ~CallContextTree();
+
+  // Returns a copy of the nodes that refer to the function statistics in
+  // stats, which must be a snapshot of the statistics this tree was built
+  // from. The copy has no calls in progress.
+  CallContextTree *Snapshot(const Statistics *stats) const;
+
+  const CallContextNode &root() const { return nodes_[0]; }
+  const CallContextNode &node(int index) const { return nodes_[index]; }
+  int num_nodes() const { return static_cast<int>(nodes_.size()); }
+
+  int max_depth() const { return max_depth_; }
+  int max_nodes() const { return max_nodes_; }
+
+  // Returns the number of calls that didn't get their own node because
+  // of the limits.
+  long num_truncated_calls() const { return num_truncated_calls_; }
+
+  // Called when a function is entered and left. The time passed to
+  // PopCall() is the total time of the call, including callees.
+  void PushCall(FunctionStatistics *stats);
+  void PopCall(Nanoseconds total_time);
+
+  // Accounts a stack sample. The stack is ordered innermost first.
+  void AddSample(FunctionStatistics *const *stack,
+                 int depth,
+                 Nanoseconds duration);
+
+ private:
+  struct Frame {
+    int node;
+    Nanoseconds child_time;
+  };
+
+  // Copies the nodes of the tree for Snapshot(). The copy has no hash
+  // table, so no calls can be added to it.
+  CallContextTree(const CallContextTree &tree, const Statistics *stats);
+
+  // Returns the child of the node for the given function, creating it if
+  // needed. Returns -1 if the limits have been reached.
+  int GetChild(int parent, FunctionStatistics *stats);
+
+  std::size_t Hash(int parent, const FunctionStatistics *stats) const;
+
+ private:
+  int max_depth_;
+  int max_nodes_;
+  long num_truncated_calls_;
+  int num_truncated_frames_;
+  std::vector<CallContextNode> nodes_;
+  std::vector<int> table_;
+  std::vector<Frame> stack_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallContextTree);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CALL_CONTEXT_TREE_H
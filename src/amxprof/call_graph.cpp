@@ -25,11 +25,25 @@
 #include "call_graph.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "statistics.h"
 
 namespace amxprof {
 
 namespace {
 
+// Space for this many edges is reserved when the graph is created.
+const std::size_t kInitialEdges = 1024;
+
+// The edge table is kept at most half full, even when all reserved edges
+// are used.
+std::size_t GetEdgeTableSize(std::size_t max_edges) {
+  std::size_t size = 2;
+  while (size < max_edges * 2) {
+    size <<= 1;
+  }
+  return size;
+}
+
 class Deleter : public CallGraph::Visitor {
  public:
   virtual void Visit(const CallGraphNode *node) {
@@ -39,14 +53,25 @@ class Deleter : public CallGraph::Visitor {
 
 } // anonymous namespace
 
+CallGraphEdge::CallGraphEdge(CallGraphNode *caller, CallGraphNode *callee)
+ : caller_(caller),
+   callee_(callee),
+   num_calls_(0),
+   active_calls_(0)
+{
+}
+
 bool CallGraph::CompareStats::operator()(const FunctionStatistics *lhs,
                                          const FunctionStatistics *rhs) const {
-  return lhs->function()->address() < rhs->function()->address();
+  return lhs->index() < rhs->index();
 }
 
 CallGraph::CallGraph()
- : sentinel_(new CallGraphNode(this, 0))
+ : sentinel_(new CallGraphNode(this, 0)),
+   num_dropped_calls_(0)
 {
+  edges_.reserve(kInitialEdges);
+  Rehash(GetEdgeTableSize(edges_.capacity()));
 }
 
 CallGraph::~CallGraph() {
@@ -54,38 +79,202 @@ CallGraph::~CallGraph() {
   Traverse(&deleter);
 }
 
+CallGraph *CallGraph::Snapshot(const Statistics *stats) const {
+  CallGraph *copy = new CallGraph;
+
+  copy->nodes_.resize(nodes_.size(), 0);
+  for (std::size_t i = 0; i < nodes_.size(); i++) {
+    if (nodes_[i] != 0) {
+      copy->nodes_[i] = new CallGraphNode(copy,
+        stats->GetFunctionStatisticsByIndex(static_cast<int>(i)));
+    }
+  }
+  copy->num_dropped_calls_ = num_dropped_calls_;
+
+  copy->edges_.reserve(edges_.size());
+  for (std::size_t i = 0; i < edges_.size(); i++) {
+    const CallGraphEdge &source = edges_[i];
+    CallGraphEdge edge(copy->GetMatchingNode(source.caller_),
+                       copy->GetMatchingNode(source.callee_));
+    edge.num_calls_ = source.num_calls_;
+    edge.total_time_ = source.total_time_;
+    copy->edges_.push_back(edge);
+    edge.caller_->callee_edges_.push_back(static_cast<int>(i));
+  }
+  copy->edge_table_ = edge_table_;
+
+  return copy;
+}
+
+void CallGraph::AddNodes(const Statistics *stats) {
+  std::size_t num_functions = static_cast<std::size_t>(stats->num_functions());
+  if (nodes_.size() < num_functions) {
+    nodes_.resize(num_functions, 0);
+  }
+  for (std::size_t i = 0; i < num_functions; i++) {
+    if (nodes_[i] == 0) {
+      nodes_[i] = new CallGraphNode(this,
+        stats->GetFunctionStatisticsByIndex(static_cast<int>(i)));
+    }
+  }
+}
+
+void CallGraph::Reserve() {
+  if (edges_.size() * 2 <= edges_.capacity()) {
+    return;
+  }
+  // Frames refer to edges by index, so the edges may be moved.
+  edges_.reserve(edges_.size() * 4);
+  Rehash(GetEdgeTableSize(edges_.capacity()));
+}
+
 CallGraphNode *CallGraph::PushCall(FunctionStatistics *stats) {
-  CallGraphNode *node = 0;
-  NodeMap::iterator iterator = nodes_.find(stats);
-  if (iterator == nodes_.end()) {
-    node = new CallGraphNode(this, stats);
-    nodes_.insert(std::make_pair(stats, node));
+  Frame frame;
+  frame.node = GetNode(stats);
+  frame.edge = -1;
+
+  CallGraphNode *caller =
+    call_stack_.empty() ? sentinel_ : call_stack_.back().node;
+  if (caller != 0 && frame.node != 0) {
+    frame.edge = GetEdge(caller, frame.node);
+  }
+
+  if (frame.edge >= 0) {
+    CallGraphEdge &edge = edges_[frame.edge];
+    edge.num_calls_++;
+    edge.active_calls_++;
   } else {
-    node = iterator->second;
+    num_dropped_calls_++;
   }
+
+  call_stack_.push_back(frame);
+  return frame.node;
+}
+
+CallGraphNode *CallGraph::PopCall(Nanoseconds total_time) {
   if (call_stack_.empty()) {
-    sentinel_->AddCallee(node);
-  } else {
-    call_stack_.top()->AddCallee(node);
+    return 0;
   }
-  call_stack_.push(node);
-  return node;
+
+  Frame frame = call_stack_.back();
+  call_stack_.pop_back();
+
+  // Only the outermost call along an edge counts, inner calls are already
+  // included in its time.
+  if (frame.edge >= 0) {
+    CallGraphEdge &edge = edges_[frame.edge];
+    if (--edge.active_calls_ == 0) {
+      edge.total_time_ += total_time;
+    }
+  }
+
+  return frame.node;
 }
 
-CallGraphNode *CallGraph::PopCall() {
-  CallGraphNode *node = 0;
-  if (!call_stack_.empty()) {
-    node = call_stack_.top();
-    call_stack_.pop();
+void CallGraph::AddSample(FunctionStatistics *const *stack,
+                          int depth,
+                          Nanoseconds duration) {
+  // Samples are added outside of the hooks, so the graph can grow here.
+  Reserve();
+  sample_edges_.clear();
+
+  CallGraphNode *caller = sentinel_;
+  for (int i = depth - 1; i >= 0; i--) {
+    CallGraphNode *callee = GetNode(stack[i]);
+    int index = callee != 0 ? GetEdge(caller, callee) : -1;
+    if (index < 0) {
+      num_dropped_calls_++;
+      break;
+    }
+    CallGraphEdge &edge = edges_[index];
+    if (edge.active_calls_++ == 0) {
+      edge.total_time_ += duration;
+    }
+    sample_edges_.push_back(index);
+    caller = callee;
+  }
+
+  for (std::size_t i = 0; i < sample_edges_.size(); i++) {
+    edges_[sample_edges_[i]].active_calls_--;
   }
-  return node;
 }
 
 void CallGraph::Traverse(Visitor *visitor) const {
   visitor->Visit(sentinel_);
-  for (NodeMap::const_iterator iterator = nodes_.begin();
+  for (std::vector<CallGraphNode*>::const_iterator iterator = nodes_.begin();
        iterator != nodes_.end(); ++iterator) {
-    visitor->Visit(iterator->second);
+    if (*iterator != 0) {
+      visitor->Visit(*iterator);
+    }
+  }
+}
+
+CallGraphNode *CallGraph::GetNode(FunctionStatistics *stats) const {
+  std::size_t index = static_cast<std::size_t>(stats->index());
+  if (index >= nodes_.size()) {
+    return 0;
+  }
+  return nodes_[index];
+}
+
+CallGraphNode *CallGraph::GetMatchingNode(const CallGraphNode *node) const {
+  if (node->stats() == 0) {
+    return sentinel_;
+  }
+  return nodes_[node->stats()->index()];
+}
+
+std::size_t CallGraph::Hash(const CallGraphNode *caller,
+                            const CallGraphNode *callee) const {
+  // The sentinel has no function, give it an index that no function has.
+  unsigned long caller_index =
+    caller->stats() != 0 ? caller->stats()->index() + 1 : 0;
+  unsigned long callee_index = callee->stats()->index() + 1;
+  unsigned long key = caller_index * 2654435761UL ^ callee_index;
+  return static_cast<std::size_t>(key) & (edge_table_.size() - 1);
+}
+
+int CallGraph::GetEdge(CallGraphNode *caller, CallGraphNode *callee) {
+  std::size_t mask = edge_table_.size() - 1;
+  std::size_t slot = Hash(caller, callee);
+
+  for (;;) {
+    int index = edge_table_[slot];
+    if (index < 0) {
+      break;
+    }
+    const CallGraphEdge &edge = edges_[index];
+    if (edge.caller_ == caller && edge.callee_ == callee) {
+      return index;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (edges_.size() == edges_.capacity()) {
+    return -1;
+  }
+
+  int index = static_cast<int>(edges_.size());
+  edges_.push_back(CallGraphEdge(caller, callee));
+  edge_table_[slot] = index;
+  return index;
+}
+
+void CallGraph::Rehash(std::size_t table_size) {
+  std::vector<int> table(table_size, -1);
+  edge_table_.swap(table);
+
+  std::size_t mask = edge_table_.size() - 1;
+  for (std::size_t i = 0; i < table.size(); i++) {
+    int index = table[i];
+    if (index >= 0) {
+      const CallGraphEdge &edge = edges_[index];
+      std::size_t slot = Hash(edge.caller_, edge.callee_);
+      while (edge_table_[slot] >= 0) {
+        slot = (slot + 1) & mask;
+      }
+      edge_table_[slot] = index;
+    }
   }
 }
 
@@ -96,9 +285,4 @@ CallGraphNode::CallGraphNode(CallGraph *graph,
 {
 }
 
-CallGraphNode *CallGraphNode::AddCallee(CallGraphNode *node) {
-  callees_.insert(node);
-  return node;
-}
-
 } // namespace amxprof
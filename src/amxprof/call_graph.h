@@ -25,15 +25,41 @@
 #ifndef AMXPROF_CALL_GRAPH_H
 #define AMXPROF_CALL_GRAPH_H
 
-#include <map>
-#include <set>
-#include <stack>
+#include <cstddef>
+#include <vector>
+#include "duration.h"
 #include "macros.h"
 
 namespace amxprof {
 
 class CallGraphNode;
 class FunctionStatistics;
+class Statistics;
+
+// An edge of the call graph holds the number of times the caller called
+// the callee and the total time spent in the callee on behalf of that
+// caller.
+class CallGraphEdge {
+ public:
+  CallGraphEdge(CallGraphNode *caller, CallGraphNode *callee);
+
+  CallGraphNode *caller() const { return caller_; }
+  CallGraphNode *callee() const { return callee_; }
+
+  long num_calls() const { return num_calls_; }
+  Nanoseconds total_time() const { return total_time_; }
+
+ private:
+  friend class CallGraph;
+
+  CallGraphNode *caller_;
+  CallGraphNode *callee_;
+  long num_calls_;
+  Nanoseconds total_time_;
+  // Number of calls along this edge that are currently on the call stack,
+  // used to avoid counting recursive calls more than once.
+  int active_calls_;
+};
 
 class CallGraph {
   friend class CallGraphNode;
@@ -50,23 +76,76 @@ class CallGraph {
                      const FunctionStatistics *rhs) const;
   };
 
-  typedef std::map<FunctionStatistics*, CallGraphNode*, CompareStats> NodeMap;
-  typedef std::stack<CallGraphNode*> NodeStack;
-
   CallGraph();
   ~CallGraph();
 
+  // Returns a copy of the nodes and edges whose nodes refer to the function
+  // statistics in stats, which must be a snapshot of the statistics this
+  // graph was built from. The copy has no calls in progress.
+  CallGraph *Snapshot(const Statistics *stats) const;
+
   CallGraphNode *sentinel() const { return sentinel_; }
 
+  // Edges are stored in the order in which they were first seen.
+  int num_edges() const { return static_cast<int>(edges_.size()); }
+  const CallGraphEdge &edge(int index) const { return edges_[index]; }
+
+  // Returns the number of calls that were not recorded because they ran
+  // out of space for new edges, see Reserve().
+  long num_dropped_calls() const { return num_dropped_calls_; }
+
+  // Creates nodes for the functions in stats that don't have one yet.
+  // Calls to functions without a node are not recorded.
+  void AddNodes(const Statistics *stats);
+
+  // Makes sure there is room for at least as many new edges as there are
+  // edges already. PushCall() never allocates memory, so this should be
+  // called regularly outside of the profiler's hooks.
+  void Reserve();
+
+  // Called when a function is entered and left. The time passed to
+  // PopCall() is the total time of the call, including callees.
   CallGraphNode *PushCall(FunctionStatistics *stats);
-  CallGraphNode *PopCall();
+  CallGraphNode *PopCall(Nanoseconds total_time);
+
+  // Accounts a stack sample. The stack is ordered innermost first.
+  void AddSample(FunctionStatistics *const *stack,
+                 int depth,
+                 Nanoseconds duration);
 
   void Traverse(Visitor *visitor) const;
 
+ private:
+  struct Frame {
+    CallGraphNode *node;
+    int edge;
+  };
+
+  // Returns null if there's no node for the function.
+  CallGraphNode *GetNode(FunctionStatistics *stats) const;
+
+  // Returns the node of this graph for the function of a node of another
+  // graph with the same function indexes.
+  CallGraphNode *GetMatchingNode(const CallGraphNode *node) const;
+
+  // Returns the index of the edge between the two nodes, creating it if
+  // needed. Returns -1 if there's no more space for new edges.
+  int GetEdge(CallGraphNode *caller, CallGraphNode *callee);
+
+  std::size_t Hash(const CallGraphNode *caller,
+                   const CallGraphNode *callee) const;
+  void Rehash(std::size_t table_size);
+
  private:
   CallGraphNode *sentinel_;
-  NodeMap nodes_;
-  NodeStack call_stack_;
+  // Nodes are indexed by function index.
+  std::vector<CallGraphNode*> nodes_;
+  std::vector<CallGraphEdge> edges_;
+  // Open-addressed hash table of edge indexes keyed by (caller, callee).
+  std::vector<int> edge_table_;
+  long num_dropped_calls_;
+  std::vector<Frame> call_stack_;
+  std::vector<int> sample_edges_;
 
  private:
   AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallGraph);
@@ -87,13 +166,16 @@ class CallGraphNode {
   CallGraph *graph() const { return graph_; }
   FunctionStatistics *stats() const { return stats_; }
 
-  const std::set<CallGraphNode*> &callees() const { return callees_; }
-  CallGraphNode *AddCallee(CallGraphNode *node);
+  // Indexes of the outgoing edges of this node. These are only filled in
+  // by CallGraph::Snapshot(), so that recording calls doesn't allocate.
+  const std::vector<int> &callee_edges() const { return callee_edges_; }
 
  private:
+  friend class CallGraph;
+
   CallGraph *graph_;
   FunctionStatistics *stats_;
-  std::set<CallGraphNode*> callees_;
+  std::vector<int> callee_edges_;
 
  private:
   AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallGraphNode);
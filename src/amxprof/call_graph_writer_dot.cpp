@@ -25,36 +25,47 @@
 #ifndef AMXPROF_CALL_GRAPH_WRITER_H
 #define AMXPROF_CALL_GRAPH_WRITER_H
 
-#include <iostream>
 #include <string>
+#include <vector>
 #include "call_graph.h"
 #include "call_graph_writer_dot.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "output_buffer.h"
 
 namespace amxprof {
 
 void CallGraphWriterDot::Write(const CallGraph *graph) {
-  *stream() << 
+  OutputBuffer out(stream());
+
+  out <<
     "digraph \"Call graph of '" << script_name() << "'\" {\n"
     "  size=\"10,8\"; ratio=fill; rankdir=LR\n"
     "  node [style=filled];\n"
     ;
 
-  WriteNode write_node(this);
+  Nanoseconds max_edge_time;
+  for (int i = 0; i < graph->num_edges(); i++) {
+    Nanoseconds time = graph->edge(i).total_time();
+    if (time > max_edge_time) {
+      max_edge_time = time;
+    }
+  }
+
+  WriteNode write_node(this, &out, max_edge_time);
   graph->Traverse(&write_node);
   
   ComputeMaxTime compute_max_time(this);
   graph->Traverse(&compute_max_time);
 
-  WriteNodeColor write_node_color(this, compute_max_time.max_time());
+  WriteNodeColor write_node_color(this, &out, compute_max_time.max_time());
   graph->Traverse(&write_node_color);
 
-  *stream() << "}\n";
+  out << "}\n";
 }
 
 void CallGraphWriterDot::WriteNode::Visit(const CallGraphNode *node) {
-  if (node->callees().empty()) {
+  if (node->callee_edges().empty()) {
     return;
   }
 
@@ -65,38 +76,50 @@ void CallGraphWriterDot::WriteNode::Visit(const CallGraphNode *node) {
     caller_name = writer_->root_node_name();
   }
 
-  std::ostream *stream = writer_->stream();
-  std::set<CallGraphNode*>::const_iterator iterator =
-    node->callees().begin();
+  OutputBuffer &out = *out_;
+  std::vector<int>::const_iterator iterator = node->callee_edges().begin();
 
-  for (; iterator != node->callees().end(); ++iterator) {
-    const CallGraphNode *callee = *iterator;
+  for (; iterator != node->callee_edges().end(); ++iterator) {
+    const CallGraphEdge &edge = node->graph()->edge(*iterator);
+    const CallGraphNode *callee = edge.callee();
 
-    *stream << "  \"" << caller_name << "\" -> \""
-            << callee->stats()->function()->name() << "\" [color=\"";
+    out << "  \"" << caller_name << "\" -> \""
+        << callee->stats()->function()->name() << "\" [color=\"";
 
     Function::Type fn_type = callee->stats()->function()->type();
     switch (fn_type) {
       case Function::NORMAL:
-        *stream << "#777777";
+        out << "#777777";
         break;
       case Function::PUBLIC:
-        *stream << "#4B4E99";
+        out << "#4B4E99";
         break;
       case Function::NATIVE:
-        *stream << "#7C4B99";
+        out << "#7C4B99";
         break;
     }
 
-    *stream << "\"];\n";
+    // Edges through which more time is spent are drawn thicker, so that
+    // it's easy to see which caller is responsible for a hot function.
+    double ratio = 0.0;
+    if (max_edge_time_.count() > 0) {
+      ratio = edge.total_time().count() / max_edge_time_.count();
+    }
+
+    out << "\", label=\""
+        << edge.num_calls() << (edge.num_calls() == 1 ? " call" : " calls")
+        << "\\n" << Fixed(Milliseconds(edge.total_time()).count(), 3)
+        << " ms\""
+        << ", weight=" << edge.num_calls()
+        << ", penwidth=" << Fixed(1.0 + ratio * 4.0, 2) << "];\n";
   }
 }
 
 void CallGraphWriterDot::WriteNodeColor::Visit(const CallGraphNode *node) {
-  std::ostream *stream = writer_->stream();
+  OutputBuffer &out = *out_;
 
   if (node == node->graph()->sentinel()) {
-    *stream << "  \"" << writer_->root_node_name() << "\" [shape=diamond];\n";
+    out << "  \"" << writer_->root_node_name() << "\" [shape=diamond];\n";
     return;
   }
 
@@ -115,26 +138,26 @@ void CallGraphWriterDot::WriteNodeColor::Visit(const CallGraphNode *node) {
     1.0
   };
 
-  *stream << "  \"" << node->stats()->function()->name() << "\" [color=\""
-          << hsb.h << ", "
-          << hsb.s << ", "
-          << hsb.b << "\""
-          << ", shape=";
+  out << "  \"" << node->stats()->function()->name() << "\" [color=\""
+      << hsb.h << ", "
+      << hsb.s << ", "
+      << hsb.b << "\""
+      << ", shape=";
 
   Function::Type fn_type = node->stats()->function()->type();
   switch (fn_type) {
     case Function::PUBLIC:
-      *stream << "octagon";
+      out << "octagon";
       break;
     case Function::NATIVE:
-      *stream << "box";
+      out << "box";
       break;
     case Function::NORMAL:
-      *stream << "oval";
+      out << "oval";
       break;
   }
 
-  *stream << "];\n";
+  out << "];\n";
 }
 
 void CallGraphWriterDot::ComputeMaxTime::Visit(const CallGraphNode *node) {
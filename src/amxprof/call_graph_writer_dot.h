@@ -31,6 +31,7 @@
 namespace amxprof {
 
 class CallGraphNode;
+class OutputBuffer;
 
 class CallGraphWriterDot : public CallGraphWriter {
  public:
@@ -39,20 +40,31 @@ class CallGraphWriterDot : public CallGraphWriter {
  private:
   class WriteNode : public CallGraphWriter::Visitor {
    public:
-    WriteNode(CallGraphWriter *writer)
-     : CallGraphWriter::Visitor(writer)
+    WriteNode(CallGraphWriter *writer,
+              OutputBuffer *out,
+              Nanoseconds max_edge_time)
+     : CallGraphWriter::Visitor(writer),
+       out_(out),
+       max_edge_time_(max_edge_time)
     {}
     virtual void Visit(const CallGraphNode *node);
+   private:
+    OutputBuffer *out_;
+    Nanoseconds max_edge_time_;
   };
 
   class WriteNodeColor : public CallGraphWriter::Visitor {
    public:
-    WriteNodeColor(CallGraphWriter *writer, Nanoseconds max_time)
+    WriteNodeColor(CallGraphWriter *writer,
+                   OutputBuffer *out,
+                   Nanoseconds max_time)
      : CallGraphWriter::Visitor(writer),
+       out_(out),
        max_time_(max_time)
     {}
     virtual void Visit(const CallGraphNode *node);
    private:
+    OutputBuffer *out_;
     Nanoseconds max_time_;
   };
 
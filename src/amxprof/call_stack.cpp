@@ -22,27 +22,78 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <new>
 #include "call_stack.h"
 #include "function_call.h"
 #include "performance_counter.h"
 
 namespace amxprof {
 
-void CallStack::Push(Function *function, Address frame) {
-  FunctionCall *parent = calls_.empty() ? 0 : &calls_.back();
-  Push(FunctionCall(function, frame, parent));
+namespace {
+
+const std::size_t kInitialChunkSize = 64;
+
+} // anonymous namespace
+
+CallStack::CallStack()
+ : chunk_(0),
+   next_(0),
+   end_(0),
+   top_(0)
+{
+}
+
+CallStack::~CallStack() {
+  // FunctionCall is trivially destructible, so only the raw storage
+  // needs to be released here.
+  for (std::vector<Chunk>::const_iterator iterator = chunks_.begin();
+       iterator != chunks_.end(); ++iterator) {
+    ::operator delete(iterator->begin);
+  }
 }
 
-void CallStack::Push(const FunctionCall &call) {
-  calls_.push_back(call);
-  calls_.back().timer()->Start();
+void CallStack::Push(FunctionStatistics *stats, Address frame) {
+  if (next_ == end_) {
+    NextChunk();
+  }
+  top_ = new (next_++) FunctionCall(stats, frame, top_);
+  stats->PushActiveCall(top_);
+  top_->timer()->Start();
+}
+
+FunctionCall *CallStack::Pop() {
+  FunctionCall *call = top_;
+  call->timer()->Stop();
+  call->stats()->PopActiveCall(call->shadow());
+  top_ = call->parent();
+
+  next_ = call;
+  if (call == chunks_[chunk_].begin && chunk_ > 0) {
+    // The previous call is the last one in the previous chunk.
+    --chunk_;
+    next_ = end_ = chunks_[chunk_].end;
+  }
+
+  return call;
 }
 
-FunctionCall CallStack::Pop() {
-  FunctionCall top = calls_.back();
-  calls_.pop_back();
-  top.timer()->Stop();
-  return top;
+void CallStack::NextChunk() {
+  if (!chunks_.empty() && chunk_ + 1 < chunks_.size()) {
+    ++chunk_;
+  } else {
+    std::size_t size = kInitialChunkSize;
+    if (!chunks_.empty()) {
+      size = 2 * (chunks_.back().end - chunks_.back().begin);
+    }
+    Chunk chunk;
+    chunk.begin = static_cast<FunctionCall*>(
+      ::operator new(size * sizeof(FunctionCall)));
+    chunk.end = chunk.begin + size;
+    chunks_.push_back(chunk);
+    chunk_ = chunks_.size() - 1;
+  }
+  next_ = chunks_[chunk_].begin;
+  end_ = chunks_[chunk_].end;
 }
 
 } // namespace amxprof
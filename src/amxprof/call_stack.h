@@ -25,31 +25,58 @@
 #ifndef AMXPROF_CALL_STACK_H
 #define AMXPROF_CALL_STACK_H
 
-#include <list>
+#include <cstddef>
+#include <vector>
 #include "amx_types.h"
 #include "function_call.h"
+#include "macros.h"
 
 namespace amxprof {
 
-class Function;
+class FunctionStatistics;
 
+// CallStack keeps calls in a list of preallocated chunks. Each new chunk is
+// twice as large as the previous one, and chunks are never released until
+// the stack is destroyed, so Push() and Pop() don't touch the allocator in
+// the steady state and pointers to calls (e.g. FunctionCall::parent())
+// remain valid while the call is on the stack.
 class CallStack {
  public:
-  void Push(Function *function, Address frame);
-  void Push(const FunctionCall &call);
+  CallStack();
+  ~CallStack();
 
-  FunctionCall Pop();
+  void Push(FunctionStatistics *stats, Address frame);
 
-  bool is_empty() const { return calls_.empty(); }
+  // Returns the popped call. The pointer is valid until the next Push().
+  FunctionCall *Pop();
 
-  FunctionCall *top() { return &calls_.back(); }
-  const FunctionCall *top() const { return &calls_.back(); }
+  bool is_empty() const { return top_ == 0; }
+
+  FunctionCall *top() { return top_; }
+  const FunctionCall *top() const { return top_; }
+
+  FunctionCall *bottom() { return is_empty() ? 0 : chunks_.front().begin; }
+  const FunctionCall *bottom() const {
+    return is_empty() ? 0 : chunks_.front().begin;
+  }
+
+ private:
+  void NextChunk();
+
+ private:
+  struct Chunk {
+    FunctionCall *begin;
+    FunctionCall *end;
+  };
+
+  std::vector<Chunk> chunks_;
+  std::size_t chunk_;
+  FunctionCall *next_;
+  FunctionCall *end_;
+  FunctionCall *top_;
 
-  FunctionCall *bottom() { return &calls_.front(); }
-  const FunctionCall *bottom() const { return &calls_.front(); }
-  
  private:
-  std::list<FunctionCall> calls_;
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(CallStack);
 };
 
 } // namespace amxprof
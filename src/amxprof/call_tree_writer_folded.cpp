@@ -0,0 +1,88 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "call_context_tree.h"
+#include "call_tree_writer_folded.h"
+#include "duration.h"
+#include "function.h"
+#include "function_statistics.h"
+#include "output_buffer.h"
+
+namespace amxprof {
+
+namespace {
+
+// Semicolons separate frames and whitespace separates the path from the
+// time, so neither may appear in a function name.
+void AppendEscapedName(std::string &path, const std::string &name) {
+  for (std::string::const_iterator iterator = name.begin();
+       iterator != name.end(); ++iterator) {
+    char c = *iterator;
+    if (c == ';' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      path += '_';
+    } else {
+      path += c;
+    }
+  }
+}
+
+} // anonymous namespace
+
+void CallTreeWriterFolded::Write(const CallContextTree *tree) {
+  OutputBuffer out(stream());
+  std::string path;
+
+  // The root node is not part of the paths, all stacks start at the host.
+  const CallContextNode &root = tree->root();
+  for (int child = root.first_child(); child >= 0;
+       child = tree->node(child).next_sibling()) {
+    WriteNode(out, tree, child, path);
+  }
+}
+
+void CallTreeWriterFolded::WriteNode(OutputBuffer &out,
+                                     const CallContextTree *tree,
+                                     int index,
+                                     std::string &path) {
+  const CallContextNode &node = tree->node(index);
+  std::string::size_type parent_length = path.length();
+
+  if (!path.empty()) {
+    path.append(";");
+  }
+  AppendEscapedName(path, node.stats()->function()->name());
+
+  if (node.self_time().count() > 0) {
+    out << path << ' ' << Fixed(node.self_time().count(), 0) << '\n';
+  }
+
+  for (int child = node.first_child(); child >= 0;
+       child = tree->node(child).next_sibling()) {
+    WriteNode(out, tree, child, path);
+  }
+
+  path.resize(parent_length);
+}
+
+} // namespace amxprof
@@ -0,0 +1,59 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_CALL_TREE_WRITER_FOLDED_H
+#define AMXPROF_CALL_TREE_WRITER_FOLDED_H
+
+#include <string>
+#include "call_tree_writer.h"
+
+namespace amxprof {
+
+class OutputBuffer;
+
+// Writes the call tree in the "folded" (collapsed stack) format used by
+// flamegraph.pl and speedscope: one line per call path with the names of
+// the functions separated by semicolons, followed by the self time of
+// the path in nanoseconds:
+//
+//   OnPlayerUpdate;CheckAntiCheat;GetPlayerPos 123456
+//
+// Semicolons and whitespace in function names are replaced with
+// underscores.
+class CallTreeWriterFolded : public CallTreeWriter {
+ public:
+  virtual void Write(const CallContextTree *tree);
+
+ private:
+  // The path of the parent is passed in path, which is restored before
+  // returning.
+  void WriteNode(OutputBuffer &out,
+                 const CallContextTree *tree,
+                 int index,
+                 std::string &path);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CALL_TREE_WRITER_FOLDED_H
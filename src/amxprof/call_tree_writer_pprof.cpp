@@ -0,0 +1,248 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <ctime>
+#include <ostream>
+#include "call_context_tree.h"
+#include "call_tree_writer_pprof.h"
+#include "debug_info.h"
+#include "function.h"
+#include "function_statistics.h"
+#include "protobuf_encoder.h"
+
+namespace amxprof {
+
+namespace {
+
+// Field numbers from profile.proto.
+namespace profile_fields {
+  const int kSampleType = 1;
+  const int kSample = 2;
+  const int kLocation = 4;
+  const int kFunction = 5;
+  const int kStringTable = 6;
+  const int kTimeNanos = 9;
+  const int kDefaultSampleType = 14;
+}
+
+namespace value_type_fields {
+  const int kType = 1;
+  const int kUnit = 2;
+}
+
+namespace sample_fields {
+  const int kLocationId = 1;
+  const int kValue = 2;
+}
+
+namespace location_fields {
+  const int kId = 1;
+  const int kAddress = 3;
+  const int kLine = 4;
+}
+
+namespace line_fields {
+  const int kFunctionId = 1;
+  const int kLine = 2;
+}
+
+namespace function_fields {
+  const int kId = 1;
+  const int kName = 2;
+  const int kSystemName = 3;
+  const int kFilename = 4;
+  const int kStartLine = 5;
+}
+
+} // anonymous namespace
+
+CallTreeWriterPprof::CallTreeWriterPprof()
+ : debug_info_(0),
+   output_(0)
+{
+}
+
+void CallTreeWriterPprof::Write(const CallContextTree *tree) {
+  output_ = stream();
+
+  strings_.clear();
+  functions_.clear();
+  location_ids_.clear();
+
+  // The first entry of the string table must be an empty string.
+  GetStringIndex("");
+
+  // pprof computes cumulative values itself by adding up the samples of
+  // all paths that go through a function, so only self values are
+  // written. A "total" value per path would be counted again for every
+  // caller up the stack.
+  static const char *const sample_types[][2] = {
+    {"calls", "count"},
+    {"self", "nanoseconds"}
+  };
+  for (std::size_t i = 0;
+       i < sizeof(sample_types) / sizeof(*sample_types); i++) {
+    ProtobufEncoder value_type;
+    value_type.WriteInt64(value_type_fields::kType,
+                          GetStringIndex(sample_types[i][0]));
+    value_type.WriteInt64(value_type_fields::kUnit,
+                          GetStringIndex(sample_types[i][1]));
+    WriteField(profile_fields::kSampleType, value_type);
+  }
+
+  const CallContextNode &root = tree->root();
+  for (int child = root.first_child(); child >= 0;
+       child = tree->node(child).next_sibling()) {
+    WriteSamples(tree, child);
+  }
+
+  WriteFunctions();
+
+  ProtobufEncoder fields;
+  fields.WriteInt64(profile_fields::kTimeNanos,
+                    static_cast<int64_t>(std::time(0)) * 1000000000);
+  fields.WriteInt64(profile_fields::kDefaultSampleType,
+                    GetStringIndex("self"));
+  WriteData(fields.data());
+
+  output_ = 0;
+}
+
+void CallTreeWriterPprof::WriteSamples(const CallContextTree *tree,
+                                       int index) {
+  const CallContextNode &node = tree->node(index);
+  const FunctionStatistics *fn_stats = node.stats();
+
+  std::size_t fn_index = static_cast<std::size_t>(fn_stats->index());
+  if (fn_index >= functions_.size()) {
+    functions_.resize(fn_index + 1, 0);
+  }
+  functions_[fn_index] = fn_stats;
+
+  // Location IDs are function indexes plus one (zero is not a valid ID).
+  location_ids_.push_back(fn_index + 1);
+
+  // pprof wants the innermost location first.
+  std::vector<uint64_t> locations(location_ids_.rbegin(),
+                                  location_ids_.rend());
+  // Self time is a difference of measured times and may come out
+  // negative, which must not wrap around in the unsigned value.
+  int64_t self_time = node.self_time().count();
+  if (self_time < 0) {
+    self_time = 0;
+  }
+
+  std::vector<uint64_t> values;
+  values.push_back(static_cast<uint64_t>(node.num_calls()));
+  values.push_back(static_cast<uint64_t>(self_time));
+
+  ProtobufEncoder sample;
+  sample.WritePackedUInt64(sample_fields::kLocationId, locations);
+  sample.WritePackedUInt64(sample_fields::kValue, values);
+  WriteField(profile_fields::kSample, sample);
+
+  for (int child = node.first_child(); child >= 0;
+       child = tree->node(child).next_sibling()) {
+    WriteSamples(tree, child);
+  }
+
+  location_ids_.pop_back();
+}
+
+void CallTreeWriterPprof::WriteFunctions() {
+  for (std::size_t i = 0; i < functions_.size(); i++) {
+    const FunctionStatistics *fn_stats = functions_[i];
+    if (fn_stats == 0) {
+      continue;
+    }
+
+    const Function *fn = fn_stats->function();
+    uint64_t id = i + 1;
+
+    // The call tree doesn't record where in the caller a call was made,
+    // so the only location known for a function is its first line, and
+    // every sample points there.
+
+    // Natives don't live in the AMX, so there's no debug info for them.
+    std::string filename;
+    int64_t start_line = 0;
+    if (debug_info_ != 0 && fn->type() != Function::NATIVE) {
+      filename = debug_info_->LookupFile(fn->address());
+      if (!filename.empty()) {
+        // Lines in the debug info are zero-based.
+        start_line = debug_info_->LookupLine(fn->address()) + 1;
+      }
+    }
+
+    ProtobufEncoder function;
+    function.WriteUInt64(function_fields::kId, id);
+    int64_t name = GetStringIndex(fn->name());
+    function.WriteInt64(function_fields::kName, name);
+    function.WriteInt64(function_fields::kSystemName, name);
+    function.WriteInt64(function_fields::kFilename, GetStringIndex(filename));
+    function.WriteInt64(function_fields::kStartLine, start_line);
+    WriteField(profile_fields::kFunction, function);
+
+    ProtobufEncoder line;
+    line.WriteUInt64(line_fields::kFunctionId, id);
+    line.WriteInt64(line_fields::kLine, start_line);
+
+    ProtobufEncoder location;
+    location.WriteUInt64(location_fields::kId, id);
+    location.WriteUInt64(location_fields::kAddress, fn->address());
+    location.WriteMessage(location_fields::kLine, line);
+    WriteField(profile_fields::kLocation, location);
+  }
+}
+
+int64_t CallTreeWriterPprof::GetStringIndex(const std::string &s) {
+  std::map<std::string, int64_t>::const_iterator iterator = strings_.find(s);
+  if (iterator != strings_.end()) {
+    return iterator->second;
+  }
+
+  // Strings can be added to the table at any point in the output, their
+  // indexes are determined by the order in which they appear.
+  int64_t index = static_cast<int64_t>(strings_.size());
+  strings_.insert(std::make_pair(s, index));
+
+  ProtobufEncoder string;
+  string.WriteString(profile_fields::kStringTable, s);
+  WriteData(string.data());
+
+  return index;
+}
+
+void CallTreeWriterPprof::WriteField(int field,
+                                     const ProtobufEncoder &message) {
+  ProtobufEncoder encoder;
+  encoder.WriteMessage(field, message);
+  WriteData(encoder.data());
+}
+
+void CallTreeWriterPprof::WriteData(const std::string &data) {
+  output_->write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+} // namespace amxprof
@@ -0,0 +1,82 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_CALL_TREE_WRITER_PPROF_H
+#define AMXPROF_CALL_TREE_WRITER_PPROF_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+#include "call_tree_writer.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+class DebugInfo;
+class FunctionStatistics;
+class ProtobufEncoder;
+
+// Writes the call tree as an uncompressed profile.proto that can be
+// opened with pprof. Every call path becomes a sample with two values:
+// number of calls and self time in nanoseconds. pprof derives total times
+// from these. Each function has a single location at its start address
+// and line, so pprof can show time per function but not per line or per
+// call site.
+//
+// Samples are written as the tree is traversed, so apart from the output
+// only the function and string tables are kept in memory.
+class CallTreeWriterPprof : public CallTreeWriter {
+ public:
+  CallTreeWriterPprof();
+
+  // Optional, used for line numbers and file names.
+  void set_debug_info(const DebugInfo *debug_info) {
+    debug_info_ = debug_info;
+  }
+
+  virtual void Write(const CallContextTree *tree);
+
+ private:
+  void WriteSamples(const CallContextTree *tree, int index);
+  void WriteFunctions();
+
+  // Returns the index of the string in the string table, adding it to
+  // the table if needed.
+  int64_t GetStringIndex(const std::string &s);
+
+  void WriteField(int field, const ProtobufEncoder &message);
+  void WriteData(const std::string &data);
+
+ private:
+  const DebugInfo *debug_info_;
+  std::ostream *output_;
+  std::map<std::string, int64_t> strings_;
+  std::vector<const FunctionStatistics*> functions_;
+  std::vector<uint64_t> location_ids_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CALL_TREE_WRITER_PPROF_H
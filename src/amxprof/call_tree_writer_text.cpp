@@ -0,0 +1,101 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <algorithm>
+#include <vector>
+#include "call_context_tree.h"
+#include "call_tree_writer_text.h"
+#include "duration.h"
+#include "function.h"
+#include "function_statistics.h"
+#include "output_buffer.h"
+
+static const int kCallsWidth = 12;
+static const int kSelfTimeWidth = 15;
+static const int kTotalTimeWidth = 15;
+
+namespace amxprof {
+
+namespace {
+
+class CompareTotalTime {
+ public:
+  CompareTotalTime(const CallContextTree *tree) : tree_(tree) {}
+
+  bool operator()(int lhs, int rhs) const {
+    return tree_->node(lhs).total_time() > tree_->node(rhs).total_time();
+  }
+
+ private:
+  const CallContextTree *tree_;
+};
+
+} // anonymous namespace
+
+void CallTreeWriterText::Write(const CallContextTree *tree) {
+  OutputBuffer out(stream());
+
+  out << "Call tree of '" << script_name() << "'\n\n";
+
+  out << Right(kCallsWidth) << "Calls"
+      << Right(kSelfTimeWidth) << "Self (ms)"
+      << Right(kTotalTimeWidth) << "Total (ms)"
+      << "  Function\n";
+
+  WriteNode(out, tree, 0);
+}
+
+void CallTreeWriterText::WriteNode(OutputBuffer &out,
+                                   const CallContextTree *tree,
+                                   int index) {
+  const CallContextNode &node = tree->node(index);
+
+  if (node.stats() != 0) {
+    out << Right(kCallsWidth) << node.num_calls()
+        << Right(kSelfTimeWidth)
+          << Fixed(Milliseconds(node.self_time()).count(), 3)
+        << Right(kTotalTimeWidth)
+          << Fixed(Milliseconds(node.total_time()).count(), 3)
+        << "  ";
+    out.Fill(' ', 2 * (node.depth() - 1));
+    out << node.stats()->function()->name() << '\n';
+  } else {
+    out.Fill(' ', kCallsWidth + kSelfTimeWidth + kTotalTimeWidth);
+    out << "  " << root_node_name() << '\n';
+  }
+
+  // Show the most expensive paths first.
+  std::vector<int> children;
+  for (int child = node.first_child(); child >= 0;
+       child = tree->node(child).next_sibling()) {
+    children.push_back(child);
+  }
+  std::sort(children.begin(), children.end(), CompareTotalTime(tree));
+
+  for (std::vector<int>::const_iterator iterator = children.begin();
+       iterator != children.end(); ++iterator) {
+    WriteNode(out, tree, *iterator);
+  }
+}
+
+} // namespace amxprof
@@ -49,7 +49,25 @@ class TimePoint {
 
 class Clock {
  public:
+  enum Source {
+    // A monotonic system clock (CLOCK_MONOTONIC on POSIX systems,
+    // QueryPerformanceCounter() on Windows).
+    MONOTONIC,
+    // Same as MONOTONIC but cheaper to read at the expense of resolution
+    // (CLOCK_MONOTONIC_COARSE).
+    MONOTONIC_COARSE,
+    // CPU timestamp counter calibrated against the monotonic clock.
+    // Requires an invariant TSC.
+    TSC
+  };
+
   static TimePoint Now();
+
+  // Changes the time source used by Now(). Returns false if the source is
+  // not supported on this system, in which case the current source stays
+  // unchanged. This should be done before any time points are taken.
+  static bool SetSource(Source source);
+  static Source source();
 };
 
 } // namespace amxprof
@@ -24,21 +24,137 @@
 
 #include <cerrno>
 #include <ctime>
+#if defined __i386__ || defined __x86_64__
+  #include <cpuid.h>
+  #define AMXPROF_HAVE_TSC
+#endif
 #include "clock.h"
 #include "system_error.h"
 
 namespace amxprof {
 
-// static
-TimePoint Clock::Now() {
+namespace {
+
+// How long to wait when calibrating the TSC against the monotonic clock.
+const long kTscCalibrationPeriod = 20000000L; // ns
+
+Clock::Source clock_source = Clock::MONOTONIC;
+
+#ifdef AMXPROF_HAVE_TSC
+  int64_t tsc_base_ticks;
+  int64_t tsc_base_ns;
+  double tsc_ns_per_tick;
+#endif
+
+int64_t GetTime(clockid_t clock_id) {
   struct timespec ts;
 
-  if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
+  if (clock_gettime(clock_id, &ts) == -1) {
     throw SystemError("clock_gettime");
   }
 
-  int64_t ns = static_cast<int64_t>(ts.tv_sec) * 1000000000L + ts.tv_nsec;
-  return Nanoseconds(ns);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000L + ts.tv_nsec;
+}
+
+#ifdef AMXPROF_HAVE_TSC
+
+inline int64_t ReadTsc() {
+  uint32_t lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return (static_cast<int64_t>(hi) << 32) | lo;
+}
+
+// An invariant TSC runs at a constant rate regardless of frequency scaling
+// and power states (CPUID.80000007H:EDX[8]).
+bool HasInvariantTsc() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0
+      || eax < 0x80000007) {
+    return false;
+  }
+  if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+  return (edx & (1 << 8)) != 0;
+}
+
+void CalibrateTsc() {
+  int64_t start_ns = GetTime(CLOCK_MONOTONIC);
+  int64_t start_ticks = ReadTsc();
+
+  struct timespec delay = {0, kTscCalibrationPeriod};
+  while (nanosleep(&delay, &delay) == -1 && errno == EINTR) {
+    continue;
+  }
+
+  int64_t end_ns = GetTime(CLOCK_MONOTONIC);
+  int64_t end_ticks = ReadTsc();
+
+  tsc_base_ticks = start_ticks;
+  tsc_base_ns = start_ns;
+  tsc_ns_per_tick = static_cast<double>(end_ns - start_ns)
+                  / static_cast<double>(end_ticks - start_ticks);
+}
+
+#endif // AMXPROF_HAVE_TSC
+
+} // anonymous namespace
+
+// static
+TimePoint Clock::Now() {
+  switch (clock_source) {
+  #ifdef CLOCK_MONOTONIC_COARSE
+    case MONOTONIC_COARSE:
+      return Nanoseconds(GetTime(CLOCK_MONOTONIC_COARSE));
+  #endif
+  #ifdef AMXPROF_HAVE_TSC
+    case TSC: {
+      int64_t ticks = ReadTsc() - tsc_base_ticks;
+      return Nanoseconds(tsc_base_ns +
+                         static_cast<int64_t>(ticks * tsc_ns_per_tick));
+    }
+  #endif
+    default:
+      return Nanoseconds(GetTime(CLOCK_MONOTONIC));
+  }
+}
+
+// static
+bool Clock::SetSource(Source source) {
+  switch (source) {
+    case MONOTONIC:
+      break;
+    case MONOTONIC_COARSE: {
+    #ifdef CLOCK_MONOTONIC_COARSE
+      struct timespec ts;
+      if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == -1) {
+        return false;
+      }
+      break;
+    #else
+      return false;
+    #endif
+    }
+    case TSC:
+    #ifdef AMXPROF_HAVE_TSC
+      if (!HasInvariantTsc()) {
+        return false;
+      }
+      CalibrateTsc();
+      break;
+    #else
+      return false;
+    #endif
+    default:
+      return false;
+  }
+  clock_source = source;
+  return true;
+}
+
+// static
+Clock::Source Clock::source() {
+  return clock_source;
 }
 
 } // namespace amxprof
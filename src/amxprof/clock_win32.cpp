@@ -29,14 +29,22 @@
 
 namespace amxprof {
 
-// static
-TimePoint Clock::Now() {
+namespace {
+
+double GetNsPerTick() {
   LARGE_INTEGER freq;
   if (QueryPerformanceFrequency(&freq) == 0) {
     throw SystemError("QueryPerformanceFrequency");
   }
+  return 1E+9 / freq.QuadPart;
+}
 
-  double ns_per_tick = 1E+9 / freq.QuadPart;
+} // anonymous namespace
+
+// static
+TimePoint Clock::Now() {
+  // The performance counter frequency is fixed at system boot.
+  static double ns_per_tick = GetNsPerTick();
 
   LARGE_INTEGER count;
   if (QueryPerformanceCounter(&count) == 0) {
@@ -46,4 +54,15 @@ TimePoint Clock::Now() {
   return Nanoseconds(ns_per_tick * count.QuadPart);
 }
 
+// static
+bool Clock::SetSource(Source source) {
+  // Only the performance counter is supported on Windows.
+  return source == MONOTONIC;
+}
+
+// static
+Clock::Source Clock::source() {
+  return MONOTONIC;
+}
+
 } // namespace amxprof
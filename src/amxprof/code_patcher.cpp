@@ -0,0 +1,277 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <vector>
+#include "amx_utils.h"
+#include "code_patcher.h"
+
+namespace amxprof {
+
+namespace {
+
+struct Instruction {
+  Address address;
+  cell opcode;
+  const cell *operands;
+  int num_operands;
+};
+
+class InstructionCollector : public InstructionVisitor {
+ public:
+  InstructionCollector(std::vector<Instruction> &instrs,
+                       std::vector<int> &index)
+   : instrs_(instrs),
+     index_(index)
+  {
+  }
+
+  virtual bool Visit(Address address,
+                     cell opcode,
+                     const cell *operands,
+                     int num_operands) {
+    Instruction instr = {address, opcode, operands, num_operands};
+    index_[address / sizeof(cell)] = static_cast<int>(instrs_.size());
+    instrs_.push_back(instr);
+    return true;
+  }
+
+ private:
+  std::vector<Instruction> &instrs_;
+  std::vector<int> &index_;
+};
+
+// Computes which instructions can be reached on a path that changed the
+// frame pointer since the last BREAK ("dirty" paths).
+class FrameChangeAnalysis {
+ public:
+  FrameChangeAnalysis(AMX *amx,
+                      const std::vector<Instruction> &instrs,
+                      const std::vector<int> &index)
+   : amx_(amx),
+     instrs_(instrs),
+     index_(index),
+     dirty_(instrs.size(), false)
+  {
+  }
+
+  bool Run();
+
+  bool is_dirty(int i) const { return dirty_[i]; }
+
+ private:
+  bool MarkDirty(Address target);
+  bool MarkDirtyIndex(int i);
+
+ private:
+  AMX *amx_;
+  const std::vector<Instruction> &instrs_;
+  const std::vector<int> &index_;
+  std::vector<bool> dirty_;
+  std::vector<int> worklist_;
+};
+
+bool FrameChangeAnalysis::MarkDirty(Address target) {
+  if (target < 0 || target % sizeof(cell) != 0
+      || target / sizeof(cell) >= index_.size()) {
+    return false;
+  }
+  int i = index_[target / sizeof(cell)];
+  if (i < 0) {
+    return false;
+  }
+  return MarkDirtyIndex(i);
+}
+
+bool FrameChangeAnalysis::MarkDirtyIndex(int i) {
+  if (i >= static_cast<int>(instrs_.size())) {
+    return false;
+  }
+  if (!dirty_[i]) {
+    dirty_[i] = true;
+    worklist_.push_back(i);
+  }
+  return true;
+}
+
+bool FrameChangeAnalysis::Run() {
+  // Initially all instructions are clean, only those that modify the
+  // frame pointer make their successors dirty. As the state can only go
+  // from clean to dirty each instruction needs to be processed at most
+  // twice.
+  for (int i = static_cast<int>(instrs_.size()) - 1; i >= 0; i--) {
+    worklist_.push_back(i);
+  }
+
+  while (!worklist_.empty()) {
+    int i = worklist_.back();
+    worklist_.pop_back();
+
+    const Instruction &instr = instrs_[i];
+    bool dirty = dirty_[i];
+
+    switch (instr.opcode) {
+      case OP_PROC:
+      case OP_CALL:
+      case OP_CALL_PRI:
+        // Entering a function or returning from one.
+        dirty = true;
+        break;
+      case OP_SCTRL:
+        if (instr.operands[0] == 6) {
+          // Jump to an address in PRI.
+          return false;
+        }
+        if (instr.operands[0] == 5) {
+          dirty = true;
+        }
+        break;
+      case OP_BREAK:
+        dirty = false;
+        break;
+      case OP_JUMP_PRI:
+      case OP_JREL:
+        return false;
+    }
+
+    if (!dirty) {
+      continue;
+    }
+
+    switch (instr.opcode) {
+      case OP_RET:
+      case OP_RETN:
+      case OP_HALT:
+      case OP_CASETBL:
+        // No successors (OP_CASETBL is not executed).
+        break;
+      case OP_JUMP:
+        if (!MarkDirty(GetCodeOffset(amx_, instr.operands[0]))) {
+          return false;
+        }
+        break;
+      case OP_JZER:
+      case OP_JNZ:
+      case OP_JEQ:
+      case OP_JNEQ:
+      case OP_JLESS:
+      case OP_JLEQ:
+      case OP_JGRTR:
+      case OP_JGEQ:
+      case OP_JSLESS:
+      case OP_JSLEQ:
+      case OP_JSGRTR:
+      case OP_JSGEQ:
+        if (!MarkDirty(GetCodeOffset(amx_, instr.operands[0]))) {
+          return false;
+        }
+        MarkDirtyIndex(i + 1);
+        break;
+      case OP_SWITCH: {
+        Address casetbl = GetCodeOffset(amx_, instr.operands[0]);
+        if (casetbl < 0 || casetbl % sizeof(cell) != 0
+            || casetbl / sizeof(cell) >= index_.size()) {
+          return false;
+        }
+        int j = index_[casetbl / sizeof(cell)];
+        if (j < 0 || instrs_[j].opcode != OP_CASETBL) {
+          return false;
+        }
+        // OP_CASETBL <number of cases> <default> [<value> <address>]...
+        const Instruction &table = instrs_[j];
+        if (!MarkDirty(GetCodeOffset(amx_, table.operands[1]))) {
+          return false;
+        }
+        for (int k = 3; k < table.num_operands; k += 2) {
+          if (!MarkDirty(GetCodeOffset(amx_, table.operands[k]))) {
+            return false;
+          }
+        }
+        break;
+      }
+      default:
+        MarkDirtyIndex(i + 1);
+        break;
+    }
+  }
+
+  return true;
+}
+
+} // anonymous namespace
+
+CodePatcher::CodePatcher(AMX *amx)
+ : amx_(amx)
+{
+}
+
+CodePatcher::~CodePatcher() {
+}
+
+int CodePatcher::RemoveRedundantBreaks() {
+  std::vector<Instruction> instrs;
+  std::vector<int> index(GetCodeSize(amx_) / sizeof(cell), -1);
+
+  InstructionCollector collector(instrs, index);
+  if (!ScanCode(amx_, &collector)) {
+    return -1;
+  }
+
+  FrameChangeAnalysis analysis(amx_, instrs, index);
+  if (!analysis.Run()) {
+    return -1;
+  }
+
+  cell *code = reinterpret_cast<cell*>(GetAmxCodePtr(amx_));
+  cell nop = EncodeOpcode(OP_NOP);
+  int num_removed = 0;
+
+  for (std::size_t i = 0; i < instrs.size(); i++) {
+    const Instruction &instr = instrs[i];
+    if (instr.opcode == OP_BREAK && !analysis.is_dirty(i)) {
+      cell *ip = code + instr.address / sizeof(cell);
+      patches_.push_back(std::make_pair(instr.address, *ip));
+      *ip = nop;
+      num_removed++;
+    }
+  }
+
+  return num_removed;
+}
+
+void CodePatcher::Restore() {
+  cell *code = reinterpret_cast<cell*>(GetAmxCodePtr(amx_));
+  cell nop = EncodeOpcode(OP_NOP);
+
+  for (std::vector<Patch>::const_iterator iterator = patches_.begin();
+       iterator != patches_.end(); ++iterator) {
+    cell *ip = code + iterator->first / sizeof(cell);
+    // Don't overwrite code that has been modified by someone else since.
+    if (*ip == nop) {
+      *ip = iterator->second;
+    }
+  }
+
+  patches_.clear();
+}
+
+} // namespace amxprof
@@ -0,0 +1,67 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef AMXPROF_CODE_PATCHER_H
+#define AMXPROF_CODE_PATCHER_H
+
+#include <utility>
+#include <vector>
+#include "amx_types.h"
+#include "macros.h"
+
+namespace amxprof {
+
+// CodePatcher modifies the loaded code of a script to make profiling
+// cheaper and can undo its changes.
+class CodePatcher {
+ public:
+  explicit CodePatcher(AMX *amx);
+  ~CodePatcher();
+
+  // Replaces BREAK instructions that can't observe a change of the frame
+  // pointer with NOPs. The profiler's debug hook only needs to run at the
+  // first BREAK after a function is entered (PROC) or a call returns;
+  // on other BREAKs the frame is the same as on the previous one and the
+  // hook does nothing.
+  //
+  // Returns the number of removed instructions, or -1 if the code could
+  // not be analyzed (e.g. it contains indirect jumps), in which case it's
+  // left unchanged.
+  int RemoveRedundantBreaks();
+
+  // Restores the original code.
+  void Restore();
+
+ private:
+  typedef std::pair<Address, cell> Patch;
+
+  AMX *amx_;
+  std::vector<Patch> patches_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(CodePatcher);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_CODE_PATCHER_H
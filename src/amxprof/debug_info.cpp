@@ -22,86 +22,377 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <cstdio>
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include "debug_info.h"
+#include "mapped_file.h"
 
 namespace amxprof {
 
+namespace {
+
+// Size of the fixed part of a symbol record, up to the name.
+const std::size_t kSymbolHeaderSize = sizeof(AMX_DBG_SYMBOL) - 1;
+
+// Returns the index of the last entry whose address is less or equal to
+// the specified one, or -1 if there's no such entry. For unsorted tables
+// this does the same linear scan as amxdbg.c.
+template<typename Entry>
+long FindLastNotAfter(const Entry *entries,
+                      long num_entries,
+                      ucell address,
+                      bool sorted) {
+  long first = 0;
+  if (sorted) {
+    long last = num_entries;
+    while (first < last) {
+      long middle = first + (last - first) / 2;
+      if (entries[middle].address <= address) {
+        first = middle + 1;
+      } else {
+        last = middle;
+      }
+    }
+  } else {
+    while (first < num_entries && entries[first].address <= address) {
+      first++;
+    }
+  }
+  return first - 1;
+}
+
+template<typename Entry>
+bool IsSortedByAddress(const Entry *entries, long num_entries) {
+  for (long i = 1; i < num_entries; i++) {
+    if (entries[i].address < entries[i - 1].address) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a pointer past the terminating null character of the string
+// at ptr, or 0 if the string doesn't end before end.
+const unsigned char *SkipString(const unsigned char *ptr,
+                                const unsigned char *end) {
+  if (ptr >= end) {
+    return 0;
+  }
+  const void *nul = std::memchr(ptr, '\0', end - ptr);
+  if (nul == 0) {
+    return 0;
+  }
+  return static_cast<const unsigned char*>(nul) + 1;
+}
+
+template<typename Entry>
+bool CompareCodeStart(const Entry &lhs, const Entry &rhs) {
+  return lhs.codestart < rhs.codestart;
+}
+
+template<typename Entry>
+bool IsBeforeCodeStart(ucell address, const Entry &entry) {
+  return address < entry.codestart;
+}
+
+template<typename Entry>
+bool IsAfterCodeStart(const Entry &entry, ucell address) {
+  return entry.codestart < address;
+}
+
+} // anonymous namespace
+
 DebugInfo::DebugInfo()
  : amxdbg_(0),
-   last_error_(AMX_ERR_NONE)
+   loaded_(false),
+   last_error_(AMX_ERR_NONE),
+   files_sorted_(true),
+   lines_sorted_(true)
 {
 }
 
 DebugInfo::DebugInfo(const AMX_DBG *amxdbg) 
  : amxdbg_(new AMX_DBG),
-   last_error_(AMX_ERR_NONE)
+   loaded_(true),
+   last_error_(AMX_ERR_NONE),
+   files_sorted_(true),
+   lines_sorted_(true)
 {
   std::memcpy(amxdbg_, amxdbg, sizeof(AMX_DBG));
+
+  const AMX_DBG_HDR *hdr = amxdbg_->hdr;
+
+  for (int i = 0; i < hdr->files; i++) {
+    AddFile(amxdbg_->filetbl[i]->address, amxdbg_->filetbl[i]->name);
+  }
+
+  // The line count in the header may overflow, dbg_LookupLine() works
+  // around this in the same way.
+  long num_lines = hdr->lines;
+  if (hdr->symbols > 0) {
+    num_lines = static_cast<long>(
+      (reinterpret_cast<unsigned char*>(amxdbg_->symboltbl[0])
+        - reinterpret_cast<unsigned char*>(amxdbg_->linetbl))
+      / sizeof(AMX_DBG_LINE));
+  }
+  lines_.assign(amxdbg_->linetbl, amxdbg_->linetbl + num_lines);
+
+  for (int i = 0; i < hdr->symbols; i++) {
+    AddFunction(amxdbg_->symboltbl[i]);
+  }
+
+  SortTables();
 }
 
 DebugInfo::DebugInfo(const std::string &filename)
  : amxdbg_(0),
-   last_error_(AMX_ERR_NONE)
+   loaded_(false),
+   last_error_(AMX_ERR_NONE),
+   files_sorted_(true),
+   lines_sorted_(true)
 {
   Load(filename);
 }
 
 bool DebugInfo::Load(const std::string &filename) {
-  std::FILE* fp = std::fopen(filename.c_str(), "rb");
-  if (fp != 0) {
-    AMX_DBG amxdbg;
-    last_error_ = dbg_LoadInfo(&amxdbg, fp);
-    if (last_error_ == AMX_ERR_NONE) {
-      amxdbg_ = new AMX_DBG(amxdbg);
-      return true;
-    }
-    fclose(fp);
+  Unload();
+
+  // The file is only mapped while the tables are copied out of it: it's
+  // replaced when the script is recompiled, which may happen while the
+  // profiler is running.
+  MappedFile file;
+  if (!file.Open(filename)) {
+    last_error_ = AMX_ERR_NOTFOUND;
+    return false;
   }
-  return false;
+
+  last_error_ = Decode(file.data(), file.data() + file.size());
+  file.Close();
+  if (last_error_ != AMX_ERR_NONE) {
+    Unload();
+    return false;
+  }
+
+  SortTables();
+  loaded_ = true;
+  return true;
 }
 
 void DebugInfo::Unload() {
   if (amxdbg_ != 0) {
     last_error_ = dbg_FreeInfo(amxdbg_);
     delete amxdbg_;
+    amxdbg_ = 0;
   }
+  loaded_ = false;
+  names_.clear();
+  files_.clear();
+  files_sorted_ = true;
+  lines_.clear();
+  lines_sorted_ = true;
+  functions_.clear();
+}
+
+int DebugInfo::Decode(const unsigned char *begin, const unsigned char *end) {
+  AMX_HEADER amxhdr;
+  if (static_cast<std::size_t>(end - begin) < sizeof(amxhdr)) {
+    return AMX_ERR_FORMAT;
+  }
+  std::memcpy(&amxhdr, begin, sizeof(amxhdr));
+  if (amxhdr.magic != AMX_MAGIC) {
+    return AMX_ERR_FORMAT;
+  }
+  if ((amxhdr.flags & AMX_FLAG_DEBUG) == 0) {
+    return AMX_ERR_DEBUG;
+  }
+
+  // The debug section follows the AMX image.
+  AMX_DBG_HDR dbghdr;
+  if (amxhdr.size < 0
+      || amxhdr.size > end - begin
+      || static_cast<std::size_t>(end - begin - amxhdr.size) < sizeof(dbghdr)) {
+    return AMX_ERR_FORMAT;
+  }
+  const unsigned char *ptr = begin + amxhdr.size;
+  std::memcpy(&dbghdr, ptr, sizeof(dbghdr));
+  if (dbghdr.magic != AMX_DBG_MAGIC) {
+    return AMX_ERR_FORMAT;
+  }
+  if (dbghdr.size < sizeof(dbghdr)) {
+    return AMX_ERR_FORMAT;
+  }
+  if (dbghdr.size < static_cast<std::size_t>(end - ptr)) {
+    end = ptr + dbghdr.size;
+  }
+  ptr += sizeof(dbghdr);
+
+  for (int i = 0; i < dbghdr.files; i++) {
+    if (static_cast<std::size_t>(end - ptr) < sizeof(AMX_DBG_FILE)) {
+      return AMX_ERR_FORMAT;
+    }
+    const AMX_DBG_FILE *file = reinterpret_cast<const AMX_DBG_FILE*>(ptr);
+    ptr = SkipString(reinterpret_cast<const unsigned char*>(file->name), end);
+    if (ptr == 0) {
+      return AMX_ERR_FORMAT;
+    }
+    AddFile(file->address, file->name);
+  }
+
+  // The line count in the header is only 16 bits wide and overflows in
+  // large scripts. Like dbg_LoadInfo(), assume there are 65536 more lines
+  // for as long as the line table appears to continue. An empty table has
+  // no last line to compare with (dbg_LoadInfo() reads whatever precedes
+  // the table), so it's taken as is.
+  const AMX_DBG_LINE *lines = reinterpret_cast<const AMX_DBG_LINE*>(ptr);
+  long max_lines = static_cast<long>((end - ptr) / sizeof(AMX_DBG_LINE));
+  long num_lines = dbghdr.lines;
+  if (num_lines > max_lines) {
+    return AMX_ERR_FORMAT;
+  }
+  while (num_lines > 0 && num_lines + 0x10000 <= max_lines) {
+    const AMX_DBG_LINE *line = lines + num_lines;
+    if (static_cast<cell>(line->address)
+          <= static_cast<cell>((line - 1)->address)) {
+      break;
+    }
+    num_lines += 0x10000;
+  }
+  lines_.assign(lines, lines + num_lines);
+  ptr += num_lines * sizeof(AMX_DBG_LINE);
+
+  // Symbol records have variable size. A truncated table isn't treated as
+  // an error, the functions found up to that point are kept.
+  for (int i = 0; i < dbghdr.symbols; i++) {
+    if (static_cast<std::size_t>(end - ptr) <= kSymbolHeaderSize) {
+      break;
+    }
+    const AMX_DBG_SYMBOL *symbol =
+      reinterpret_cast<const AMX_DBG_SYMBOL*>(ptr);
+    ptr = SkipString(reinterpret_cast<const unsigned char*>(symbol->name),
+                     end);
+    if (ptr == 0) {
+      break;
+    }
+    AddFunction(symbol);
+
+    // Array dimensions follow the name.
+    std::size_t dims_size = symbol->dim * sizeof(AMX_DBG_SYMDIM);
+    if (static_cast<std::size_t>(end - ptr) < dims_size) {
+      break;
+    }
+    ptr += dims_size;
+  }
+
+  return AMX_ERR_NONE;
+}
+
+std::size_t DebugInfo::AddName(const char *name) {
+  std::size_t offset = names_.size();
+  names_.insert(names_.end(), name, name + std::strlen(name) + 1);
+  return offset;
+}
+
+void DebugInfo::AddFile(ucell address, const char *name) {
+  FileEntry entry;
+  entry.address = address;
+  entry.name = AddName(name);
+  files_.push_back(entry);
+}
+
+void DebugInfo::AddFunction(const AMX_DBG_SYMBOL *symbol) {
+  if (symbol->ident == iFUNCTN && symbol->name[0] != '@') {
+    FunctionEntry entry;
+    entry.codestart = symbol->codestart;
+    entry.codeend = symbol->codeend;
+    entry.name = AddName(symbol->name);
+    functions_.push_back(entry);
+  }
+}
+
+void DebugInfo::SortTables() {
+  if (!files_.empty()) {
+    files_sorted_ = IsSortedByAddress(&files_[0], files_.size());
+  }
+  if (!lines_.empty()) {
+    lines_sorted_ = IsSortedByAddress(&lines_[0], lines_.size());
+  }
+  std::stable_sort(functions_.begin(), functions_.end(),
+                   CompareCodeStart<FunctionEntry>);
 }
 
 long DebugInfo::LookupLine(Address address) const {
-  long line = 0;
-  last_error_ = dbg_LookupLine(amxdbg_, address, &line);
-  return line;
+  long index = -1;
+  if (!lines_.empty()) {
+    index = FindLastNotAfter(&lines_[0],
+                             static_cast<long>(lines_.size()),
+                             static_cast<ucell>(address),
+                             lines_sorted_);
+  }
+  if (index < 0) {
+    return 0;
+  }
+  return static_cast<long>(lines_[index].line);
 }
 
 std::string DebugInfo::LookupFile(Address address) const {
   std::string result;
-  const char *file;
-  last_error_ = dbg_LookupFile(amxdbg_, address, &file);
-  if (last_error_ == AMX_ERR_NONE) {
-    result.assign(file);
+  long index = -1;
+  if (!files_.empty()) {
+    index = FindLastNotAfter(&files_[0],
+                             static_cast<long>(files_.size()),
+                             static_cast<ucell>(address),
+                             files_sorted_);
   }
+  if (index < 0) {
+    return result;
+  }
+  result.assign(&names_[files_[index].name]);
   return result;
 }
 
 std::string DebugInfo::LookupFunction(Address address) const {
   std::string result;
-  const char *function;
-  last_error_ = dbg_LookupFunction(amxdbg_, address, &function);
-  if (last_error_ == AMX_ERR_NONE) {
-    result.assign(function);
+  ucell code_address = static_cast<ucell>(address);
+  const std::vector<FunctionEntry> &functions = functions_;
+
+  // Functions don't overlap, so only the last one starting at or before
+  // the address can contain it.
+  std::vector<FunctionEntry>::const_iterator iterator =
+    std::upper_bound(functions.begin(),
+                     functions.end(),
+                     code_address,
+                     IsBeforeCodeStart<FunctionEntry>);
+  if (iterator != functions.begin()) {
+    ucell codestart = (--iterator)->codestart;
+    iterator = std::lower_bound(functions.begin(),
+                                iterator,
+                                codestart,
+                                IsAfterCodeStart<FunctionEntry>);
+    for (; iterator != functions.end()
+           && iterator->codestart == codestart; ++iterator) {
+      if (iterator->codeend > code_address) {
+        result.assign(&names_[iterator->name]);
+        return result;
+      }
+    }
   }
   return result;
 }
 
 std::string DebugInfo::LookupFunctionExact(Address address) const {
   std::string result;
-  const char *function;
-  last_error_ = dbg_LookupFunctionExact(amxdbg_, address, &function);
-  if (last_error_ == AMX_ERR_NONE) {
-    result.assign(function);
+  ucell code_address = static_cast<ucell>(address);
+  const std::vector<FunctionEntry> &functions = functions_;
+
+  std::vector<FunctionEntry>::const_iterator iterator =
+    std::lower_bound(functions.begin(),
+                     functions.end(),
+                     code_address,
+                     IsAfterCodeStart<FunctionEntry>);
+  if (iterator != functions.end() && iterator->codestart == code_address) {
+    result.assign(&names_[iterator->name]);
+    return result;
   }
   return result;
 }
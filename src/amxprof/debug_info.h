@@ -25,7 +25,9 @@
 #ifndef AMXPROF_DEBUG_INFO_H
 #define AMXPROF_DEBUG_INFO_H
 
+#include <cstddef>
 #include <string>
+#include <vector>
 #include <amx/amx.h>
 #include <amx/amxdbg.h>
 #include "amx_types.h"
@@ -33,6 +35,16 @@
 
 namespace amxprof {
 
+// DebugInfo reads the symbolic information that the Pawn compiler appends
+// to the AMX file when compiling with -d1 or higher.
+//
+// Only the file, line and function tables are decoded. The file is mapped
+// into memory while these tables and their names are copied out of it and
+// unmapped before Load() returns, so it can be overwritten by the compiler
+// at any time afterwards.
+//
+// Lookups don't modify the object, so once the debug info is loaded it may
+// be used from several threads at the same time.
 class DebugInfo {
  public:
   DebugInfo();
@@ -42,18 +54,56 @@ class DebugInfo {
   bool Load(const std::string &filename);
   void Unload();
 
-  bool is_loaded() const { return amxdbg_ != 0; }
+  bool is_loaded() const { return loaded_; }
 
   long LookupLine(Address address) const;
   std::string LookupFile(Address address) const;
   std::string LookupFunction(Address address) const;
   std::string LookupFunctionExact(Address address) const;
 
+  // The error code of the last Load() or Unload().
   int last_error() const { return last_error_; }
 
  private:
+  // Locates the tables in the debug section in [begin, end) of an AMX file
+  // and copies them. Returns an AMX error code.
+  int Decode(const unsigned char *begin, const unsigned char *end);
+
+  // Copies a name to names_ and returns its offset.
+  std::size_t AddName(const char *name);
+  void AddFile(ucell address, const char *name);
+  void AddFunction(const AMX_DBG_SYMBOL *symbol);
+  void SortTables();
+
+ private:
+  struct FileEntry {
+    ucell address;
+    std::size_t name;
+  };
+
+  struct FunctionEntry {
+    ucell codestart;
+    ucell codeend;
+    std::size_t name;
+  };
+
+  // Only set when constructed from an AMX_DBG structure.
   AMX_DBG *amxdbg_;
-  mutable int last_error_;
+  bool loaded_;
+  int last_error_;
+
+  // Null-terminated file and function names, referenced by their offset.
+  std::vector<char> names_;
+
+  std::vector<FileEntry> files_;
+  bool files_sorted_;
+
+  std::vector<AMX_DBG_LINE> lines_;
+  bool lines_sorted_;
+
+  // Functions sorted by start address. Symbols with the same address keep
+  // their table order.
+  std::vector<FunctionEntry> functions_;
 
  private:
   AMXPROF_DISALLOW_COPY_AND_ASSIGN(DebugInfo);
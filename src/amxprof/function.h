@@ -66,7 +66,7 @@ class Function {
   // no debug info provided or the function was not found among it
   // the name is built from the string "unknown@" followed by the
   // function address in hex.
-  std::string name() const {
+  const std::string &name() const {
     return name_;
   }
 
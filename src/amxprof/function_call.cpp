@@ -26,21 +26,16 @@
 
 namespace amxprof {
 
-FunctionCall::FunctionCall(Function *function, Address frame, FunctionCall *parent)
- : fn_(function),
+FunctionCall::FunctionCall(FunctionStatistics *stats, Address frame,
+                           FunctionCall *parent)
+ : stats_(stats),
    parent_(parent),
+   shadow_(stats->active_call()),
    frame_(frame)
 {
-  FunctionCall *current = parent;
-
-  while (current != 0) {
-    if (current->fn_ == this->fn_) {
-      timer_.set_shadow(current->timer());
-      break;
-    }
-    current = current->parent_;
+  if (shadow_ != 0) {
+    timer_.set_shadow(&shadow_->timer_);
   }
-
   if (parent_ != 0) {
     timer_.set_parent(&parent_->timer_);
   }
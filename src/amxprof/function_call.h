@@ -26,6 +26,7 @@
 #define AMXPROF_FUNCTION_CALL_H
 
 #include "amx_types.h"
+#include "function_statistics.h"
 #include "performance_counter.h"
 
 namespace amxprof {
@@ -34,22 +35,31 @@ class Function;
 
 class FunctionCall {
  public:
-  FunctionCall(Function *function, Address frame, FunctionCall *parent = 0);
+  FunctionCall(FunctionStatistics *stats, Address frame,
+               FunctionCall *parent = 0);
 
-  Function *function() { return fn_; }
-  const Function *function() const { return fn_; }
+  Function *function() { return stats_->function(); }
+  const Function *function() const { return stats_->function(); }
+
+  FunctionStatistics *stats() { return stats_; }
+  const FunctionStatistics *stats() const { return stats_; }
 
   FunctionCall *parent() { return parent_; }
   const FunctionCall *parent() const { return parent_; }
 
+  // Previous active call of the same function, if this one is recursive.
+  FunctionCall *shadow() { return shadow_; }
+  const FunctionCall *shadow() const { return shadow_; }
+
   Address frame() const { return frame_; }
 
   PerformanceCounter *timer() { return &timer_; }
   const PerformanceCounter *timer() const { return &timer_; }
 
  private:
-  Function *fn_;
+  FunctionStatistics *stats_;
   FunctionCall *parent_;
+  FunctionCall *shadow_;
   Address frame_;
   PerformanceCounter timer_;
 };
@@ -22,16 +22,66 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
 #include "function_statistics.h"
 
 namespace amxprof {
 
-FunctionStatistics::FunctionStatistics(Function *fn)
+FunctionStatistics::FunctionStatistics(Function *fn, int index)
  : fn_(fn),
-   num_calls_(0)
+   index_(index),
+   num_calls_(0),
+   active_call_(0),
+   active_depth_(0),
+   self_time_histogram_(0),
+   total_time_histogram_(0)
 {
 }
 
+FunctionStatistics::~FunctionStatistics() {
+  delete self_time_histogram_;
+  delete total_time_histogram_;
+}
+
+FunctionStatistics *FunctionStatistics::Snapshot() const {
+  FunctionStatistics *copy = new FunctionStatistics(fn_, index_);
+  copy->num_calls_ = num_calls_;
+  copy->self_time_ = self_time_;
+  copy->total_time_ = total_time_;
+  copy->worst_self_time_ = worst_self_time_;
+  copy->worst_total_time_ = worst_total_time_;
+  if (self_time_histogram_ != 0) {
+    copy->self_time_histogram_ = new LatencyHistogram(*self_time_histogram_);
+    copy->total_time_histogram_ =
+      new LatencyHistogram(*total_time_histogram_);
+  }
+  return copy;
+}
+
+void FunctionStatistics::Subtract(const FunctionStatistics *base) {
+  num_calls_ -= base->num_calls_;
+  self_time_ -= base->self_time_;
+  total_time_ -= base->total_time_;
+  if (self_time_histogram_ != 0 && base->self_time_histogram_ != 0) {
+    self_time_histogram_->Subtract(*base->self_time_histogram_);
+    total_time_histogram_->Subtract(*base->total_time_histogram_);
+    worst_self_time_ = std::min(worst_self_time_,
+                                self_time_histogram_->GetPercentile(100));
+    worst_total_time_ = std::min(worst_total_time_,
+                                 total_time_histogram_->GetPercentile(100));
+  } else {
+    worst_self_time_ = Nanoseconds();
+    worst_total_time_ = Nanoseconds();
+  }
+}
+
+void FunctionStatistics::EnableHistograms() {
+  if (self_time_histogram_ == 0) {
+    self_time_histogram_ = new LatencyHistogram;
+    total_time_histogram_ = new LatencyHistogram;
+  }
+}
+
 void FunctionStatistics::AdjustSelfTime(Nanoseconds delta) {
   self_time_ += delta;
 }
@@ -26,19 +26,37 @@
 #define AMXPROF_FUNCTION_INFO_H
 
 #include "duration.h"
+#include "latency_histogram.h"
+#include "macros.h"
 
 namespace amxprof {
 
 class Function;
+class FunctionCall;
 
 // Various runtime information about a function.
 class FunctionStatistics {
  public:
-  explicit FunctionStatistics(Function *fn);
+  explicit FunctionStatistics(Function *fn, int index = 0);
+  ~FunctionStatistics();
+
+  // Returns a copy of the counters and histograms that isn't associated
+  // with any active calls.
+  FunctionStatistics *Snapshot() const;
+
+  // Turns a snapshot into the difference between it and an earlier
+  // snapshot of the same function. Worst times can't be subtracted, so
+  // they are estimated from the histograms if there are any, otherwise
+  // they are reset to zero (unknown).
+  void Subtract(const FunctionStatistics *base);
 
   Function *function() { return fn_; }
   const Function *function() const { return fn_; }
 
+  // Sequential number of this function within its Statistics object.
+  // Unlike addresses, indexes are always unique and dense.
+  int index() const { return index_; }
+
   long num_calls() const { return num_calls_; }
   void AdjustNumCalls(long delta) { num_calls_ += delta; }
 
@@ -59,13 +77,56 @@ class FunctionStatistics {
   void AdjustSelfTime(Nanoseconds delta);
   void AdjustTotalTime(Nanoseconds delta);
 
+  // Latency histograms of individual calls. They are allocated only for
+  // functions for which EnableHistograms() was called, otherwise these
+  // return null.
+  const LatencyHistogram *self_time_histogram() const {
+    return self_time_histogram_;
+  }
+  const LatencyHistogram *total_time_histogram() const {
+    return total_time_histogram_;
+  }
+
+  void EnableHistograms();
+
+  // Records the self and total time of a single call.
+  void RecordCall(Nanoseconds self_time, Nanoseconds total_time) {
+    if (self_time_histogram_ != 0) {
+      self_time_histogram_->Record(self_time);
+      total_time_histogram_->Record(total_time);
+    }
+  }
+
+  // The innermost call of this function that is currently on the call
+  // stack (or null), and the number of such calls.
+  FunctionCall *active_call() const { return active_call_; }
+  int active_depth() const { return active_depth_; }
+
+  void PushActiveCall(FunctionCall *call) {
+    active_call_ = call;
+    active_depth_++;
+  }
+
+  void PopActiveCall(FunctionCall *prev_call) {
+    active_call_ = prev_call;
+    active_depth_--;
+  }
+
  private:
   Function *fn_;
+  int index_;
   long num_calls_;
   Nanoseconds self_time_;
   Nanoseconds total_time_;
   Nanoseconds worst_self_time_;
   Nanoseconds worst_total_time_;
+  FunctionCall *active_call_;
+  int active_depth_;
+  LatencyHistogram *self_time_histogram_;
+  LatencyHistogram *total_time_histogram_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(FunctionStatistics);
 };
 
 } // namespace amxprof
@@ -0,0 +1,126 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "latency_histogram.h"
+
+namespace amxprof {
+
+namespace {
+
+// Returns the position of the most significant set bit, value must be
+// non-zero.
+int FindLastSet(uint64_t value) {
+  int position = 0;
+  for (int shift = 32; shift > 0; shift /= 2) {
+    if (value >> shift != 0) {
+      value >>= shift;
+      position += shift;
+    }
+  }
+  return position;
+}
+
+} // anonymous namespace
+
+LatencyHistogram::LatencyHistogram() {
+  Clear();
+}
+
+void LatencyHistogram::Record(Nanoseconds value) {
+  uint64_t ns = 0;
+  if (value.count() > 0) {
+    ns = static_cast<uint64_t>(value.count());
+  }
+  counts_[GetBucketIndex(ns)]++;
+  total_count_++;
+  if (ns > max_value_) {
+    max_value_ = ns;
+  }
+}
+
+Nanoseconds LatencyHistogram::GetPercentile(double percent) const {
+  if (total_count_ == 0) {
+    return Nanoseconds();
+  }
+
+  uint64_t rank = static_cast<uint64_t>(
+    static_cast<double>(total_count_) * percent / 100.0 + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  }
+
+  uint64_t count = 0;
+  for (int i = 0; i < kNumBuckets; i++) {
+    count += counts_[i];
+    if (count >= rank) {
+      uint64_t value = GetBucketUpperBound(i);
+      if (value > max_value_) {
+        value = max_value_;
+      }
+      return Nanoseconds(static_cast<double>(value));
+    }
+  }
+
+  return Nanoseconds(static_cast<double>(max_value_));
+}
+
+void LatencyHistogram::Subtract(const LatencyHistogram &other) {
+  for (int i = 0; i < kNumBuckets; i++) {
+    counts_[i] -= other.counts_[i];
+  }
+  total_count_ -= other.total_count_;
+}
+
+void LatencyHistogram::Clear() {
+  for (int i = 0; i < kNumBuckets; i++) {
+    counts_[i] = 0;
+  }
+  total_count_ = 0;
+  max_value_ = 0;
+}
+
+// Values below 2 * kSubBuckets are stored as is. Larger values are
+// shifted right until they fit into [kSubBuckets, 2 * kSubBuckets), and
+// the shift count selects the group of buckets.
+int LatencyHistogram::GetBucketIndex(uint64_t value) {
+  if (value < 2 * kSubBuckets) {
+    return static_cast<int>(value);
+  }
+  int shift = FindLastSet(value) - kSubBucketBits;
+  if (shift > kMaxValueBits - kSubBucketBits - 1) {
+    return kNumBuckets - 1;
+  }
+  return shift * kSubBuckets + static_cast<int>(value >> shift);
+}
+
+uint64_t LatencyHistogram::GetBucketUpperBound(int index) {
+  if (index < 2 * kSubBuckets) {
+    return static_cast<uint64_t>(index);
+  }
+  int shift = index / kSubBuckets - 1;
+  uint64_t mantissa = static_cast<uint64_t>(index % kSubBuckets + kSubBuckets);
+  return ((mantissa + 1) << shift) - 1;
+}
+
+} // namespace amxprof
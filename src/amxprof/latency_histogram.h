@@ -0,0 +1,77 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_LATENCY_HISTOGRAM_H
+#define AMXPROF_LATENCY_HISTOGRAM_H
+
+#include "duration.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+// LatencyHistogram is a fixed-size histogram of durations with buckets
+// growing exponentially, similar to HdrHistogram. Each power of two is
+// split into kSubBuckets linear buckets, so the relative error of any
+// value is below 1/kSubBuckets (about 6%). Durations of 2^kMaxValueBits
+// nanoseconds (a little over two minutes) and longer go to the last bucket.
+//
+// Recording a value is O(1) and never allocates memory.
+class LatencyHistogram {
+ public:
+  static const int kSubBucketBits = 4;
+  static const int kSubBuckets = 1 << kSubBucketBits;
+  static const int kMaxValueBits = 37;
+  static const int kNumBuckets =
+    (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  LatencyHistogram();
+
+  uint64_t total_count() const { return total_count_; }
+
+  void Record(Nanoseconds value);
+
+  // Returns the value below which the given percentage of recorded values
+  // fall, e.g. GetPercentile(99.9). Returns zero if the histogram is empty.
+  Nanoseconds GetPercentile(double percent) const;
+
+  // Removes values recorded in an earlier copy of this histogram, leaving
+  // only the values recorded since the copy was made. The maximum value
+  // can't be taken back, so it still limits percentiles from above.
+  void Subtract(const LatencyHistogram &other);
+
+  void Clear();
+
+ private:
+  static int GetBucketIndex(uint64_t value);
+  static uint64_t GetBucketUpperBound(int index);
+
+ private:
+  uint64_t counts_[kNumBuckets];
+  uint64_t total_count_;
+  uint64_t max_value_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_LATENCY_HISTOGRAM_H
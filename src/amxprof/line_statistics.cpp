@@ -0,0 +1,83 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "amx_utils.h"
+#include "line_statistics.h"
+
+namespace amxprof {
+
+LineStatistics::LineStatistics(AMX *amx)
+ : num_hits_(GetCodeSize(amx) / sizeof(cell)),
+   self_time_(num_hits_.size()),
+   current_address_(-1)
+{
+}
+
+LineStatistics::LineStatistics()
+ : current_address_(-1)
+{
+}
+
+LineStatistics *LineStatistics::Snapshot() const {
+  LineStatistics *copy = new LineStatistics;
+  copy->num_hits_ = num_hits_;
+  copy->self_time_ = self_time_;
+  return copy;
+}
+
+void LineStatistics::Hit(Address address) {
+  TimePoint now = Clock::Now();
+  Flush(now);
+
+  if (address >= 0 && address < code_size()) {
+    num_hits_[address / sizeof(cell)]++;
+    current_address_ = address;
+    current_start_ = now;
+  }
+}
+
+Address LineStatistics::Suspend() {
+  Address address = current_address_;
+  Flush(Clock::Now());
+  return address;
+}
+
+void LineStatistics::Resume(Address address) {
+  TimePoint now = Clock::Now();
+  Flush(now);
+
+  if (address >= 0 && address < code_size()) {
+    current_address_ = address;
+    current_start_ = now;
+  }
+}
+
+void LineStatistics::Flush(TimePoint now) {
+  if (current_address_ >= 0) {
+    self_time_[current_address_ / sizeof(cell)] += now - current_start_;
+    current_address_ = -1;
+  }
+}
+
+} // namespace amxprof
@@ -0,0 +1,93 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_LINE_STATISTICS_H
+#define AMXPROF_LINE_STATISTICS_H
+
+#include <vector>
+#include "amx_types.h"
+#include "clock.h"
+#include "duration.h"
+#include "macros.h"
+
+namespace amxprof {
+
+// LineStatistics counts how many times each instruction was hit by the
+// debug hook and how much time was spent between a hit and the next one.
+// The compiler emits a BREAK instruction at the start of every statement,
+// so once resolved to source lines this tells which lines are hot.
+//
+// Counters are kept in flat arrays indexed by code address, so recording
+// a hit doesn't allocate memory or look anything up.
+class LineStatistics {
+ public:
+  explicit LineStatistics(AMX *amx);
+
+  // Returns a copy of the counters. Time spent on the current address is
+  // not included until the next hit.
+  LineStatistics *Snapshot() const;
+
+  // Size of the code section in bytes. Valid addresses are in the range
+  // [0, code_size()).
+  Address code_size() const {
+    return static_cast<Address>(num_hits_.size() * sizeof(cell));
+  }
+
+  long num_hits(Address address) const {
+    return num_hits_[address / sizeof(cell)];
+  }
+  Nanoseconds self_time(Address address) const {
+    return self_time_[address / sizeof(cell)];
+  }
+
+  // Should be called from the debug hook with the current instruction
+  // pointer. The time since the previous hit goes to the previous address.
+  void Hit(Address address);
+
+  // Stops timing the current address, e.g. while a native function runs,
+  // and returns it so that it can be passed to Resume() later. Returns -1
+  // if there's nothing being timed.
+  Address Suspend();
+
+  // Resumes timing an address returned by Suspend().
+  void Resume(Address address);
+
+ private:
+  LineStatistics();
+
+  void Flush(TimePoint now);
+
+ private:
+  std::vector<long> num_hits_;
+  std::vector<Nanoseconds> self_time_;
+  Address current_address_;
+  TimePoint current_start_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(LineStatistics);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_LINE_STATISTICS_H
@@ -0,0 +1,167 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <vector>
+#include "debug_info.h"
+#include "duration.h"
+#include "line_statistics.h"
+#include "line_statistics_writer_text.h"
+#include "output_buffer.h"
+
+static const int kLocationWidth = 40;
+static const int kFunctionWidth = 32;
+static const int kHitsWidth = 12;
+static const int kSelfTimePercentWidth = 15;
+static const int kSelfTimeWidth = 15;
+static const int kAvgSelfTimeWidth = 15;
+
+static const int kWidthAll = kLocationWidth + kFunctionWidth + kHitsWidth
+  + kSelfTimePercentWidth + kSelfTimeWidth + kAvgSelfTimeWidth;
+
+static const int kNumColumns = 6;
+
+static const int kLineWidth = kWidthAll + kNumColumns * 2 + 1;
+
+namespace amxprof {
+
+namespace {
+
+struct LineInfo {
+  LineInfo() : num_hits(0) {}
+
+  std::string location;
+  std::string function;
+  long num_hits;
+  Nanoseconds self_time;
+};
+
+bool CompareSelfTime(const LineInfo *lhs, const LineInfo *rhs) {
+  return lhs->self_time > rhs->self_time;
+}
+
+} // anonymous namespace
+
+LineStatisticsWriterText::LineStatisticsWriterText()
+ : stream_(0),
+   debug_info_(0)
+{
+}
+
+void LineStatisticsWriterText::DoHLine(OutputBuffer &out, int width) {
+  out.Fill('-', width);
+  out << '\n';
+}
+
+void LineStatisticsWriterText::Write(const LineStatistics *line_stats) {
+  // Several instructions may belong to the same line (e.g. the condition
+  // and the increment of a for loop), so group them by location first.
+  std::map<std::string, LineInfo> lines;
+  Nanoseconds self_time_all;
+
+  for (Address address = 0;
+       address < line_stats->code_size();
+       address += sizeof(cell)) {
+    long num_hits = line_stats->num_hits(address);
+    if (num_hits == 0) {
+      continue;
+    }
+
+    std::string location;
+    std::string function;
+    char buffer[32];
+
+    if (debug_info_ != 0) {
+      location = debug_info_->LookupFile(address);
+    }
+    if (!location.empty()) {
+      // Lines in the debug info are zero-based.
+      std::sprintf(buffer, ":%ld", debug_info_->LookupLine(address) + 1);
+      location.append(buffer);
+      function = debug_info_->LookupFunction(address);
+    } else {
+      std::sprintf(buffer, "unknown@%08lx",
+                   static_cast<unsigned long>(address));
+      location.assign(buffer);
+    }
+
+    LineInfo &line = lines[location];
+    line.location = location;
+    line.function = function;
+    line.num_hits += num_hits;
+    line.self_time += line_stats->self_time(address);
+    self_time_all += line_stats->self_time(address);
+  }
+
+  std::vector<const LineInfo*> sorted_lines;
+  for (std::map<std::string, LineInfo>::const_iterator iterator =
+         lines.begin();
+       iterator != lines.end(); ++iterator) {
+    sorted_lines.push_back(&iterator->second);
+  }
+  std::stable_sort(sorted_lines.begin(), sorted_lines.end(), CompareSelfTime);
+
+  OutputBuffer out(stream());
+
+  out << "Line profile of '" << script_name() << "'\n";
+
+  DoHLine(out, kLineWidth);
+  out
+    << "| " << Left(kLocationWidth) << "Location"
+    << "| " << Left(kFunctionWidth) << "Function"
+    << "| " << Left(kHitsWidth) << "Hits"
+    << "| " << Left(kSelfTimePercentWidth) << "Self Time (%)"
+    << "| " << Left(kSelfTimeWidth) << "Self Time (s)"
+    << "| " << Left(kAvgSelfTimeWidth) << "Avg. ST (us)"
+    << "|\n";
+  DoHLine(out, kLineWidth);
+
+  for (std::vector<const LineInfo*>::const_iterator iterator =
+         sorted_lines.begin();
+       iterator != sorted_lines.end(); ++iterator) {
+    const LineInfo *line = *iterator;
+
+    double self_time_percent = 0;
+    if (self_time_all.count() > 0) {
+      self_time_percent = line->self_time.count() * 100 / self_time_all.count();
+    }
+
+    out
+      << "| " << Left(kLocationWidth) << line->location
+      << "| " << Left(kFunctionWidth) << line->function
+      << "| " << Left(kHitsWidth) << line->num_hits
+      << "| " << Left(kSelfTimePercentWidth) << Fixed(self_time_percent, 2)
+      << "| " << Left(kSelfTimeWidth)
+        << Fixed(Seconds(line->self_time).count(), 3)
+      << "| " << Left(kAvgSelfTimeWidth)
+        << Fixed(Microseconds(line->self_time).count() / line->num_hits, 3)
+      << "|\n";
+  }
+
+  DoHLine(out, kLineWidth);
+}
+
+} // namespace amxprof
@@ -0,0 +1,63 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_MAPPED_FILE_H
+#define AMXPROF_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include "macros.h"
+
+namespace amxprof {
+
+// A read-only memory mapping of a whole file. Pages are read from disk
+// when they are first accessed, so only the parts that are used end up
+// in memory.
+class MappedFile {
+ public:
+  MappedFile();
+  ~MappedFile();
+
+  // Returns false if the file could not be opened or mapped, or is empty.
+  bool Open(const std::string &filename);
+  void Close();
+
+  bool is_open() const { return data_ != 0; }
+
+  const unsigned char *data() const {
+    return static_cast<const unsigned char*>(data_);
+  }
+  std::size_t size() const { return size_; }
+
+ private:
+  void *data_;
+  std::size_t size_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_MAPPED_FILE_H
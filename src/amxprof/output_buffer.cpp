@@ -0,0 +1,296 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include "output_buffer.h"
+
+namespace amxprof {
+
+namespace {
+
+const double kPowersOf10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+// Fixed values are scaled by 10^precision and rounded by hand if the
+// result is below these limits, otherwise (and for infinities and NaNs)
+// they are formatted with sprintf(). Scaling by a power of ten other than
+// one is inexact, so the limit is lower to keep the error well below
+// kTieTolerance.
+const double kMaxFastFixed = 9.0e18;
+const double kMaxFastFixedScaled = 1.0e9;
+
+// How close to a tie the scaled value may be to be rounded by hand.
+const double kTieTolerance = 1e-6;
+
+// Maps each character to the character that follows the backslash in its
+// escape sequence, or to zero if it doesn't need escaping. According to
+// http://www.json.org other escape sequences, apart from Unicode, are not
+// supported by JSON.
+class JsonEscapeTable {
+ public:
+  JsonEscapeTable() {
+    std::memset(table_, 0, sizeof(table_));
+    table_[static_cast<unsigned char>('"')] = '"';
+    table_[static_cast<unsigned char>('\\')] = '\\';
+    table_[static_cast<unsigned char>('\b')] = 'b';
+    table_[static_cast<unsigned char>('\f')] = 'f';
+    table_[static_cast<unsigned char>('\n')] = 'n';
+    table_[static_cast<unsigned char>('\r')] = 'r';
+    table_[static_cast<unsigned char>('\t')] = 't';
+  }
+
+  char operator[](char c) const {
+    return table_[static_cast<unsigned char>(c)];
+  }
+
+ private:
+  char table_[256];
+};
+
+const JsonEscapeTable kJsonEscapes;
+
+// Formats the digits of value backwards, ending at end. Returns a pointer
+// to the first digit.
+char *FormatDigits(uint64_t value, char *end) {
+  char *p = end;
+  do {
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  return p;
+}
+
+// Unlike value < 0, this is also true for negative zero, which printf()
+// writes with a minus sign.
+bool HasSignBit(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits >> 63) != 0;
+}
+
+} // anonymous namespace
+
+OutputBuffer::OutputBuffer(std::ostream *stream, std::size_t capacity)
+ : stream_(stream),
+   buffer_(std::max<std::size_t>(capacity, 1)),
+   pos_(&buffer_[0]),
+   end_(&buffer_[0] + buffer_.size()),
+   width_(0),
+   left_(false),
+   fill_(' ')
+{
+}
+
+OutputBuffer::~OutputBuffer() {
+  Flush();
+}
+
+void OutputBuffer::Flush() {
+  char *begin = &buffer_[0];
+  if (pos_ != begin) {
+    stream_->write(begin, pos_ - begin);
+    pos_ = begin;
+  }
+}
+
+void OutputBuffer::WriteSlow(const char *data, std::size_t size) {
+  Flush();
+  if (size >= buffer_.size()) {
+    stream_->write(data, size);
+  } else {
+    std::memcpy(pos_, data, size);
+    pos_ += size;
+  }
+}
+
+void OutputBuffer::Fill(char c, std::size_t count) {
+  while (count > 0) {
+    if (pos_ == end_) {
+      Flush();
+    }
+    std::size_t n = std::min(count, static_cast<std::size_t>(end_ - pos_));
+    std::memset(pos_, c, n);
+    pos_ += n;
+    count -= n;
+  }
+}
+
+void OutputBuffer::WriteField(const char *data, std::size_t size) {
+  std::size_t width = static_cast<std::size_t>(width_);
+  width_ = 0;
+
+  if (size >= width) {
+    Write(data, size);
+  } else if (left_) {
+    Write(data, size);
+    Fill(fill_, width - size);
+  } else {
+    Fill(fill_, width - size);
+    Write(data, size);
+  }
+}
+
+void OutputBuffer::WriteInteger(int64_t value) {
+  char buffer[24];
+  char *end = buffer + sizeof(buffer);
+
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  if (value < 0) {
+    magnitude = 0 - magnitude;
+  }
+
+  char *p = FormatDigits(magnitude, end);
+  if (value < 0) {
+    *--p = '-';
+  }
+  WriteField(p, end - p);
+}
+
+OutputBuffer &OutputBuffer::operator<<(char c) {
+  WriteField(&c, 1);
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const char *s) {
+  WriteField(s, std::strlen(s));
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const std::string &s) {
+  WriteField(s.data(), s.size());
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(int value) {
+  WriteInteger(value);
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(long value) {
+  WriteInteger(value);
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(unsigned long value) {
+  char buffer[24];
+  char *end = buffer + sizeof(buffer);
+  char *p = FormatDigits(value, end);
+  WriteField(p, end - p);
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(double value) {
+  char buffer[32];
+  int size = std::sprintf(buffer, "%g", value);
+  WriteField(buffer, size);
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const Fixed &fixed) {
+  bool negative = HasSignBit(fixed.value);
+  double magnitude = negative ? -fixed.value : fixed.value;
+  double scaled = magnitude * kPowersOf10[fixed.precision];
+  double limit = fixed.precision > 0 ? kMaxFastFixedScaled : kMaxFastFixed;
+
+  uint64_t digits = 0;
+  double remainder = 0;
+  bool fast = scaled < limit;
+  if (fast) {
+    digits = static_cast<uint64_t>(scaled);
+    remainder = scaled - static_cast<double>(digits);
+    // The value may have ended up on the wrong side of a tie.
+    fast = remainder < 0.5 - kTieTolerance || remainder > 0.5 + kTieTolerance;
+  }
+
+  if (!fast) {
+    // Enough for the largest double with nine decimals.
+    char buffer[512];
+    int size = std::sprintf(buffer, "%.*f", fixed.precision, fixed.value);
+    WriteField(buffer, size);
+    return *this;
+  }
+
+  if (remainder > 0.5) {
+    digits++;
+  }
+
+  char buffer[32];
+  char *end = buffer + sizeof(buffer);
+  char *p = end;
+
+  for (int i = 0; i < fixed.precision; i++) {
+    *--p = static_cast<char>('0' + digits % 10);
+    digits /= 10;
+  }
+  if (fixed.precision > 0) {
+    *--p = '.';
+  }
+  p = FormatDigits(digits, p);
+  if (negative) {
+    *--p = '-';
+  }
+
+  WriteField(p, end - p);
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const Left &left) {
+  width_ = left.width;
+  left_ = true;
+  fill_ = left.fill;
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const Right &right) {
+  width_ = right.width;
+  left_ = false;
+  fill_ = right.fill;
+  return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const JsonEscaped &escaped) {
+  const char *p = escaped.str.data();
+  const char *end = p + escaped.str.size();
+  const char *run = p;
+
+  for (; p != end; ++p) {
+    char c = kJsonEscapes[*p];
+    if (c != 0) {
+      Write(run, p - run);
+      char sequence[2] = {'\\', c};
+      Write(sequence, sizeof(sequence));
+      run = p + 1;
+    }
+  }
+
+  Write(run, end - run);
+  width_ = 0;
+  return *this;
+}
+
+} // namespace amxprof
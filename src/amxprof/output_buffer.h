@@ -0,0 +1,132 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_OUTPUT_BUFFER_H
+#define AMXPROF_OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "macros.h"
+#include "stdint.h"
+
+namespace amxprof {
+
+// Formats a number with a fixed number of digits after the decimal point,
+// like std::fixed with std::setprecision(). Precision must be in [0, 9].
+struct Fixed {
+  Fixed(double value, int precision) : value(value), precision(precision) {}
+  double value;
+  int precision;
+};
+
+// Sets the width of the next field, like std::setw() with std::left or
+// std::right. Shorter fields are padded with the fill character.
+struct Left {
+  explicit Left(int width, char fill = ' ') : width(width), fill(fill) {}
+  int width;
+  char fill;
+};
+
+struct Right {
+  explicit Right(int width, char fill = ' ') : width(width), fill(fill) {}
+  int width;
+  char fill;
+};
+
+// Writes a string with characters escaped as required inside a JSON
+// string literal. The field width is ignored.
+struct JsonEscaped {
+  explicit JsonEscaped(const std::string &str) : str(str) {}
+  const std::string &str;
+};
+
+// OutputBuffer is a fast replacement for formatting with operator<< on
+// an std::ostream. Output is collected in a large buffer that is passed to
+// the stream in one write() call whenever it fills up, and numbers are
+// formatted by hand without consulting the stream's locale or allocating
+// memory. The text is the same as the stream would produce with the "C"
+// locale.
+//
+// The buffer is flushed when the object is destroyed.
+class OutputBuffer {
+ public:
+  static const std::size_t kDefaultCapacity = 65536;
+
+  explicit OutputBuffer(std::ostream *stream,
+                        std::size_t capacity = kDefaultCapacity);
+  ~OutputBuffer();
+
+  void Flush();
+
+  void Write(const char *data, std::size_t size) {
+    if (size <= static_cast<std::size_t>(end_ - pos_)) {
+      std::char_traits<char>::copy(pos_, data, size);
+      pos_ += size;
+    } else {
+      WriteSlow(data, size);
+    }
+  }
+
+  // Writes count copies of a character.
+  void Fill(char c, std::size_t count);
+
+  void WriteInteger(int64_t value);
+
+  OutputBuffer &operator<<(char c);
+  OutputBuffer &operator<<(const char *s);
+  OutputBuffer &operator<<(const std::string &s);
+  OutputBuffer &operator<<(int value);
+  OutputBuffer &operator<<(long value);
+  OutputBuffer &operator<<(unsigned long value);
+  // Same as the default floating-point format of a stream (%g).
+  OutputBuffer &operator<<(double value);
+  OutputBuffer &operator<<(const Fixed &fixed);
+  OutputBuffer &operator<<(const Left &left);
+  OutputBuffer &operator<<(const Right &right);
+  OutputBuffer &operator<<(const JsonEscaped &escaped);
+
+ private:
+  void WriteSlow(const char *data, std::size_t size);
+
+  // Writes a formatted field, padding it to the current width.
+  void WriteField(const char *data, std::size_t size);
+
+ private:
+  std::ostream *stream_;
+  std::vector<char> buffer_;
+  char *pos_;
+  char *end_;
+  int width_;
+  bool left_;
+  char fill_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(OutputBuffer);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_OUTPUT_BUFFER_H
@@ -22,7 +22,10 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <vector>
 #include "amx_utils.h"
 #include "function.h"
 #include "function_call.h"
@@ -31,11 +34,29 @@
 
 namespace amxprof {
 
+namespace {
+
+// How many normal functions missed by DiscoverFunctions() are remembered
+// until the next call to it. The hooks run while the script is executing
+// and must not allocate, so the list has a fixed capacity.
+const std::size_t kMaxMissedFunctions = 64;
+
+} // anonymous namespace
+
 Profiler::Profiler(AMX *amx, bool enable_call_graph)
  : amx_(amx),
    debug_info_(0),
-   call_graph_enabled_(enable_call_graph)
+   call_graph_enabled_(enable_call_graph),
+   histogram_mode_(HISTOGRAMS_NONE),
+   code_scanned_(false),
+   has_missed_functions_(false),
+   num_indexed_functions_(0),
+   call_context_tree_(0),
+   line_stats_(0),
+   trace_recorder_(0),
+   stats_(amx)
 {
+  missed_functions_.reserve(kMaxMissedFunctions);
 }
 
 Profiler::~Profiler() {
@@ -45,6 +66,97 @@ Profiler::~Profiler() {
   }
 }
 
+namespace {
+
+class CallTargetCollector : public InstructionVisitor {
+ public:
+  CallTargetCollector(AMX *amx, std::vector<Address> &targets)
+   : amx_(amx),
+     code_size_(GetCodeSize(amx)),
+     targets_(targets)
+  {
+  }
+
+  virtual bool Visit(Address /*address*/,
+                     cell opcode,
+                     const cell *operands,
+                     int /*num_operands*/) {
+    if (opcode == OP_CALL) {
+      Address target = GetCodeOffset(amx_, operands[0]);
+      if (target > 0 && target < code_size_) {
+        targets_.push_back(target);
+      }
+    }
+    return true;
+  }
+
+ private:
+  AMX *amx_;
+  cell code_size_;
+  std::vector<Address> &targets_;
+};
+
+} // anonymous namespace
+
+void Profiler::DiscoverFunctions() {
+  PublicTableIndex num_publics = 0;
+  amx_NumPublics(amx_, &num_publics);
+
+  Address main_address = GetPublicAddress(amx_, AMX_EXEC_MAIN);
+  if (main_address > 0 && stats_.GetFunctionStatistics(main_address) == 0) {
+    AddPublicFunction(AMX_EXEC_MAIN);
+  }
+  for (PublicTableIndex index = 0; index < num_publics; index++) {
+    if (stats_.GetFunctionStatistics(GetPublicAddress(amx_, index)) == 0) {
+      AddPublicFunction(index);
+    }
+  }
+
+  NativeTableIndex num_natives = 0;
+  amx_NumNatives(amx_, &num_natives);
+
+  for (NativeTableIndex index = 0; index < num_natives; index++) {
+    if (stats_.GetNativeStatistics(index) == 0
+        && GetNativeAddress(amx_, index) != 0) {
+      AddNativeFunction(index);
+    }
+  }
+
+  if (!code_scanned_) {
+    std::vector<Address> targets;
+    CallTargetCollector collector(amx_, targets);
+    ScanCode(amx_, &collector);
+
+    for (std::vector<Address>::const_iterator iterator = targets.begin();
+         iterator != targets.end(); ++iterator) {
+      if (stats_.GetFunctionStatistics(*iterator) == 0) {
+        AddNormalFunction(*iterator);
+      }
+    }
+    code_scanned_ = true;
+  }
+
+  for (std::vector<Address>::const_iterator iterator =
+         missed_functions_.begin();
+       iterator != missed_functions_.end(); ++iterator) {
+    if (stats_.GetFunctionStatistics(*iterator) == 0) {
+      AddNormalFunction(*iterator);
+    }
+  }
+  missed_functions_.clear();
+  has_missed_functions_ = false;
+
+  if (call_graph_enabled_) {
+    call_graph_.AddNodes(&stats_);
+  }
+}
+
+void Profiler::ReserveCallGraph() {
+  if (call_graph_enabled_) {
+    call_graph_.Reserve();
+  }
+}
+
 int Profiler::DebugHook(AMX_DEBUG debug) {
   Address prev_frame = call_stack_.is_empty()
     ? amx_->stp
@@ -54,13 +166,12 @@ int Profiler::DebugHook(AMX_DEBUG debug) {
     if (prev_frame != amx_->frm) {
       Address address = GetCalleeAddress(amx_, amx_->frm);
       if (address != 0) {
-        Function *fn = stats_.GetFunction(address);
-        if (fn == 0) {
-          fn = Function::Normal(address, debug_info_);
-          functions_.insert(fn);
-          stats_.AddFunction(fn);
+        FunctionStatistics *fn_stats = stats_.GetFunctionStatistics(address);
+        if (fn_stats != 0) {
+          EnterFunction(fn_stats, amx_->frm);
+        } else {
+          AddMissedFunction(address);
         }
-        EnterFunction(address, amx_->frm);
       }
     }
   } else if (amx_->frm > prev_frame) {
@@ -69,6 +180,10 @@ int Profiler::DebugHook(AMX_DEBUG debug) {
     }
   }
 
+  if (line_stats_ != 0) {
+    line_stats_->Hit(amx_->cip);
+  }
+
   if (debug != 0) {
     return debug(amx_);
   }
@@ -82,19 +197,21 @@ int Profiler::CallbackHook(cell index, cell *result, cell *params, AMX_CALLBACK
   }
 
   if (index >= 0) {
-    Address address = GetNativeAddress(amx_, index);
-    if (address != 0) {
-      Function *fn = stats_.GetFunction(address);
-      if (fn == 0) {
-        fn = Function::Native(amx_, index);
-        functions_.insert(fn);
-        stats_.AddFunction(fn);
-      }
-      EnterFunction(address, amx_->frm);
+    FunctionStatistics *fn_stats = stats_.GetNativeStatistics(index);
+    if (fn_stats == 0 && GetNativeAddress(amx_, index) != 0) {
+      has_missed_functions_ = true;
+    }
+    if (fn_stats != 0) {
+      EnterFunction(fn_stats, amx_->frm);
     }
+    // Time spent in natives is not part of the calling line's self time.
+    Address line = line_stats_ != 0 ? line_stats_->Suspend() : -1;
     int error = callback(amx_, index, result, params);
-    if (address != 0) {
-      LeaveFunction(address, 0);
+    if (line_stats_ != 0) {
+      line_stats_->Resume(line);
+    }
+    if (fn_stats != 0) {
+      LeaveFunction(fn_stats);
     }
     return error;
   }
@@ -108,19 +225,25 @@ int Profiler::ExecHook(cell *retval, int index, AMX_EXEC exec) {
   }
 
   if (index >= 0 || index == AMX_EXEC_MAIN) {
+    FunctionStatistics *fn_stats = 0;
     Address address = GetPublicAddress(amx_, index);
     if (address != 0) {
-      Function *fn = stats_.GetFunction(address);
-      if (fn == 0) {
-        fn = Function::Public(amx_, index);
-        functions_.insert(fn);
-        stats_.AddFunction(fn);
+      fn_stats = stats_.GetFunctionStatistics(address);
+      if (fn_stats != 0) {
+        EnterFunction(fn_stats, amx_->stk - 3 * sizeof(cell));
+      } else {
+        has_missed_functions_ = true;
       }
-      EnterFunction(address, amx_->stk - 3 * sizeof(cell));
     }
+    // A public may be called from a native while another line is being
+    // timed; that line continues once the public returns.
+    Address line = line_stats_ != 0 ? line_stats_->Suspend() : -1;
     int error = exec(amx_, retval, index);
-    if (address != 0) {
-      LeaveFunction(address, 0);
+    if (line_stats_ != 0) {
+      line_stats_->Resume(line);
+    }
+    if (fn_stats != 0) {
+      LeaveFunction(fn_stats);
     }
     return error;
   }
@@ -128,50 +251,179 @@ int Profiler::ExecHook(cell *retval, int index, AMX_EXEC exec) {
   return exec(amx_, retval, index);
 }
 
-void Profiler::EnterFunction(Address address, Address frame) {
-  assert(address != 0);
+void Profiler::AddMissedFunction(Address address) {
+  has_missed_functions_ = true;
+  if (missed_functions_.size() < missed_functions_.capacity()
+      && std::find(missed_functions_.begin(),
+                   missed_functions_.end(),
+                   address) == missed_functions_.end()) {
+    missed_functions_.push_back(address);
+  }
+}
+
+FunctionStatistics *Profiler::AddNormalFunction(Address address) {
+  return AddStatistics(Function::Normal(address, debug_info_));
+}
+
+FunctionStatistics *Profiler::AddPublicFunction(PublicTableIndex index) {
+  return AddStatistics(Function::Public(amx_, index));
+}
+
+FunctionStatistics *Profiler::AddNativeFunction(NativeTableIndex index) {
+  return AddStatistics(Function::Native(amx_, index), index);
+}
+
+FunctionStatistics *Profiler::AddStatistics(Function *fn,
+                                            NativeTableIndex index) {
+  functions_.insert(fn);
+
+  FunctionStatistics *fn_stats;
+  if (fn->type() == Function::NATIVE) {
+    fn_stats = stats_.AddNative(fn, index);
+  } else {
+    fn_stats = stats_.AddFunction(fn);
+  }
+
+  if (histogram_mode_ == HISTOGRAMS_ALL
+      || (histogram_mode_ == HISTOGRAMS_PUBLICS
+          && fn->type() == Function::PUBLIC)) {
+    fn_stats->EnableHistograms();
+  }
+
+  return fn_stats;
+}
+
+namespace {
+
+bool CompareAddress(const FunctionStatistics *lhs,
+                    const FunctionStatistics *rhs) {
+  return lhs->function()->address() < rhs->function()->address();
+}
+
+bool IsBeforeFunction(Address address, const FunctionStatistics *fn_stats) {
+  return address < fn_stats->function()->address();
+}
+
+} // anonymous namespace
+
+FunctionStatistics *Profiler::LookupFunction(Address address) {
+  if (num_indexed_functions_ != stats_.num_functions()) {
+    for (int i = num_indexed_functions_; i < stats_.num_functions(); i++) {
+      FunctionStatistics *fn_stats = stats_.GetFunctionStatisticsByIndex(i);
+      if (fn_stats->function()->type() != Function::NATIVE) {
+        code_functions_.push_back(fn_stats);
+      }
+    }
+    std::sort(code_functions_.begin(), code_functions_.end(), CompareAddress);
+    num_indexed_functions_ = stats_.num_functions();
+  }
 
-  FunctionStatistics *fn_stats = stats_.GetFunctionStatistics(address);
+  std::vector<FunctionStatistics*>::const_iterator iterator =
+    std::upper_bound(code_functions_.begin(),
+                     code_functions_.end(),
+                     address,
+                     IsBeforeFunction);
+  if (iterator == code_functions_.begin()) {
+    return 0;
+  }
+  return *--iterator;
+}
+
+void Profiler::AddSample(const Address *stack,
+                         int depth,
+                         Nanoseconds duration) {
+  sample_stack_.clear();
+  for (int i = 0; i < depth; i++) {
+    FunctionStatistics *fn_stats = LookupFunction(stack[i]);
+    if (fn_stats != 0) {
+      sample_stack_.push_back(fn_stats);
+    }
+  }
+
+  if (sample_stack_.empty()) {
+    return;
+  }
+
+  sample_stack_.front()->AdjustSelfTime(duration);
+
+  for (std::vector<FunctionStatistics*>::iterator iterator =
+         sample_stack_.begin();
+       iterator != sample_stack_.end(); ++iterator) {
+    // Recursive functions appear on the stack more than once but the time
+    // should only be counted once.
+    if (std::find(sample_stack_.begin(), iterator, *iterator) == iterator) {
+      (*iterator)->AdjustTotalTime(duration);
+    }
+  }
+
+  if (call_graph_enabled_) {
+    call_graph_.AddSample(&sample_stack_[0],
+                          static_cast<int>(sample_stack_.size()),
+                          duration);
+  }
+
+  if (call_context_tree_ != 0) {
+    call_context_tree_->AddSample(&sample_stack_[0],
+                                  static_cast<int>(sample_stack_.size()),
+                                  duration);
+  }
+}
+
+void Profiler::EnterFunction(FunctionStatistics *fn_stats, Address frame) {
   assert(fn_stats != 0);
 
   fn_stats->AdjustNumCalls(1);
 
-  call_stack_.Push(fn_stats->function(), frame);
+  call_stack_.Push(fn_stats, frame);
   if (call_graph_enabled_) {
     call_graph_.PushCall(fn_stats);
   }
+  if (call_context_tree_ != 0) {
+    call_context_tree_->PushCall(fn_stats);
+  }
+  if (trace_recorder_ != 0) {
+    trace_recorder_->RecordEnter(fn_stats->index(), frame);
+  }
 }
 
-void Profiler::LeaveFunction(Address address, Address frame) {
+void Profiler::LeaveFunction(FunctionStatistics *fn_stats, Address frame) {
   assert(!call_stack_.is_empty());
-  assert(address == 0 || stats_.GetFunction(address) != 0);
 
   while (!call_stack_.is_empty()) {
-    FunctionCall call = call_stack_.Pop();
+    FunctionCall *call = call_stack_.Pop();
     FunctionCall *next_call = call_stack_.is_empty() ? 0 : call_stack_.top();
 
-    FunctionStatistics *fn_stats =
-      stats_.GetFunctionStatistics(call.function()->address());
-    assert(fn_stats != 0);
+    FunctionStatistics *call_stats = call->stats();
 
-    fn_stats->AdjustSelfTime(call.timer()->self_time());
-    fn_stats->AdjustTotalTime(call.timer()->total_time());
+    call_stats->AdjustSelfTime(call->timer()->self_time());
+    call_stats->AdjustTotalTime(call->timer()->total_time());
 
-    Nanoseconds total_time = call.timer()->latest_total_time();
-    if (total_time > fn_stats->worst_total_time()) {
-      fn_stats->set_worst_total_time(total_time);
+    Nanoseconds total_time = call->timer()->latest_total_time();
+    if (total_time > call_stats->worst_total_time()) {
+      call_stats->set_worst_total_time(total_time);
     }
 
-    Nanoseconds self_time = call.timer()->latest_self_time();
-    if (self_time > fn_stats->worst_self_time()) {
-      fn_stats->set_worst_self_time(self_time);
+    Nanoseconds self_time = call->timer()->latest_self_time();
+    if (self_time > call_stats->worst_self_time()) {
+      call_stats->set_worst_self_time(self_time);
     }
 
+    // Unlike the latest times, these are not zeroed for inner calls of
+    // a recursive function, and every call belongs in the histograms.
+    call_stats->RecordCall(call->timer()->self_time(),
+                           call->timer()->total_time());
+
     if (call_graph_enabled_) {
-      call_graph_.PopCall();
+      call_graph_.PopCall(call->timer()->total_time());
+    }
+    if (call_context_tree_ != 0) {
+      call_context_tree_->PopCall(call->timer()->total_time());
+    }
+    if (trace_recorder_ != 0) {
+      trace_recorder_->RecordLeave(call_stats->index(), call->frame());
     }
 
-    if (call.function()->address() == address
+    if (call_stats == fn_stats
         || (frame != 0 && next_call != 0 && next_call->frame() >= frame)) {
       break;
     }
@@ -26,18 +26,30 @@
 #define AMXPROF_PROFILER_H
 
 #include <set>
+#include <vector>
 #include "amx_types.h"
+#include "call_context_tree.h"
 #include "call_graph.h"
 #include "call_stack.h"
 #include "debug_info.h"
 #include "function_statistics.h"
+#include "line_statistics.h"
 #include "macros.h"
 #include "statistics.h"
+#include "trace_recorder.h"
 
 namespace amxprof {
 
 class Profiler {
  public:
+  // Which functions get latency histograms (see LatencyHistogram).
+  // Each function with histograms costs about 9 KB of memory.
+  enum HistogramMode {
+    HISTOGRAMS_NONE,
+    HISTOGRAMS_PUBLICS,
+    HISTOGRAMS_ALL
+  };
+
   Profiler(AMX *amx, bool enable_call_graph = false);
   ~Profiler();
 
@@ -47,6 +59,32 @@ class Profiler {
   const CallStack *call_stack() const { return &call_stack_; }
   const CallGraph *call_graph() const { return &call_graph_; }
 
+  // If set, the profiler records each call in the calling-context tree
+  // as well. The caller retains ownership of the tree.
+  const CallContextTree *call_context_tree() const {
+    return call_context_tree_;
+  }
+  void set_call_context_tree(CallContextTree *tree) {
+    call_context_tree_ = tree;
+  }
+
+  // If set, the profiler records hits and self time of each line seen by
+  // the debug hook. The caller retains ownership of the statistics.
+  const LineStatistics *line_statistics() const { return line_stats_; }
+  void set_line_statistics(LineStatistics *line_stats) {
+    line_stats_ = line_stats;
+  }
+
+  // If set, the profiler records function entries and exits to the trace.
+  // The caller retains ownership of the recorder.
+  void set_trace_recorder(TraceRecorder *recorder) {
+    trace_recorder_ = recorder;
+  }
+
+  // Must be set before any functions are discovered.
+  HistogramMode histogram_mode() const { return histogram_mode_; }
+  void set_histogram_mode(HistogramMode mode) { histogram_mode_ = mode; }
+
   // Debug info is needed for function names. If not set the functions
   // will be shown as "unknown@XXXXXXXX" where XXXXXXXX is the AMX code
   // offset (except for public functions, whose names are duplicated
@@ -55,6 +93,25 @@ class Profiler {
     debug_info_ = debug_info;
   }
 
+  // Creates statistics for all public and native functions and for all
+  // functions called via OP_CALL so that this doesn't have to be done
+  // while the script is running. Natives that aren't registered yet are
+  // skipped, so it may be called again once they are. Must be called
+  // after set_debug_info() to pick up function names.
+  void DiscoverFunctions();
+
+  // Returns true if the hooks ran into functions that DiscoverFunctions()
+  // didn't know about, such as natives registered after it was called.
+  // The hooks can't add them without allocating memory, so calls to such
+  // functions are not counted (their time goes to the caller) until
+  // DiscoverFunctions() is called again.
+  bool has_missed_functions() const { return has_missed_functions_; }
+
+  // Makes room for new edges in the call graph, which the hooks can't do
+  // themselves. Like DiscoverFunctions(), this should be called between
+  // top-level calls into the script.
+  void ReserveCallGraph();
+
  public:
   // This method should be called from within your AMX debug hook (see
   // amx_SetDebugHook). It collects statistics for ordinary functions.
@@ -71,22 +128,48 @@ class Profiler {
   // It collects statistics for public functions.
   int ExecHook(cell *retval, int index, AMX_EXEC exec = 0);
 
+  // Accounts a stack sample (see Sampler) that represents the given
+  // amount of time. The innermost function gets it added to its self
+  // time and all functions on the stack to their total time.
+  void AddSample(const Address *stack, int depth, Nanoseconds duration);
+
  private:
   Profiler();
 
+  // Remembers a normal function for the next DiscoverFunctions().
+  void AddMissedFunction(Address address);
+
+  FunctionStatistics *AddNormalFunction(Address address);
+  FunctionStatistics *AddPublicFunction(PublicTableIndex index);
+  FunctionStatistics *AddNativeFunction(NativeTableIndex index);
+  FunctionStatistics *AddStatistics(Function *fn, NativeTableIndex index = -1);
+
+  // Finds the normal or public function containing the specified address.
+  FunctionStatistics *LookupFunction(Address address);
+
   // BeginFunction() and EndFunction() are called when entering
   // a function and returning from it respectively.
-  void EnterFunction(Address address, Address frm);
-  void LeaveFunction(Address address, Address frm);
+  void EnterFunction(FunctionStatistics *fn_stats, Address frame);
+  void LeaveFunction(FunctionStatistics *fn_stats, Address frame = 0);
 
  private:
   AMX *amx_;
   DebugInfo *debug_info_;
   bool call_graph_enabled_;
+  HistogramMode histogram_mode_;
+  bool code_scanned_;
+  bool has_missed_functions_;
+  int num_indexed_functions_;
   CallStack call_stack_;
   CallGraph call_graph_;
+  CallContextTree *call_context_tree_;
+  LineStatistics *line_stats_;
+  TraceRecorder *trace_recorder_;
   Statistics stats_;
   std::set<Function*> functions_;
+  std::vector<Address> missed_functions_;
+  std::vector<FunctionStatistics*> code_functions_;
+  std::vector<FunctionStatistics*> sample_stack_;
 
  private:
   AMXPROF_DISALLOW_COPY_AND_ASSIGN(Profiler);
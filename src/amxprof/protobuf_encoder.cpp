@@ -0,0 +1,71 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "protobuf_encoder.h"
+
+namespace amxprof {
+
+void ProtobufEncoder::WriteUInt64(int field, uint64_t value) {
+  WriteTag(field, WIRE_TYPE_VARINT);
+  WriteVarint(value);
+}
+
+void ProtobufEncoder::WriteInt64(int field, int64_t value) {
+  WriteTag(field, WIRE_TYPE_VARINT);
+  WriteVarint(static_cast<uint64_t>(value));
+}
+
+void ProtobufEncoder::WriteString(int field, const std::string &value) {
+  WriteTag(field, WIRE_TYPE_LENGTH_DELIMITED);
+  WriteVarint(value.length());
+  data_.append(value);
+}
+
+void ProtobufEncoder::WriteMessage(int field, const ProtobufEncoder &message) {
+  WriteString(field, message.data_);
+}
+
+void ProtobufEncoder::WritePackedUInt64(int field,
+                                        const std::vector<uint64_t> &values) {
+  ProtobufEncoder packed;
+  for (std::vector<uint64_t>::const_iterator iterator = values.begin();
+       iterator != values.end(); ++iterator) {
+    packed.WriteVarint(*iterator);
+  }
+  WriteString(field, packed.data_);
+}
+
+void ProtobufEncoder::WriteTag(int field, WireType type) {
+  WriteVarint((static_cast<uint64_t>(field) << 3) | type);
+}
+
+void ProtobufEncoder::WriteVarint(uint64_t value) {
+  while (value >= 0x80) {
+    data_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  data_.push_back(static_cast<char>(value));
+}
+
+} // namespace amxprof
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_PROTOBUF_ENCODER_H
+#define AMXPROF_PROTOBUF_ENCODER_H
+
+#include <string>
+#include <vector>
+#include "stdint.h"
+
+namespace amxprof {
+
+// A minimal encoder for the protobuf wire format. Messages are built in
+// memory; nested messages are encoded separately and then added with
+// WriteMessage().
+class ProtobufEncoder {
+ public:
+  const std::string &data() const { return data_; }
+  void Clear() { data_.clear(); }
+
+  // Signed values are encoded as int64 (not sint64), i.e. negative values
+  // take ten bytes.
+  void WriteUInt64(int field, uint64_t value);
+  void WriteInt64(int field, int64_t value);
+  void WriteString(int field, const std::string &value);
+  void WriteMessage(int field, const ProtobufEncoder &message);
+  void WritePackedUInt64(int field, const std::vector<uint64_t> &values);
+
+ private:
+  enum WireType {
+    WIRE_TYPE_VARINT = 0,
+    WIRE_TYPE_LENGTH_DELIMITED = 2
+  };
+
+  void WriteTag(int field, WireType type);
+  void WriteVarint(uint64_t value);
+
+ private:
+  std::string data_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_PROTOBUF_ENCODER_H
@@ -0,0 +1,188 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include "amx_utils.h"
+#include "sampler.h"
+
+namespace amxprof {
+
+Sampler *volatile Sampler::current_ = 0;
+Microseconds Sampler::interval_;
+int Sampler::num_started_ = 0;
+
+Sampler::Sampler(AMX *amx, std::size_t buffer_size)
+ : amx_(amx),
+   started_(false),
+   read_pos_(0),
+   write_pos_(0),
+   num_dropped_samples_(0),
+   exec_depth_(0),
+   exec_address_(0),
+   exec_cip_(0),
+   exec_frm_(0)
+{
+  // Round the size up to a power of two so that positions can be wrapped
+  // around with a simple mask.
+  std::size_t size = 1;
+  while (size < buffer_size) {
+    size <<= 1;
+  }
+  buffer_.resize(size);
+  buffer_mask_ = size - 1;
+}
+
+Sampler::~Sampler() {
+  Stop();
+  if (current_ == this) {
+    current_ = 0;
+  }
+}
+
+void Sampler::Start() {
+  if (started_) {
+    return;
+  }
+  if (num_started_ == 0) {
+    StartTimer();
+  }
+  num_started_++;
+  started_ = true;
+}
+
+void Sampler::Stop() {
+  if (!started_) {
+    return;
+  }
+  started_ = false;
+  if (--num_started_ == 0) {
+    StopTimer();
+  }
+}
+
+int Sampler::ExecHook(cell *retval, int index, AMX_EXEC exec) {
+  if (exec == 0) {
+    exec = ::amx_Exec;
+  }
+
+  Sampler *prev_current = current_;
+  Address prev_address = exec_address_;
+  cell prev_cip = exec_cip_;
+  cell prev_frm = exec_frm_;
+
+  exec_address_ = GetPublicAddress(amx_, index);
+  exec_cip_ = amx_->cip;
+  exec_frm_ = amx_->frm;
+  exec_depth_++;
+
+  // Make sure the signal handler sees the new state before it starts
+  // sampling this script.
+  MemoryFence();
+  current_ = this;
+
+  int error = exec(amx_, retval, index);
+
+  current_ = prev_current;
+  MemoryFence();
+
+  exec_depth_--;
+  exec_address_ = prev_address;
+  exec_cip_ = prev_cip;
+  exec_frm_ = prev_frm;
+
+  return error;
+}
+
+void Sampler::ReadSamples(Visitor *visitor) {
+  std::size_t write_pos = write_pos_;
+  MemoryFence();
+
+  Address stack[kMaxDepth];
+  std::size_t read_pos = read_pos_;
+
+  while (read_pos != write_pos) {
+    int depth = buffer_[read_pos++ & buffer_mask_];
+    for (int i = 0; i < depth; i++) {
+      stack[i] = buffer_[read_pos++ & buffer_mask_];
+    }
+    visitor->Visit(stack, depth);
+  }
+
+  MemoryFence();
+  read_pos_ = read_pos;
+}
+
+// Called from the signal handler.
+void Sampler::TakeSample() {
+  Address stack[kMaxDepth];
+  int depth = 0;
+
+  if (amx_->cip == exec_cip_ && amx_->frm == exec_frm_) {
+    // The VM hasn't stored its registers since the public function was
+    // called, so the best we can do is to attribute this sample to it.
+    if (exec_address_ != 0) {
+      stack[depth++] = exec_address_;
+    }
+  } else {
+    stack[depth++] = amx_->cip;
+
+    Address frame = amx_->frm;
+    while (depth < kMaxDepth) {
+      Address return_address = GetReturnAddress(amx_, frame);
+      if (return_address <= 0) {
+        break;
+      }
+      stack[depth++] = return_address;
+
+      Address caller_frame = GetCallerFrame(amx_, frame);
+      if (caller_frame <= frame) {
+        break;
+      }
+      frame = caller_frame;
+    }
+  }
+
+  if (depth > 0) {
+    WriteSample(stack, depth);
+  }
+}
+
+// Called from the signal handler.
+void Sampler::WriteSample(const Address *stack, int depth) {
+  std::size_t write_pos = write_pos_;
+  std::size_t used = write_pos - read_pos_;
+
+  if (buffer_.size() - used < static_cast<std::size_t>(depth) + 1) {
+    num_dropped_samples_++;
+    return;
+  }
+
+  buffer_[write_pos++ & buffer_mask_] = depth;
+  for (int i = 0; i < depth; i++) {
+    buffer_[write_pos++ & buffer_mask_] = stack[i];
+  }
+
+  MemoryFence();
+  write_pos_ = write_pos;
+}
+
+} // namespace amxprof
@@ -0,0 +1,130 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef AMXPROF_SAMPLER_H
+#define AMXPROF_SAMPLER_H
+
+#include <cstddef>
+#include <vector>
+#include "amx_types.h"
+#include "duration.h"
+#include "macros.h"
+
+namespace amxprof {
+
+// Sampler records call stacks of a running script at regular intervals
+// without hooking into the script itself. Samples are taken by a timer
+// that sends SIGPROF to the thread that started it (the server thread)
+// and are stored in a lock-free buffer that is drained with ReadSamples().
+// The timer only runs while at least one sampler is started, and samplers
+// must be started and run on the same thread.
+//
+// Note that the AMX only stores the current instruction and frame pointers
+// into the AMX structure on certain events, such as native function calls,
+// so a sample reflects the state of the script at the most recent of these
+// events.
+class Sampler {
+ public:
+  // Maximum number of addresses recorded per sample.
+  static const int kMaxDepth = 64;
+
+  class Visitor {
+   public:
+    virtual ~Visitor() {}
+
+    // Called for each sample. The first address is the instruction pointer,
+    // the others are return addresses, innermost first.
+    virtual void Visit(const Address *stack, int depth) = 0;
+  };
+
+  // The buffer size is in cells. Each sample takes one cell plus one cell
+  // per address.
+  Sampler(AMX *amx, std::size_t buffer_size);
+  ~Sampler();
+
+  // Returns false if sampling is not supported on this system.
+  static bool IsSupported();
+
+  // Sets the time between samples. This should be done before any
+  // samplers are started.
+  static void set_interval(Microseconds interval) { interval_ = interval; }
+  static Microseconds interval() { return interval_; }
+
+  // Starts or stops sampling of this script. The first started sampler
+  // arms the interval timer, and the last stopped one disarms it.
+  void Start();
+  void Stop();
+
+  bool is_started() const { return started_; }
+
+  // This method should be called instead of amx_Exec(). Samples are only
+  // taken while the script is running inside of it.
+  int ExecHook(cell *retval, int index, AMX_EXEC exec = 0);
+
+  bool is_executing() const { return exec_depth_ > 0; }
+
+  // Passes samples collected so far to the visitor and removes them from
+  // the buffer.
+  void ReadSamples(Visitor *visitor);
+
+  // Returns the number of samples that were lost because the buffer was
+  // full.
+  long num_dropped_samples() const { return num_dropped_samples_; }
+
+ private:
+  static void StartTimer();
+  static void StopTimer();
+  static void HandleSignal(int signal);
+  static void MemoryFence();
+
+  void TakeSample();
+  void WriteSample(const Address *stack, int depth);
+
+ private:
+  AMX *amx_;
+  bool started_;
+
+  std::vector<cell> buffer_;
+  std::size_t buffer_mask_;
+  volatile std::size_t read_pos_;
+  volatile std::size_t write_pos_;
+  volatile long num_dropped_samples_;
+
+  // The state of the AMX at the time the current public function was
+  // entered, used to detect that nothing has been stored since then.
+  int exec_depth_;
+  Address exec_address_;
+  cell exec_cip_;
+  cell exec_frm_;
+
+  static Sampler *volatile current_;
+  static Microseconds interval_;
+  static int num_started_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(Sampler);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_SAMPLER_H
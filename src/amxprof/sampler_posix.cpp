@@ -0,0 +1,122 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "sampler.h"
+#include "system_error.h"
+
+// Older versions of glibc don't define this.
+#ifndef sigev_notify_thread_id
+  #define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace amxprof {
+
+namespace {
+
+timer_t timer;
+
+// The thread that started the timer (the server thread). The signal is
+// directed to it, but SIGPROF may still come from elsewhere, e.g. from
+// a timer set by another plugin.
+volatile pid_t timer_thread_id = 0;
+
+pid_t GetThreadId() {
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+} // anonymous namespace
+
+// static
+bool Sampler::IsSupported() {
+  return true;
+}
+
+// static
+void Sampler::StartTimer() {
+  long usec = static_cast<long>(interval_.count());
+
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = HandleSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+
+  timer_thread_id = GetThreadId();
+  if (sigaction(SIGPROF, &action, 0) == -1) {
+    throw SystemError("sigaction");
+  }
+
+  // Unlike setitimer(ITIMER_PROF), which signals the whole process and
+  // lets any thread that doesn't block SIGPROF (including the threads of
+  // other plugins) run the handler, this timer counts the CPU time of the
+  // server thread and delivers the signal only to it.
+  struct sigevent event;
+  std::memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = timer_thread_id;
+
+  if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) == -1) {
+    throw SystemError("timer_create");
+  }
+
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = usec / 1000000;
+  spec.it_interval.tv_nsec = (usec % 1000000) * 1000;
+  spec.it_value = spec.it_interval;
+
+  if (timer_settime(timer, 0, &spec, 0) == -1) {
+    timer_delete(timer);
+    throw SystemError("timer_settime");
+  }
+}
+
+// static
+void Sampler::StopTimer() {
+  timer_delete(timer);
+  signal(SIGPROF, SIG_IGN);
+}
+
+// static
+void Sampler::HandleSignal(int) {
+  int saved_errno = errno;
+
+  Sampler *sampler = current_;
+  if (sampler != 0 && GetThreadId() == timer_thread_id) {
+    sampler->TakeSample();
+  }
+
+  errno = saved_errno;
+}
+// static
+void Sampler::MemoryFence() {
+  __sync_synchronize();
+}
+
+} // namespace amxprof
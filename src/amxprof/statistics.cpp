@@ -22,50 +22,140 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include "amx_utils.h"
 #include "function.h"
 #include "function_statistics.h"
 #include "statistics.h"
 
 namespace amxprof {
 
-Statistics::Statistics() {
+namespace {
+
+bool CompareAddress(const FunctionStatistics *lhs,
+                    const FunctionStatistics *rhs) {
+  return lhs->function()->address() < rhs->function()->address();
+}
+
+} // anonymous namespace
+
+Statistics::Statistics()
+ : is_snapshot_(true)
+{
+}
+
+Statistics::Statistics(AMX *amx)
+ : is_snapshot_(false),
+   code_table_(GetCodeSize(amx) / sizeof(cell))
+{
+  int num_natives = 0;
+  amx_NumNatives(amx, &num_natives);
+  native_table_.resize(num_natives);
   run_time_counter_.Start();
 }
 
 Statistics::~Statistics() {
-  for (AddressToFuncStatsMap::const_iterator iterator = address_to_fn_stats_.begin();
-       iterator != address_to_fn_stats_.end(); ++iterator)
+  for (std::vector<FunctionStatistics*>::const_iterator iterator = fn_stats_.begin();
+       iterator != fn_stats_.end(); ++iterator)
   {
-    delete iterator->second;
+    delete *iterator;
+  }
+}
+
+Statistics *Statistics::Snapshot() const {
+  Statistics *copy = new Statistics;
+  copy->snapshot_run_time_ = GetTotalRunTime();
+  copy->fn_stats_.reserve(fn_stats_.size());
+  for (std::vector<FunctionStatistics*>::const_iterator iterator = fn_stats_.begin();
+       iterator != fn_stats_.end(); ++iterator) {
+    copy->fn_stats_.push_back((*iterator)->Snapshot());
+  }
+  return copy;
+}
+
+void Statistics::Subtract(const Statistics *base) {
+  snapshot_run_time_ -= base->GetTotalRunTime();
+  std::size_t num_common = std::min(fn_stats_.size(), base->fn_stats_.size());
+  for (std::size_t i = 0; i < num_common; i++) {
+    fn_stats_[i]->Subtract(base->fn_stats_[i]);
   }
 }
 
 Function *Statistics::GetFunction(Address address) {
-  AddressToFuncStatsMap::const_iterator iterator = address_to_fn_stats_.find(address);
-  if (iterator != address_to_fn_stats_.end()) {
-    return iterator->second->function();
+  FunctionStatistics *fn_stats = GetFunctionStatistics(address);
+  if (fn_stats != 0) {
+    return fn_stats->function();
   }
   return 0;
 }
 
-void Statistics::AddFunction(Function *fn) {
-  FunctionStatistics *fn_stats = new FunctionStatistics(fn);
-  address_to_fn_stats_.insert(std::make_pair(fn->address(), fn_stats));
+FunctionStatistics *Statistics::AddFunction(Function *fn) {
+  FunctionStatistics *fn_stats =
+    new FunctionStatistics(fn, static_cast<int>(fn_stats_.size()));
+  fn_stats_.push_back(fn_stats);
+
+  Address address = fn->address();
+  if (address >= 0 && address % sizeof(cell) == 0) {
+    std::size_t index = address / sizeof(cell);
+    if (index < code_table_.size()) {
+      code_table_[index] = fn_stats;
+    }
+  }
+
+  return fn_stats;
+}
+
+FunctionStatistics *Statistics::AddNative(Function *fn,
+                                          NativeTableIndex index) {
+  FunctionStatistics *fn_stats =
+    new FunctionStatistics(fn, static_cast<int>(fn_stats_.size()));
+  fn_stats_.push_back(fn_stats);
+
+  if (index >= 0 && static_cast<std::size_t>(index) < native_table_.size()) {
+    native_table_[index] = fn_stats;
+  }
+
+  return fn_stats;
 }
 
 FunctionStatistics *Statistics::GetFunctionStatistics(Address address) const {
-  AddressToFuncStatsMap::const_iterator iterator = address_to_fn_stats_.find(address);
-  if (iterator != address_to_fn_stats_.end()) {
-    return iterator->second;
+  if (address >= 0 && address % sizeof(cell) == 0) {
+    std::size_t index = address / sizeof(cell);
+    if (index < code_table_.size()) {
+      return code_table_[index];
+    }
+  }
+
+  // Native functions live outside of the AMX, so their addresses can't
+  // be looked up in the code table.
+  for (std::vector<FunctionStatistics*>::const_iterator iterator = native_table_.begin();
+       iterator != native_table_.end(); ++iterator) {
+    if (*iterator != 0 && (*iterator)->function()->address() == address) {
+      return *iterator;
+    }
+  }
+
+  return 0;
+}
+
+FunctionStatistics *Statistics::GetNativeStatistics(
+    NativeTableIndex index) const {
+  if (index >= 0 && static_cast<std::size_t>(index) < native_table_.size()) {
+    return native_table_[index];
   }
   return 0;
 }
 
 void Statistics::GetStatistics(std::vector<FunctionStatistics*> &stats) const {
-  for (AddressToFuncStatsMap::const_iterator iterator = address_to_fn_stats_.begin();
-       iterator != address_to_fn_stats_.end(); ++iterator) {
-    stats.push_back(iterator->second);
+  std::vector<FunctionStatistics*>::size_type first = stats.size();
+  for (std::vector<FunctionStatistics*>::const_iterator iterator = fn_stats_.begin();
+       iterator != fn_stats_.end(); ++iterator) {
+    if ((*iterator)->num_calls() > 0
+        || (*iterator)->total_time().count() > 0) {
+      stats.push_back(*iterator);
+    }
   }
+  std::stable_sort(stats.begin() + first, stats.end(), CompareAddress);
 }
 
 } // namespace amxprof
@@ -25,7 +25,6 @@
 #ifndef AMXPROF_STATISTICS_H
 #define AMXPROF_STATISTICS_H
 
-#include <map>
 #include <vector>
 #include "amx_types.h"
 #include "duration.h"
@@ -38,24 +37,66 @@ class FunctionStatistics;
 
 class Statistics {
  public:
-  typedef std::map<Address, FunctionStatistics*> AddressToFuncStatsMap;
-
-  Statistics();
+  explicit Statistics(AMX *amx);
   ~Statistics();
 
-  void AddFunction(Function *fn);
+  // Returns a copy of the statistics of all functions with the run time
+  // frozen at the current time. Function indexes are preserved, but the
+  // copy doesn't support lookups by address or native index. Calls that
+  // haven't returned yet are not included.
+  Statistics *Snapshot() const;
+
+  // Turns a snapshot into the difference between it and an earlier
+  // snapshot of the same statistics, e.g. to get the counts and times of
+  // a single dump interval. Functions added after the earlier snapshot
+  // are left as is.
+  void Subtract(const Statistics *base);
+
+  // Adds a normal or public function. Such functions are looked up by
+  // their address in the code section.
+  FunctionStatistics *AddFunction(Function *fn);
+
+  // Adds a native function. Natives are looked up by their index in the
+  // native table because their addresses don't point into the AMX.
+  FunctionStatistics *AddNative(Function *fn, NativeTableIndex index);
+
   Function *GetFunction(Address address);
 
   FunctionStatistics *GetFunctionStatistics(Address address) const;
+  FunctionStatistics *GetNativeStatistics(NativeTableIndex index) const;
+
+  // Appends statistics of all functions that have been called or sampled
+  // at least once, ordered by address.
   void GetStatistics(std::vector<FunctionStatistics*> &stats) const;
 
+  // Returns the number of functions added so far. Function indexes are
+  // in the range [0, num_functions()).
+  int num_functions() const { return static_cast<int>(fn_stats_.size()); }
+
+  FunctionStatistics *GetFunctionStatisticsByIndex(int index) const {
+    return fn_stats_[index];
+  }
+
   Nanoseconds GetTotalRunTime() const {
+    if (is_snapshot_) {
+      return snapshot_run_time_;
+    }
     return run_time_counter_.QueryTotalTime();
   }
 
+ private:
+  Statistics();
+
  private:
   PerformanceCounter run_time_counter_;
-  AddressToFuncStatsMap address_to_fn_stats_;
+  bool is_snapshot_;
+  Nanoseconds snapshot_run_time_;
+  std::vector<FunctionStatistics*> fn_stats_;
+
+  // Flat lookup tables built from the AMX header: one slot per code cell
+  // (indexed by address / sizeof(cell)) and one per native table entry.
+  std::vector<FunctionStatistics*> code_table_;
+  std::vector<FunctionStatistics*> native_table_;
 };
 
 } // namespace amxprof
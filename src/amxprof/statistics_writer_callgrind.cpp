@@ -0,0 +1,227 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <vector>
+#include "call_graph.h"
+#include "debug_info.h"
+#include "duration.h"
+#include "function.h"
+#include "function_statistics.h"
+#include "line_statistics.h"
+#include "output_buffer.h"
+#include "statistics.h"
+#include "statistics_writer_callgrind.h"
+
+namespace amxprof {
+
+namespace {
+
+// Callgrind's name for an unknown file.
+const char kUnknownFile[] = "???";
+
+struct Location {
+  std::string file;
+  long line;
+};
+
+Location GetLocation(const DebugInfo *debug_info, const Function *fn) {
+  Location location;
+  location.file = kUnknownFile;
+  location.line = 0;
+
+  // Natives don't live in the AMX, so there's no debug info for them.
+  if (debug_info != 0 && fn->type() != Function::NATIVE) {
+    std::string file = debug_info->LookupFile(fn->address());
+    if (!file.empty()) {
+      location.file = file;
+      // Lines in the debug info are zero-based.
+      location.line = debug_info->LookupLine(fn->address()) + 1;
+    }
+  }
+
+  return location;
+}
+
+} // anonymous namespace
+
+StatisticsWriterCallgrind::StatisticsWriterCallgrind()
+ : call_graph_(0),
+   debug_info_(0),
+   line_stats_(0)
+{
+}
+
+void StatisticsWriterCallgrind::Write(const Statistics *stats) {
+  file_names_.clear();
+  function_names_.clear();
+
+  std::vector<FunctionStatistics*> all_fn_stats;
+  stats->GetStatistics(all_fn_stats);
+
+  // Start addresses of all functions in the code section, used to find
+  // where each function ends.
+  std::vector<Address> fn_addresses;
+  for (int i = 0; i < stats->num_functions(); i++) {
+    const Function *fn = stats->GetFunctionStatisticsByIndex(i)->function();
+    if (fn->type() != Function::NATIVE) {
+      fn_addresses.push_back(fn->address());
+    }
+  }
+  std::sort(fn_addresses.begin(), fn_addresses.end());
+
+  std::vector<Location> locations;
+  std::vector<LineCostMap> self_costs(all_fn_stats.size());
+  Nanoseconds self_time_all;
+
+  for (std::size_t i = 0; i < all_fn_stats.size(); i++) {
+    const FunctionStatistics *fn_stats = all_fn_stats[i];
+    const Function *fn = fn_stats->function();
+    Location location = GetLocation(debug_info_, fn);
+    locations.push_back(location);
+
+    if (line_stats_ != 0
+        && fn->type() != Function::NATIVE
+        && location.file != kUnknownFile) {
+      std::vector<Address>::const_iterator next =
+        std::upper_bound(fn_addresses.begin(),
+                         fn_addresses.end(),
+                         fn->address());
+      Address end = next != fn_addresses.end()
+        ? *next
+        : line_stats_->code_size();
+      GetLineCosts(fn->address(), end, self_costs[i]);
+    }
+    if (self_costs[i].empty()) {
+      self_costs[i][location.line] = fn_stats->self_time();
+    }
+
+    for (LineCostMap::const_iterator iterator = self_costs[i].begin();
+         iterator != self_costs[i].end(); ++iterator) {
+      self_time_all += iterator->second;
+    }
+  }
+
+  // Group call graph edges by caller. Edges from the root (the server)
+  // have no caller function and are left out.
+  std::vector<std::vector<const CallGraphEdge*> > callee_edges(
+    stats->num_functions());
+  if (call_graph_ != 0) {
+    for (int i = 0; i < call_graph_->num_edges(); i++) {
+      const CallGraphEdge &edge = call_graph_->edge(i);
+      const FunctionStatistics *caller = edge.caller()->stats();
+      if (caller != 0) {
+        callee_edges[caller->index()].push_back(&edge);
+      }
+    }
+  }
+
+  OutputBuffer out(stream());
+
+  out
+    << "# callgrind format\n"
+    << "version: 1\n"
+    << "creator: samp-plugin-profiler\n"
+    << "cmd: " << script_name() << "\n"
+    << "positions: line\n"
+    << "event: ns : Time (ns)\n"
+    << "events: ns\n"
+    << "summary: " << Fixed(self_time_all.count(), 0) << "\n";
+
+  for (std::size_t i = 0; i < all_fn_stats.size(); i++) {
+    const FunctionStatistics *fn_stats = all_fn_stats[i];
+    const Function *fn = fn_stats->function();
+    const Location &location = locations[i];
+
+    out << "\nfl=";
+    WriteName(out, file_names_, location.file);
+    out << "\nfn=";
+    WriteName(out, function_names_, fn->name());
+    out << "\n";
+
+    for (LineCostMap::const_iterator iterator = self_costs[i].begin();
+         iterator != self_costs[i].end(); ++iterator) {
+      out << iterator->first << " " << Fixed(iterator->second.count(), 0)
+          << "\n";
+    }
+
+    const std::vector<const CallGraphEdge*> &edges =
+      callee_edges[fn_stats->index()];
+
+    for (std::vector<const CallGraphEdge*>::const_iterator iterator =
+           edges.begin();
+         iterator != edges.end(); ++iterator) {
+      const CallGraphEdge *edge = *iterator;
+      const Function *callee = edge->callee()->stats()->function();
+      Location callee_location = GetLocation(debug_info_, callee);
+
+      if (callee_location.file != location.file) {
+        out << "cfl=";
+        WriteName(out, file_names_, callee_location.file);
+        out << "\n";
+      }
+
+      // Call sites are not recorded, so calls appear to come from the first
+      // line of the caller.
+      out << "cfn=";
+      WriteName(out, function_names_, callee->name());
+      out
+        << "\n"
+        << "calls=" << edge->num_calls() << " " << callee_location.line << "\n"
+        << location.line << " " << Fixed(edge->total_time().count(), 0)
+        << "\n";
+    }
+  }
+}
+
+void StatisticsWriterCallgrind::GetLineCosts(Address start,
+                                             Address end,
+                                             LineCostMap &costs) const {
+  end = std::min(end, line_stats_->code_size());
+  for (Address address = start; address < end; address += sizeof(cell)) {
+    if (line_stats_->num_hits(address) > 0) {
+      // Lines in the debug info are zero-based.
+      long line = debug_info_->LookupLine(address) + 1;
+      costs[line] += line_stats_->self_time(address);
+    }
+  }
+}
+
+// static
+void StatisticsWriterCallgrind::WriteName(OutputBuffer &out,
+                                          NameMap &names,
+                                          const std::string &name) {
+  NameMap::const_iterator iterator = names.find(name);
+  if (iterator != names.end()) {
+    out << '(' << iterator->second << ')';
+    return;
+  }
+
+  int next_id = static_cast<int>(names.size()) + 1;
+  names.insert(std::make_pair(name, next_id));
+
+  out << '(' << next_id << ") " << name;
+}
+
+} // namespace amxprof
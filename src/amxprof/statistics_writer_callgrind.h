@@ -0,0 +1,92 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_STATISTICS_WRITER_CALLGRIND_H
+#define AMXPROF_STATISTICS_WRITER_CALLGRIND_H
+
+#include <map>
+#include <string>
+#include "amx_types.h"
+#include "duration.h"
+#include "statistics_writer.h"
+
+namespace amxprof {
+
+class CallGraph;
+class DebugInfo;
+class LineStatistics;
+class OutputBuffer;
+
+// Writes statistics in the Callgrind format for KCachegrind/QCachegrind.
+// The cost is time in nanoseconds. Self time of a function is attributed
+// to its first line unless line statistics are available, and each call
+// graph edge carries the number of calls and the inclusive time of the
+// callee.
+//
+// Repeated file and function names are written only once and referred
+// to by ID afterwards, as permitted by the format.
+class StatisticsWriterCallgrind : public StatisticsWriter {
+ public:
+  StatisticsWriterCallgrind();
+
+  // Optional, without it there are no call edges.
+  void set_call_graph(const CallGraph *call_graph) {
+    call_graph_ = call_graph;
+  }
+
+  // Optional, used for file names and line numbers.
+  void set_debug_info(const DebugInfo *debug_info) {
+    debug_info_ = debug_info;
+  }
+
+  // Optional, splits self time of functions by line. Requires debug info.
+  void set_line_statistics(const LineStatistics *line_stats) {
+    line_stats_ = line_stats;
+  }
+
+  virtual void Write(const Statistics *stats);
+
+ private:
+  typedef std::map<std::string, int> NameMap;
+  typedef std::map<long, Nanoseconds> LineCostMap;
+
+  // Adds up self time of the lines in [start, end) using line statistics.
+  void GetLineCosts(Address start, Address end, LineCostMap &costs) const;
+
+  // Writes "(id) name" the first time a name is seen and "(id)" after.
+  static void WriteName(OutputBuffer &out,
+                        NameMap &names,
+                        const std::string &name);
+
+ private:
+  const CallGraph *call_graph_;
+  const DebugInfo *debug_info_;
+  const LineStatistics *line_stats_;
+  NameMap file_names_;
+  NameMap function_names_;
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_STATISTICS_WRITER_CALLGRIND_H
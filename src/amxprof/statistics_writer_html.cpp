@@ -22,11 +22,11 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <iomanip>
-#include <iostream>
 #include "duration.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "latency_histogram.h"
+#include "output_buffer.h"
 #include "statistics_writer_html.h"
 #include "performance_counter.h"
 #include "statistics.h"
@@ -34,9 +34,17 @@
 
 namespace amxprof {
 
+static const int kNumPercentiles = 4;
+static const double kPercentiles[kNumPercentiles] = {50, 90, 99, 99.9};
+static const char *const kPercentileNames[kNumPercentiles] = {
+  "p50", "p90", "p99", "p99.9"
+};
+
 void StatisticsWriterHtml::Write(const Statistics *stats)
 {
-  *stream() << "\
+  OutputBuffer out(stream());
+
+  out << "\
 <!DOCTYPE html>\n\
 <html>\n\
 <head>\n\
@@ -163,7 +171,7 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
     <tbody>";
 
   if (print_date()) {
-    *stream() << "\
+    out << "\
       <tr>\n\
         <td>Date</td>\n\
         <td>" << CTime() << "</td>\n\
@@ -171,14 +179,31 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
   }
 
   if (print_run_time()) {
-    *stream() << "\
+    out << "\
       <tr>\n\
         <td>Duration</td>\n\
         <td>" << TimeSpan(stats->GetTotalRunTime()) << "</td>\n\
       </tr>\n";
   }
 
-  *stream() << "\
+  std::vector<FunctionStatistics*> all_fn_stats;
+  stats->GetStatistics(all_fn_stats);
+
+  typedef std::vector<FunctionStatistics*>::const_iterator FuncIterator;
+
+  // Percentile columns are only shown if there's something to show.
+  bool have_histograms = false;
+  for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const LatencyHistogram *histogram = (*it)->total_time_histogram();
+    if (histogram != 0 && histogram->total_count() > 0) {
+      have_histograms = true;
+      break;
+    }
+  }
+
+  int group_size = have_histograms ? 4 + kNumPercentiles : 4;
+
+  out << "\
 </tbody>\n\
   </table>\n\
   <table id=\"data\" class=\"tablesorter\">\n\
@@ -186,28 +211,35 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
       <tr>\n\
         <th rowspan=\"2\" data-sort-index=\"0\">Type</th>\n\
         <th rowspan=\"2\" data-sort-index=\"1\">Name</th>\n\
-        <th rowspan=\"2\" data-sort-index=\"2\">Calls</th>\n\
-        <th colspan=\"4\" data-sort-index=\"3\" class=\"group\">Self Time</th>\n\
-        <th colspan=\"4\" data-sort-index=\"7\" class=\"group\">Total Time</th>\n\
-      </tr>\n\
-      <tr>\n\
-        <th data-sort-index=\"3\">%</th>\n\
-        <th data-sort-index=\"4\">Overall</th>\n\
-        <th data-sort-index=\"5\">Average</th>\n\
-        <th data-sort-index=\"6\">Worst</th>\n\
-        <th data-sort-index=\"7\">%</th>\n\
-        <th data-sort-index=\"8\">Overall</th>\n\
-        <th data-sort-index=\"9\">Average</th>\n\
-        <th data-sort-index=\"10\">Worst</th>\n\
+        <th rowspan=\"2\" data-sort-index=\"2\">Calls</th>\n"
+    << "        <th colspan=\"" << group_size << "\" data-sort-index=\"3\""
+       " class=\"group\">Self Time</th>\n"
+    << "        <th colspan=\"" << group_size << "\" data-sort-index=\""
+       << 3 + group_size << "\" class=\"group\">Total Time</th>\n"
+    << "      </tr>\n"
+    << "      <tr>\n";
+
+  for (int group = 0; group < 2; group++) {
+    int index = 3 + group * group_size;
+    out
+      << "        <th data-sort-index=\"" << index << "\">%</th>\n"
+      << "        <th data-sort-index=\"" << index + 1 << "\">Overall</th>\n"
+      << "        <th data-sort-index=\"" << index + 2 << "\">Average</th>\n"
+      << "        <th data-sort-index=\"" << index + 3 << "\">Worst</th>\n";
+    if (have_histograms) {
+      for (int i = 0; i < kNumPercentiles; i++) {
+        out
+          << "        <th data-sort-index=\"" << index + 4 + i << "\">"
+          << kPercentileNames[i] << "</th>\n";
+      }
+    }
+  }
+
+  out << "\
       </tr>\n\
     </thead>\n\
     <tbody>\n";
 
-  std::vector<FunctionStatistics*> all_fn_stats;
-  stats->GetStatistics(all_fn_stats);
-
-  typedef std::vector<FunctionStatistics*>::const_iterator FuncIterator;
-
   Nanoseconds self_time_all;
   for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
     const FunctionStatistics *fn_stats = *it;
@@ -220,9 +252,6 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
     total_time_all += fn_stats->total_time();
   };
 
-  std::ostream::fmtflags flags = stream()->flags();
-  stream()->flags(flags | std::ostream::fixed);
-
   for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
     const FunctionStatistics *fn_stats = *it;
 
@@ -234,47 +263,69 @@ void StatisticsWriterHtml::Write(const Statistics *stats)
     double self_time = Seconds(fn_stats->self_time()).count();
     double total_time = Seconds(fn_stats->total_time()).count();
 
-    double avg_self_time =
-      Milliseconds(fn_stats->self_time()).count() / fn_stats->num_calls();
-    double avg_total_time =
-      Milliseconds(fn_stats->total_time()).count() / fn_stats->num_calls();
+    // Sampled functions have no call counts.
+    double avg_self_time = 0;
+    double avg_total_time = 0;
+    if (fn_stats->num_calls() > 0) {
+      avg_self_time =
+        Milliseconds(fn_stats->self_time()).count() / fn_stats->num_calls();
+      avg_total_time =
+        Milliseconds(fn_stats->total_time()).count() / fn_stats->num_calls();
+    }
 
     double worst_self_time =
       Milliseconds(fn_stats->worst_self_time()).count();
     double worst_total_time =
       Milliseconds(fn_stats->worst_total_time()).count();
 
-    *stream()
+    out
     << "    <tr>\n"
     << "      <td>" << fn_stats->function()->GetTypeString() << "</td>\n"
     << "      <td>" << fn_stats->function()->name() << "</td>\n"
     << "      <td class=\"numeric\">" << fn_stats->num_calls() << "</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(2)
-                                      << self_time_percent << "%</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << self_time << "</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << avg_self_time << "</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << worst_self_time << "</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(2)
-                                      << total_time_percent << "%</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << total_time << "</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << avg_total_time << "</td>\n"
-    << "      <td class=\"numeric\">" << std::setprecision(1)
-                                      << worst_total_time << "</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(self_time_percent, 2)
+                                      << "%</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(self_time, 1) << "</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(avg_self_time, 1) << "</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(worst_self_time, 1)
+                                      << "</td>\n";
+    if (have_histograms) {
+      WritePercentiles(out, fn_stats->self_time_histogram());
+    }
+    out
+    << "      <td class=\"numeric\">" << Fixed(total_time_percent, 2)
+                                      << "%</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(total_time, 1) << "</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(avg_total_time, 1) << "</td>\n"
+    << "      <td class=\"numeric\">" << Fixed(worst_total_time, 1)
+                                      << "</td>\n";
+    if (have_histograms) {
+      WritePercentiles(out, fn_stats->total_time_histogram());
+    }
+    out
     << "    </tr>\n";
   };
 
-  stream()->flags(flags);
-
-  *stream() << "\
+  out << "\
     </tbody>\n\
   </table>\n\
 </body>\n\
 </html>\n";
 }
 
+void StatisticsWriterHtml::WritePercentiles(
+    OutputBuffer &out,
+    const LatencyHistogram *histogram) {
+  for (int i = 0; i < kNumPercentiles; i++) {
+    out << "      <td class=\"numeric\">";
+    if (histogram != 0 && histogram->total_count() > 0) {
+      Nanoseconds value = histogram->GetPercentile(kPercentiles[i]);
+      out << Fixed(Milliseconds(value).count(), 3);
+    } else {
+      out << "-";
+    }
+    out << "</td>\n";
+  }
+}
+
 } // namespace amxprof
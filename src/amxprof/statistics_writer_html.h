@@ -29,9 +29,14 @@
 
 namespace amxprof {
 
+class LatencyHistogram;
+class OutputBuffer;
+
 class StatisticsWriterHtml : public StatisticsWriter {
  public:
   virtual void Write(const Statistics *stats);
+ private:
+  void WritePercentiles(OutputBuffer &out, const LatencyHistogram *histogram);
 };
 
 } // namespace amxprof
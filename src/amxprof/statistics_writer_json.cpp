@@ -22,10 +22,11 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <iostream>
 #include "duration.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "latency_histogram.h"
+#include "output_buffer.h"
 #include "performance_counter.h"
 #include "statistics_writer_json.h"
 #include "statistics.h"
@@ -33,43 +34,40 @@
 
 namespace amxprof {
 
-static std::string EscapString(const std::string &s) {
-  std::string t;
-
-  for (std::string::const_iterator iterator = s.begin();
-       iterator != s.end(); ++iterator) {
-    switch (*iterator) {
-      // According to http://www.json.org other escape sequences,
-      // apart from Unicode, are not supported by JSON.
-      case '"': t.append("\\\""); break;
-      case '\\': t.append("\\\\"); break;
-      case '\b': t.append("\\b"); break;
-      case '\f': t.append("\\f"); break;
-      case '\n': t.append("\\n"); break;
-      case '\r': t.append("\\r"); break;
-      case '\t': t.append("\\t"); break;
-      default: t.push_back(*iterator);
-    }
-  }
+static const int kNumPercentiles = 4;
+static const double kPercentiles[kNumPercentiles] = {50, 90, 99, 99.9};
+static const char *const kPercentileNames[kNumPercentiles] = {
+  "p50", "p90", "p99", "p99.9"
+};
 
-  return t;
+static void WritePercentiles(OutputBuffer &out,
+                             const LatencyHistogram *histogram) {
+  out << "{";
+  for (int i = 0; i < kNumPercentiles; i++) {
+    out << (i > 0 ? ", " : "") << "\"" << kPercentileNames[i] << "\": "
+        << Fixed(histogram->GetPercentile(kPercentiles[i]).count(), 0);
+  }
+  out << "}";
 }
 
 void StatisticsWriterJson::Write(const Statistics *stats)
 {
-  *stream() << "{\n"
-            << "  \"script\": \"" << EscapString(script_name()) << "\",\n";
+  OutputBuffer out(stream());
+
+  out << "{\n"
+      << "  \"script\": \"" << JsonEscaped(script_name()) << "\",\n";
 
   if (print_date()) {
-    *stream() << "  \"timestamp\": " << TimeStamp::Now() << ",\n";
+    out << "  \"timestamp\": "
+        << Fixed(static_cast<double>(TimeStamp::Now()), 0) << ",\n";
   }
 
   if (print_run_time()) {
-    *stream() << "  \"duration\": "
-              << Seconds(stats->GetTotalRunTime()).count() << ",\n";
+    out << "  \"duration\": "
+        << Fixed(Seconds(stats->GetTotalRunTime()).count(), 3) << ",\n";
   }
 
-  *stream() << "  \"functions\": [\n";
+  out << "  \"functions\": [\n";
 
   std::vector<FunctionStatistics*> all_fn_stats;
   stats->GetStatistics(all_fn_stats);
@@ -79,25 +77,39 @@ void StatisticsWriterJson::Write(const Statistics *stats)
   for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
     const FunctionStatistics *fn_stats = *it;
 
-    *stream() << "    {\n"
+    // Times are whole nanoseconds.
+    out << "    {\n"
       << "      \"type\": \""
         << fn_stats->function()->GetTypeString() << "\",\n"
       << "      \"name\": \""
-        << fn_stats->function()->name() << "\",\n"
+        << JsonEscaped(fn_stats->function()->name()) << "\",\n"
       << "      \"calls\": "
        << fn_stats->num_calls() << ",\n"
       << "      \"selfTime\": "
-        << fn_stats->self_time().count() << ",\n"
+        << Fixed(fn_stats->self_time().count(), 0) << ",\n"
       << "      \"worstSelfTime\": "
-        << fn_stats->worst_self_time().count() << ",\n"
+        << Fixed(fn_stats->worst_self_time().count(), 0) << ",\n"
       << "      \"totalTime\": "
-        << fn_stats->total_time().count() << ",\n"
+        << Fixed(fn_stats->total_time().count(), 0) << ",\n"
       << "      \"worstTotalTime\": "
-        << fn_stats->worst_total_time().count() << "\n"
-    << "    },\n";
+        << Fixed(fn_stats->worst_total_time().count(), 0);
+
+    const LatencyHistogram *self_time_histogram =
+      fn_stats->self_time_histogram();
+    const LatencyHistogram *total_time_histogram =
+      fn_stats->total_time_histogram();
+
+    if (total_time_histogram != 0 && total_time_histogram->total_count() > 0) {
+      out << ",\n      \"selfTimePercentiles\": ";
+      WritePercentiles(out, self_time_histogram);
+      out << ",\n      \"totalTimePercentiles\": ";
+      WritePercentiles(out, total_time_histogram);
+    }
+
+    out << "\n    },\n";
   }
 
-  *stream() << "    {}\n  ]\n}\n";
+  out << "    {}\n  ]\n}\n";
 }
 
 } // namespace amxprof
@@ -22,11 +22,12 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <iomanip>
-#include <iostream>
+#include <string>
 #include "duration.h"
 #include "function.h"
 #include "function_statistics.h"
+#include "latency_histogram.h"
+#include "output_buffer.h"
 #include "performance_counter.h"
 #include "statistics_writer_text.h"
 #include "statistics.h"
@@ -50,41 +51,55 @@ static const int kWidthAll = kTypeWidth + kNameWidth + kCallsWidth
 
 static const int kNumColumns = 11;
 
+static const int kLineWidth = kWidthAll + kNumColumns * 2 + 1;
+
+static const int kNumPercentiles = 4;
+static const double kPercentiles[kNumPercentiles] = {50, 90, 99, 99.9};
+static const char *const kPercentileNames[kNumPercentiles] = {
+  "p50", "p90", "p99", "p99.9"
+};
+static const int kPercentileWidth = 15;
+
+static const int kPercentileNumColumns = 2 + kNumPercentiles * 2;
+static const int kPercentileLineWidth = kTypeWidth + kNameWidth
+  + kNumPercentiles * 2 * kPercentileWidth + kPercentileNumColumns * 2 + 1;
+
 namespace amxprof {
 
-void StatisticsWriterText::DoHLine() {
-  char fillch = stream()->fill();
-  *stream() << std::setw(kWidthAll + kNumColumns * 2 + 1)
-            << std::setfill('-') << "" << std::setfill(fillch) << '\n';
+void StatisticsWriterText::DoHLine(OutputBuffer &out, int width) {
+  out.Fill('-', width);
+  out << '\n';
 }
 
 void StatisticsWriterText::Write(const Statistics *stats)
 {
-  *stream() << "Profile of '" << script_name() << "'";
+  OutputBuffer out(stream());
+
+  out << "Profile of '" << script_name() << "'";
 
   if (print_date()) {
-    *stream() << " generated on " << CTime();
+    out << " generated on " << CTime();
   }
 
   if (print_run_time()) {
-    *stream() << " (duration: " << TimeSpan(stats->GetTotalRunTime()) << ")\n";
+    out << " (duration: " << TimeSpan(stats->GetTotalRunTime()) << ")\n";
   }
 
-  DoHLine();
-  *stream() << std::left
-    << "| " << std::setw(kTypeWidth) << "Type"
-    << "| " << std::setw(kNameWidth) << "Name"
-    << "| " << std::setw(kCallsWidth) << "Calls"
-    << "| " << std::setw(kSelfTimePercentWidth) << "Self Time (%)"
-    << "| " << std::setw(kSelfTimeWidth) << "Self Time (s)"
-    << "| " << std::setw(kAvgSelfTimeWidth) << "Avg. ST (ms)"
-    << "| " << std::setw(kWorstSelfTimeWidth) << "Worst ST (ms)"
-    << "| " << std::setw(kTotalTimePercentWidth) << "Total Time (%)"
-    << "| " << std::setw(kTotalTimeWidth) << "Total Time (s)"
-    << "| " << std::setw(kAvgTotalTimeWidth) << "Avg. TT (ms)"
-    << "| " << std::setw(kWorstTotalTimeWidth) << "Worst TT (ms)"
+  DoHLine(out, kLineWidth);
+  out
+    << "| " << Left(kTypeWidth) << "Type"
+    << "| " << Left(kNameWidth) << "Name"
+    << "| " << Left(kCallsWidth) << "Calls"
+    << "| " << Left(kSelfTimePercentWidth) << "Self Time (%)"
+    << "| " << Left(kSelfTimeWidth) << "Self Time (s)"
+    << "| " << Left(kAvgSelfTimeWidth) << "Avg. ST (ms)"
+    << "| " << Left(kWorstSelfTimeWidth) << "Worst ST (ms)"
+    << "| " << Left(kTotalTimePercentWidth) << "Total Time (%)"
+    << "| " << Left(kTotalTimeWidth) << "Total Time (s)"
+    << "| " << Left(kAvgTotalTimeWidth) << "Avg. TT (ms)"
+    << "| " << Left(kWorstTotalTimeWidth) << "Worst TT (ms)"
     << "|\n";
-  DoHLine();
+  DoHLine(out, kLineWidth);
 
   std::vector<FunctionStatistics*> all_fn_stats;
   stats->GetStatistics(all_fn_stats);
@@ -103,9 +118,6 @@ void StatisticsWriterText::Write(const Statistics *stats)
     total_time_all += fn_stats->total_time();
   }
 
-  std::ostream::fmtflags flags = stream()->flags();
-  stream()->flags(flags | std::ostream::fixed);
-
   for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
     const FunctionStatistics *fn_stats = *it;
 
@@ -117,41 +129,103 @@ void StatisticsWriterText::Write(const Statistics *stats)
     double self_time = Seconds(fn_stats->self_time()).count();
     double total_time = Seconds(fn_stats->total_time()).count();
 
-    double avg_self_time =
-      Milliseconds(fn_stats->self_time()).count() / fn_stats->num_calls();
-    double avg_total_time =
-      Milliseconds(fn_stats->total_time()).count() / fn_stats->num_calls();
+    // Sampled functions have no call counts.
+    double avg_self_time = 0;
+    double avg_total_time = 0;
+    if (fn_stats->num_calls() > 0) {
+      avg_self_time =
+        Milliseconds(fn_stats->self_time()).count() / fn_stats->num_calls();
+      avg_total_time =
+        Milliseconds(fn_stats->total_time()).count() / fn_stats->num_calls();
+    }
 
     double worst_self_time =
       Milliseconds(fn_stats->worst_self_time()).count();
     double worst_total_time =
       Milliseconds(fn_stats->worst_total_time()).count();
 
-    *stream()
-      << "| " << std::setw(kTypeWidth) << fn_stats->function()->GetTypeString()
-      << "| " << std::setw(kNameWidth) << fn_stats->function()->name()
-      << "| " << std::setw(kCallsWidth) << fn_stats->num_calls()
-      << "| " << std::setw(kSelfTimePercentWidth) << std::setprecision(2)
-        << self_time_percent
-      << "| " << std::setw(kSelfTimeWidth) << std::setprecision(1)
-        << self_time
-      << "| " << std::setw(kAvgSelfTimeWidth) << std::setprecision(1)
-        << avg_self_time
-      << "| " << std::setw(kWorstSelfTimeWidth) << std::setprecision(1)
-        << worst_self_time
-      << "| " << std::setw(kTotalTimePercentWidth) << std::setprecision(2)
-        << total_time_percent
-      << "| " << std::setw(kTotalTimeWidth) << std::setprecision(1)
-        << total_time
-      << "| " << std::setw(kAvgTotalTimeWidth) << std::setprecision(1)
-        << avg_total_time
-      << "| " << std::setw(kWorstTotalTimeWidth) << std::setprecision(1)
-        << worst_total_time
+    out
+      << "| " << Left(kTypeWidth) << fn_stats->function()->GetTypeString()
+      << "| " << Left(kNameWidth) << fn_stats->function()->name()
+      << "| " << Left(kCallsWidth) << fn_stats->num_calls()
+      << "| " << Left(kSelfTimePercentWidth) << Fixed(self_time_percent, 2)
+      << "| " << Left(kSelfTimeWidth) << Fixed(self_time, 1)
+      << "| " << Left(kAvgSelfTimeWidth) << Fixed(avg_self_time, 1)
+      << "| " << Left(kWorstSelfTimeWidth) << Fixed(worst_self_time, 1)
+      << "| " << Left(kTotalTimePercentWidth) << Fixed(total_time_percent, 2)
+      << "| " << Left(kTotalTimeWidth) << Fixed(total_time, 1)
+      << "| " << Left(kAvgTotalTimeWidth) << Fixed(avg_total_time, 1)
+      << "| " << Left(kWorstTotalTimeWidth) << Fixed(worst_total_time, 1)
       << "|\n";
-    DoHLine();
+    DoHLine(out, kLineWidth);
+  }
+
+  WritePercentiles(out, all_fn_stats);
+}
+
+void StatisticsWriterText::WritePercentiles(
+    OutputBuffer &out,
+    const std::vector<FunctionStatistics*> &all_fn_stats) {
+  typedef std::vector<FunctionStatistics*>::const_iterator FuncIterator;
+
+  bool have_histograms = false;
+  for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const LatencyHistogram *histogram = (*it)->total_time_histogram();
+    if (histogram != 0 && histogram->total_count() > 0) {
+      have_histograms = true;
+      break;
+    }
+  }
+  if (!have_histograms) {
+    return;
+  }
+
+  out << "\nLatency percentiles\n";
+
+  DoHLine(out, kPercentileLineWidth);
+  out
+    << "| " << Left(kTypeWidth) << "Type"
+    << "| " << Left(kNameWidth) << "Name";
+  for (int i = 0; i < kNumPercentiles; i++) {
+    out << "| " << Left(kPercentileWidth)
+        << (std::string("ST ") + kPercentileNames[i] + " (ms)");
+  }
+  for (int i = 0; i < kNumPercentiles; i++) {
+    out << "| " << Left(kPercentileWidth)
+        << (std::string("TT ") + kPercentileNames[i] + " (ms)");
   }
+  out << "|\n";
+  DoHLine(out, kPercentileLineWidth);
 
-  stream()->flags(flags);
+  for (FuncIterator it = all_fn_stats.begin(); it != all_fn_stats.end(); ++it) {
+    const FunctionStatistics *fn_stats = *it;
+    const LatencyHistogram *self_time_histogram =
+      fn_stats->self_time_histogram();
+    const LatencyHistogram *total_time_histogram =
+      fn_stats->total_time_histogram();
+
+    if (total_time_histogram == 0 || total_time_histogram->total_count() == 0) {
+      continue;
+    }
+
+    out
+      << "| " << Left(kTypeWidth) << fn_stats->function()->GetTypeString()
+      << "| " << Left(kNameWidth) << fn_stats->function()->name();
+    for (int i = 0; i < kNumPercentiles; i++) {
+      out
+        << "| " << Left(kPercentileWidth)
+        << Fixed(Milliseconds(
+             self_time_histogram->GetPercentile(kPercentiles[i])).count(), 3);
+    }
+    for (int i = 0; i < kNumPercentiles; i++) {
+      out
+        << "| " << Left(kPercentileWidth)
+        << Fixed(Milliseconds(
+             total_time_histogram->GetPercentile(kPercentiles[i])).count(), 3);
+    }
+    out << "|\n";
+    DoHLine(out, kPercentileLineWidth);
+  }
 }
 
 } // namespace amxprof
@@ -25,15 +25,21 @@
 #ifndef AMXPROF_STATISTICS_WRITER_TEXT_H
 #define AMXPROF_STATISTICS_WRITER_TEXT_H
 
+#include <vector>
 #include "statistics_writer.h"
 
 namespace amxprof {
 
+class FunctionStatistics;
+class OutputBuffer;
+
 class StatisticsWriterText : public StatisticsWriter {
  public:
   virtual void Write(const Statistics *stats);
  private:
-  void DoHLine();
+  void DoHLine(OutputBuffer &out, int width);
+  void WritePercentiles(OutputBuffer &out,
+                        const std::vector<FunctionStatistics*> &all_fn_stats);
 };
 
 } // namespace amxprof
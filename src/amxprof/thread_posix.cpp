@@ -0,0 +1,98 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#include "system_error.h"
+#include "thread.h"
+
+namespace amxprof {
+
+namespace {
+
+void *ThreadProc(void *arg) {
+  static_cast<Thread::Runnable*>(arg)->Run();
+  return 0;
+}
+
+} // anonymous namespace
+
+Thread::Thread(Runnable *runnable)
+ : runnable_(runnable),
+   handle_(0)
+{
+}
+
+Thread::~Thread() {
+  Join();
+}
+
+void Thread::Start() {
+  if (handle_ != 0) {
+    return;
+  }
+  // SIGPROF is meant for the server thread (see Sampler). The new thread
+  // inherits the signal mask, so block the signal while creating it.
+  sigset_t signals;
+  sigset_t old_signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGPROF);
+  pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+  pthread_t *thread = new pthread_t;
+  int error = pthread_create(thread, 0, ThreadProc, runnable_);
+  pthread_sigmask(SIG_SETMASK, &old_signals, 0);
+  if (error != 0) {
+    delete thread;
+    throw SystemError("pthread_create", error);
+  }
+  handle_ = thread;
+}
+
+void Thread::Join() {
+  if (handle_ == 0) {
+    return;
+  }
+  pthread_t *thread = static_cast<pthread_t*>(handle_);
+  pthread_join(*thread, 0);
+  delete thread;
+  handle_ = 0;
+}
+
+// static
+void Thread::Sleep(Milliseconds duration) {
+  long ms = static_cast<long>(duration.count());
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000;
+  nanosleep(&ts, 0);
+}
+
+// static
+void Thread::MemoryFence() {
+  __sync_synchronize();
+}
+
+} // namespace amxprof
@@ -0,0 +1,202 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "function.h"
+#include "function_statistics.h"
+#include "output_buffer.h"
+#include "statistics.h"
+#include "time_series_recorder.h"
+
+namespace amxprof {
+
+namespace {
+
+// How often the writer thread checks for new records when idle.
+const Milliseconds kPollInterval(100);
+
+} // anonymous namespace
+
+TimeSeriesRecorder::TimeSeriesRecorder()
+ : read_pos_(0),
+   write_pos_(0),
+   stopping_(false),
+   writer_thread_(this)
+{
+}
+
+TimeSeriesRecorder::~TimeSeriesRecorder() {
+  Stop();
+}
+
+bool TimeSeriesRecorder::Start(const std::string &filename,
+                               const Statistics *stats) {
+  if (is_started()) {
+    return true;
+  }
+
+  stream_.open(filename.c_str(), std::ios::out | std::ios::app);
+  if (!stream_.is_open()) {
+    return false;
+  }
+
+  read_pos_ = 0;
+  write_pos_ = 0;
+  stopping_ = false;
+  last_counters_.clear();
+  UpdateCounters(stats, 0);
+  last_record_time_ = Clock::Now();
+
+  try {
+    writer_thread_.Start();
+  } catch (...) {
+    stream_.close();
+    throw;
+  }
+  return true;
+}
+
+void TimeSeriesRecorder::Stop() {
+  if (!is_started()) {
+    return;
+  }
+
+  stopping_ = true;
+  Thread::MemoryFence();
+  writer_thread_.Join();
+  stream_.close();
+}
+
+void TimeSeriesRecorder::RecordInterval(const Statistics *stats) {
+  std::size_t pos = write_pos_;
+  if (pos - read_pos_ >= kMaxPendingRecords) {
+    return;
+  }
+
+  TimePoint now = Clock::Now();
+  Record *record = new Record;
+  record->timestamp = std::time(0);
+  record->duration = now - last_record_time_;
+  UpdateCounters(stats, record);
+  last_record_time_ = now;
+
+  queue_[pos % kMaxPendingRecords] = record;
+
+  // Make sure the record is written before the consumer can see it.
+  Thread::MemoryFence();
+  write_pos_ = pos + 1;
+}
+
+void TimeSeriesRecorder::UpdateCounters(const Statistics *stats,
+                                        Record *record) {
+  std::size_t num_functions = static_cast<std::size_t>(stats->num_functions());
+  if (last_counters_.size() < num_functions) {
+    last_counters_.resize(num_functions);
+  }
+
+  for (std::size_t i = 0; i < num_functions; i++) {
+    const FunctionStatistics *fn_stats =
+      stats->GetFunctionStatisticsByIndex(static_cast<int>(i));
+    Counters &last = last_counters_[i];
+    if (fn_stats->num_calls() == last.num_calls
+        && fn_stats->self_time() == last.self_time
+        && fn_stats->total_time() == last.total_time) {
+      continue;
+    }
+    if (record != 0) {
+      Entry entry;
+      entry.fn = fn_stats->function();
+      entry.delta.num_calls = fn_stats->num_calls() - last.num_calls;
+      entry.delta.self_time = fn_stats->self_time() - last.self_time;
+      entry.delta.total_time = fn_stats->total_time() - last.total_time;
+      record->entries.push_back(entry);
+    }
+    last.num_calls = fn_stats->num_calls();
+    last.self_time = fn_stats->self_time();
+    last.total_time = fn_stats->total_time();
+  }
+}
+
+void TimeSeriesRecorder::Run() {
+  for (;;) {
+    bool stopping = stopping_;
+    Thread::MemoryFence();
+
+    if (WriteRecords() == 0) {
+      if (stopping) {
+        break;
+      }
+      Thread::Sleep(kPollInterval);
+    }
+  }
+}
+
+std::size_t TimeSeriesRecorder::WriteRecords() {
+  std::size_t read_pos = read_pos_;
+  std::size_t write_pos = write_pos_;
+  Thread::MemoryFence();
+
+  if (read_pos == write_pos) {
+    return 0;
+  }
+
+  {
+    OutputBuffer out(&stream_);
+    for (std::size_t pos = read_pos; pos != write_pos; pos++) {
+      Record *record = queue_[pos % kMaxPendingRecords];
+      WriteRecord(out, record);
+      delete record;
+    }
+  }
+  stream_.flush();
+
+  // Make sure the records are read before the producer can reuse the slots.
+  Thread::MemoryFence();
+  read_pos_ = write_pos;
+
+  return write_pos - read_pos;
+}
+
+void TimeSeriesRecorder::WriteRecord(OutputBuffer &out, const Record *record) {
+  out << "{\"timestamp\": "
+      << Fixed(static_cast<double>(record->timestamp), 0)
+      << ", \"duration\": "
+      << Fixed(Seconds(record->duration).count(), 3)
+      << ", \"functions\": [";
+
+  for (std::vector<Entry>::const_iterator iterator = record->entries.begin();
+       iterator != record->entries.end(); ++iterator) {
+    out << (iterator != record->entries.begin() ? ", " : "")
+        << "{\"type\": \"" << iterator->fn->GetTypeString()
+        << "\", \"name\": \"" << JsonEscaped(iterator->fn->name())
+        << "\", \"calls\": " << iterator->delta.num_calls
+        << ", \"selfTime\": "
+        << Fixed(iterator->delta.self_time.count(), 0)
+        << ", \"totalTime\": "
+        << Fixed(iterator->delta.total_time.count(), 0) << "}";
+  }
+
+  out << "]}\n";
+}
+
+} // namespace amxprof
@@ -0,0 +1,132 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TIME_SERIES_RECORDER_H
+#define AMXPROF_TIME_SERIES_RECORDER_H
+
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clock.h"
+#include "duration.h"
+#include "macros.h"
+#include "thread.h"
+
+namespace amxprof {
+
+class Function;
+class OutputBuffer;
+class Statistics;
+
+// TimeSeriesRecorder appends the calls, self time and total time of each
+// function during an interval to a JSON Lines file, one line per interval:
+//
+//   {"timestamp": 1760000000, "duration": 300.000, "functions": [
+//     {"type": "public", "name": "OnPlayerUpdate", "calls": 1200,
+//      "selfTime": 5400000, "totalTime": 9100000}, ...]}
+//
+// (without line breaks). The timestamp is the Unix time at which the
+// interval ended, the duration is in seconds and times are in whole
+// nanoseconds. Only functions that ran in the interval are listed.
+//
+// The server thread computes the differences from the previous interval
+// and queues them; a background thread formats and writes them. If the
+// writer falls behind and the queue is full, the interval is merged into
+// the next one.
+class TimeSeriesRecorder : private Thread::Runnable {
+ public:
+  static const std::size_t kMaxPendingRecords = 16;
+
+  TimeSeriesRecorder();
+  ~TimeSeriesRecorder();
+
+  bool is_started() const { return writer_thread_.is_running(); }
+
+  // Time at which the previous interval ended.
+  TimePoint last_record_time() const { return last_record_time_; }
+
+  // Opens the file for appending and starts the writer thread. The first
+  // interval starts at the current values of the statistics. Returns false
+  // if the file could not be opened.
+  bool Start(const std::string &filename, const Statistics *stats);
+
+  // Writes the remaining records and closes the file.
+  void Stop();
+
+  // Ends the current interval and queues a record of it. Must not be
+  // called while the script is executing, otherwise calls that haven't
+  // returned yet are split between intervals inconsistently.
+  void RecordInterval(const Statistics *stats);
+
+ private:
+  struct Counters {
+    Counters() : num_calls(0) {}
+    long num_calls;
+    Nanoseconds self_time;
+    Nanoseconds total_time;
+  };
+
+  struct Entry {
+    const Function *fn;
+    Counters delta;
+  };
+
+  struct Record {
+    std::time_t timestamp;
+    Nanoseconds duration;
+    std::vector<Entry> entries;
+  };
+
+  virtual void Run();
+
+  void UpdateCounters(const Statistics *stats, Record *record);
+
+  // Writes queued records to the file. Returns the number of records
+  // written.
+  std::size_t WriteRecords();
+  void WriteRecord(OutputBuffer &out, const Record *record);
+
+ private:
+  Record *queue_[kMaxPendingRecords];
+  volatile std::size_t read_pos_;
+  volatile std::size_t write_pos_;
+  volatile bool stopping_;
+
+  // Accessed only by the server thread.
+  std::vector<Counters> last_counters_;
+  TimePoint last_record_time_;
+
+  // Accessed only by the writer thread while it's running.
+  std::ofstream stream_;
+  Thread writer_thread_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(TimeSeriesRecorder);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_TIME_SERIES_RECORDER_H
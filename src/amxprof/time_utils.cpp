@@ -25,6 +25,7 @@
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include "output_buffer.h"
 #include "time_utils.h"
 
 namespace amxprof {
@@ -72,4 +73,11 @@ std::ostream &operator<<(std::ostream &os, const TimeSpan &time) {
   return os;
 }
 
+OutputBuffer &operator<<(OutputBuffer &out, const TimeSpan &time) {
+  out << Right(2, '0') << time.hours()   << ':'
+      << Right(2, '0') << time.minutes() << ':'
+      << Right(2, '0') << time.seconds();
+  return out;
+}
+
 } // namespace amxprof
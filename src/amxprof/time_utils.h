@@ -32,6 +32,8 @@
 
 namespace amxprof {
 
+class OutputBuffer;
+
 class TimeStamp {
  public:
   static std::time_t Now();
@@ -62,6 +64,7 @@ class TimeSpan {
 };
 
 std::ostream &operator<<(std::ostream &os, const TimeSpan &time);
+OutputBuffer &operator<<(OutputBuffer &out, const TimeSpan &time);
 
 } // namespace amxprof
 
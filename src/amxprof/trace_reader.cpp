@@ -0,0 +1,198 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include "trace_reader.h"
+
+namespace amxprof {
+
+namespace {
+
+template<typename T>
+bool ReadValue(std::ifstream &stream, T *value) {
+  return !!stream.read(reinterpret_cast<char*>(value), sizeof(*value));
+}
+
+} // anonymous namespace
+
+TraceReader::TraceReader()
+ : start_time_(0),
+   num_dropped_events_(-1),
+   next_record_(0),
+   time_(0)
+{
+}
+
+bool TraceReader::Open(const std::string &filename) {
+  stream_.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream_.is_open()) {
+    return false;
+  }
+
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  if (!stream_.read(magic, sizeof(magic))
+      || std::memcmp(magic, "AMXTRACE", sizeof(magic)) != 0
+      || !ReadValue(stream_, &version)
+      || !ReadValue(stream_, &record_size)
+      || !ReadValue(stream_, &start_time_)
+      || version != TraceRecorder::kFormatVersion
+      || record_size != sizeof(TraceRecorder::Record)) {
+    return false;
+  }
+
+  first_chunk_pos_ = stream_.tellg();
+
+  // The function table and the drop count are at the end of the file,
+  // skip over the events to get them first.
+  uint32_t type;
+  uint32_t size;
+  while (ReadChunkHeader(&type, &size)) {
+    if (type == TraceRecorder::CHUNK_FUNCTIONS) {
+      if (!ReadFunctionChunk(size)) {
+        break;
+      }
+    } else if (type == TraceRecorder::CHUNK_END) {
+      uint64_t num_dropped_events;
+      if (ReadValue(stream_, &num_dropped_events)) {
+        num_dropped_events_ = static_cast<long>(num_dropped_events);
+      }
+      break;
+    } else {
+      stream_.seekg(size, std::ios::cur);
+    }
+  }
+
+  stream_.clear();
+  stream_.seekg(first_chunk_pos_);
+  return true;
+}
+
+const TraceReader::FunctionInfo *TraceReader::GetFunction(int index) const {
+  if (index < 0 || static_cast<std::size_t>(index) >= functions_.size()
+      || !has_function_[index]) {
+    return 0;
+  }
+  return &functions_[index];
+}
+
+bool TraceReader::ReadEvent(Event *event) {
+  for (;;) {
+    while (next_record_ < records_.size()) {
+      const TraceRecorder::Record &record = records_[next_record_++];
+      uint32_t index = record.info & TraceRecorder::kIndexMask;
+      TraceRecorder::RecordType type = static_cast<TraceRecorder::RecordType>(
+        record.info >> TraceRecorder::kTypeShift);
+
+      if (type == TraceRecorder::RECORD_TIME) {
+        time_ = static_cast<uint64_t>(record.delta)
+              | (static_cast<uint64_t>(record.frame) << 32);
+        continue;
+      }
+
+      event->type = type;
+      event->function = 0;
+      event->frame = 0;
+      event->num_dropped_events = 0;
+
+      if (type == TraceRecorder::RECORD_DROP) {
+        event->num_dropped_events = static_cast<long>(record.delta);
+      } else {
+        time_ += record.delta;
+        event->function = static_cast<int>(index);
+        event->frame = static_cast<Address>(record.frame);
+      }
+
+      event->time = Nanoseconds(static_cast<double>(time_));
+      return true;
+    }
+
+    uint32_t type;
+    uint32_t size;
+    for (;;) {
+      if (!ReadChunkHeader(&type, &size)) {
+        return false;
+      }
+      if (type == TraceRecorder::CHUNK_EVENTS) {
+        break;
+      }
+      if (type == TraceRecorder::CHUNK_END) {
+        return false;
+      }
+      stream_.seekg(size, std::ios::cur);
+    }
+
+    records_.resize(size / sizeof(TraceRecorder::Record));
+    next_record_ = 0;
+    if (!records_.empty()
+        && !stream_.read(reinterpret_cast<char*>(&records_[0]),
+                         records_.size() * sizeof(TraceRecorder::Record))) {
+      // Truncated chunk, e.g. the server crashed while writing it.
+      records_.resize(static_cast<std::size_t>(stream_.gcount())
+                      / sizeof(TraceRecorder::Record));
+    }
+  }
+}
+
+bool TraceReader::ReadChunkHeader(uint32_t *type, uint32_t *size) {
+  return ReadValue(stream_, type) && ReadValue(stream_, size);
+}
+
+bool TraceReader::ReadFunctionChunk(uint32_t size) {
+  std::streampos end = stream_.tellg() + std::streamoff(size);
+
+  while (stream_.tellg() < end) {
+    uint32_t index;
+    uint32_t type;
+    uint32_t address;
+    uint32_t name_length;
+    if (!ReadValue(stream_, &index)
+        || !ReadValue(stream_, &type)
+        || !ReadValue(stream_, &address)
+        || !ReadValue(stream_, &name_length)
+        || index > TraceRecorder::kIndexMask) {
+      return false;
+    }
+
+    FunctionInfo info;
+    info.type = static_cast<Function::Type>(type);
+    info.address = static_cast<Address>(address);
+    info.name.resize(name_length);
+    if (name_length > 0 && !stream_.read(&info.name[0], name_length)) {
+      return false;
+    }
+
+    if (index >= functions_.size()) {
+      functions_.resize(index + 1);
+      has_function_.resize(index + 1, false);
+    }
+    functions_[index] = info;
+    has_function_[index] = true;
+  }
+
+  return true;
+}
+
+} // namespace amxprof
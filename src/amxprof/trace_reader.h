@@ -0,0 +1,105 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TRACE_READER_H
+#define AMXPROF_TRACE_READER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "amx_types.h"
+#include "duration.h"
+#include "function.h"
+#include "macros.h"
+#include "stdint.h"
+#include "trace_recorder.h"
+
+namespace amxprof {
+
+// TraceReader reads trace files written by TraceRecorder. Events are read
+// one chunk at a time, so memory usage doesn't depend on the size of the
+// trace.
+class TraceReader {
+ public:
+  struct FunctionInfo {
+    Function::Type type;
+    Address address;
+    std::string name;
+  };
+
+  struct Event {
+    TraceRecorder::RecordType type;
+    int function;
+    Address frame;
+    // Time since the start of the trace.
+    Nanoseconds time;
+    // For RECORD_DROP events, the number of events that were lost.
+    long num_dropped_events;
+  };
+
+  TraceReader();
+
+  // Reads the file header and the function table. Returns false if the
+  // file could not be opened or is not a trace file.
+  bool Open(const std::string &filename);
+
+  // Unix time at which the trace was started.
+  int64_t start_time() const { return start_time_; }
+
+  // Returns the total number of dropped events, or -1 if the trace was
+  // not finished properly.
+  long num_dropped_events() const { return num_dropped_events_; }
+
+  // Returns information about a function, or null if the index is not
+  // in the function table.
+  const FunctionInfo *GetFunction(int index) const;
+
+  // Reads the next event. Returns false at the end of the trace.
+  // RECORD_TIME records are handled internally and never returned.
+  bool ReadEvent(Event *event);
+
+ private:
+  bool ReadChunkHeader(uint32_t *type, uint32_t *size);
+  bool ReadFunctionChunk(uint32_t size);
+
+ private:
+  std::ifstream stream_;
+  int64_t start_time_;
+  long num_dropped_events_;
+  std::vector<FunctionInfo> functions_;
+  std::vector<bool> has_function_;
+  std::streampos first_chunk_pos_;
+
+  // Records of the current event chunk.
+  std::vector<TraceRecorder::Record> records_;
+  std::size_t next_record_;
+  uint64_t time_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(TraceReader);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_TRACE_READER_H
@@ -0,0 +1,255 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <ctime>
+#include "function.h"
+#include "function_statistics.h"
+#include "statistics.h"
+#include "trace_recorder.h"
+
+namespace amxprof {
+
+namespace {
+
+// Maximum number of records per event chunk.
+const std::size_t kChunkSize = 16384;
+
+// How often the writer thread checks for new records when idle.
+const Milliseconds kPollInterval(10);
+
+template<typename T>
+void WriteValue(std::ofstream &stream, T value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // anonymous namespace
+
+TraceRecorder::TraceRecorder(std::size_t buffer_size)
+ : buffer_mask_(0),
+   read_pos_(0),
+   write_pos_(0),
+   num_dropped_events_(0),
+   stopping_(false),
+   last_time_(0),
+   pending_drops_(0),
+   writer_thread_(this)
+{
+  std::size_t size = 2;
+  while (size < buffer_size) {
+    size *= 2;
+  }
+  buffer_.resize(size);
+  buffer_mask_ = size - 1;
+  chunk_.reserve(kChunkSize);
+}
+
+TraceRecorder::~TraceRecorder() {
+  Stop(0);
+}
+
+bool TraceRecorder::Start(const std::string &filename) {
+  if (is_started()) {
+    return true;
+  }
+
+  stream_.open(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream_.is_open()) {
+    return false;
+  }
+
+  stream_.write("AMXTRACE", 8);
+  WriteValue<uint32_t>(stream_, kFormatVersion);
+  WriteValue<uint32_t>(stream_, sizeof(Record));
+  WriteValue<int64_t>(stream_, static_cast<int64_t>(std::time(0)));
+
+  read_pos_ = 0;
+  write_pos_ = 0;
+  num_dropped_events_ = 0;
+  stopping_ = false;
+  start_time_ = Clock::Now();
+  last_time_ = 0;
+  pending_drops_ = 0;
+
+  try {
+    writer_thread_.Start();
+  } catch (...) {
+    stream_.close();
+    throw;
+  }
+  return true;
+}
+
+void TraceRecorder::Stop(const Statistics *stats) {
+  if (!is_started()) {
+    return;
+  }
+
+  stopping_ = true;
+  Thread::MemoryFence();
+  writer_thread_.Join();
+
+  if (stats != 0) {
+    WriteFunctionChunk(stats);
+  }
+  WriteEndChunk();
+  stream_.close();
+}
+
+void TraceRecorder::AddRecord(RecordType type, int index, Address frame) {
+  uint64_t now =
+    static_cast<uint64_t>((Clock::Now() - start_time_).count());
+  uint64_t delta = now > last_time_ ? now - last_time_ : 0;
+
+  std::size_t num_records = 1;
+  if (pending_drops_ > 0) {
+    num_records++;
+  }
+  if (delta > 0xFFFFFFFFu) {
+    num_records++;
+  }
+
+  std::size_t pos = write_pos_;
+  if (buffer_.size() - (pos - read_pos_) < num_records) {
+    pending_drops_++;
+    num_dropped_events_++;
+    return;
+  }
+
+  if (pending_drops_ > 0) {
+    PutRecord(pos++, RECORD_DROP, 0, pending_drops_, 0);
+    pending_drops_ = 0;
+  }
+  if (delta > 0xFFFFFFFFu) {
+    PutRecord(pos++, RECORD_TIME, 0,
+              static_cast<uint32_t>(now),
+              static_cast<uint32_t>(now >> 32));
+    delta = 0;
+  }
+  PutRecord(pos++, type, index,
+            static_cast<uint32_t>(delta),
+            static_cast<uint32_t>(frame));
+  last_time_ = now;
+
+  // Make sure the records are written before the consumer can see them.
+  Thread::MemoryFence();
+  write_pos_ = pos;
+}
+
+void TraceRecorder::PutRecord(std::size_t pos,
+                              RecordType type,
+                              int index,
+                              uint32_t delta,
+                              uint32_t frame) {
+  Record &record = buffer_[pos & buffer_mask_];
+  record.info = (static_cast<uint32_t>(index) & kIndexMask)
+              | (static_cast<uint32_t>(type) << kTypeShift);
+  record.delta = delta;
+  record.frame = frame;
+}
+
+void TraceRecorder::Run() {
+  for (;;) {
+    bool stopping = stopping_;
+    Thread::MemoryFence();
+
+    std::size_t num_read = ReadRecords();
+    if (chunk_.size() >= kChunkSize) {
+      WriteEventChunk();
+    }
+    if (num_read == 0) {
+      // Write what we have so that the file doesn't lag behind for too long
+      // when the server is idle.
+      WriteEventChunk();
+      if (stopping) {
+        break;
+      }
+      Thread::Sleep(kPollInterval);
+    }
+  }
+}
+
+std::size_t TraceRecorder::ReadRecords() {
+  std::size_t read_pos = read_pos_;
+  std::size_t write_pos = write_pos_;
+  Thread::MemoryFence();
+
+  std::size_t num_records = write_pos - read_pos;
+  if (num_records > kChunkSize - chunk_.size()) {
+    num_records = kChunkSize - chunk_.size();
+  }
+
+  for (std::size_t i = 0; i < num_records; i++) {
+    chunk_.push_back(buffer_[(read_pos + i) & buffer_mask_]);
+  }
+
+  // Make sure the records are copied before the producer can reuse them.
+  Thread::MemoryFence();
+  read_pos_ = read_pos + num_records;
+
+  return num_records;
+}
+
+void TraceRecorder::WriteEventChunk() {
+  if (chunk_.empty()) {
+    return;
+  }
+  WriteChunkHeader(CHUNK_EVENTS, chunk_.size() * sizeof(Record));
+  stream_.write(reinterpret_cast<const char*>(&chunk_[0]),
+                chunk_.size() * sizeof(Record));
+  stream_.flush();
+  chunk_.clear();
+}
+
+void TraceRecorder::WriteFunctionChunk(const Statistics *stats) {
+  std::size_t size = 0;
+  for (int i = 0; i < stats->num_functions(); i++) {
+    const Function *fn = stats->GetFunctionStatisticsByIndex(i)->function();
+    size += 4 * sizeof(uint32_t) + fn->name().length();
+  }
+
+  WriteChunkHeader(CHUNK_FUNCTIONS, size);
+
+  for (int i = 0; i < stats->num_functions(); i++) {
+    const FunctionStatistics *fn_stats = stats->GetFunctionStatisticsByIndex(i);
+    const Function *fn = fn_stats->function();
+    std::string name = fn->name();
+    WriteValue<uint32_t>(stream_, static_cast<uint32_t>(fn_stats->index()));
+    WriteValue<uint32_t>(stream_, static_cast<uint32_t>(fn->type()));
+    WriteValue<uint32_t>(stream_, static_cast<uint32_t>(fn->address()));
+    WriteValue<uint32_t>(stream_, static_cast<uint32_t>(name.length()));
+    stream_.write(name.data(), name.length());
+  }
+}
+
+void TraceRecorder::WriteEndChunk() {
+  WriteChunkHeader(CHUNK_END, sizeof(uint64_t));
+  WriteValue<uint64_t>(stream_, static_cast<uint64_t>(num_dropped_events_));
+}
+
+void TraceRecorder::WriteChunkHeader(ChunkType type, std::size_t size) {
+  WriteValue<uint32_t>(stream_, static_cast<uint32_t>(type));
+  WriteValue<uint32_t>(stream_, static_cast<uint32_t>(size));
+}
+
+} // namespace amxprof
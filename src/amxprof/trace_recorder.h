@@ -0,0 +1,177 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TRACE_RECORDER_H
+#define AMXPROF_TRACE_RECORDER_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "amx_types.h"
+#include "clock.h"
+#include "macros.h"
+#include "stdint.h"
+#include "thread.h"
+
+namespace amxprof {
+
+class Statistics;
+
+// TraceRecorder writes a timeline of function calls to a binary file.
+//
+// Events are appended by the server thread to a single-producer/single-
+// consumer ring buffer and written to disk by a background thread. If the
+// writer falls behind and the buffer fills up, new events are dropped
+// (and counted) rather than blocking the server thread.
+//
+// File format (all integers are little-endian):
+//
+//   Header:
+//     char[8]   "AMXTRACE"
+//     uint32    format version (1)
+//     uint32    record size in bytes (12)
+//     int64     time at which the trace was started (Unix time)
+//
+//   The header is followed by chunks:
+//     uint32    chunk type
+//     uint32    size of chunk data in bytes
+//     ...       chunk data
+//
+//   Chunk types:
+//     1  Events: an array of records.
+//     2  Functions: for each function seen in the trace:
+//          uint32  function index
+//          uint32  function type (0 - normal, 1 - public, 2 - native)
+//          uint32  function address
+//          uint32  name length
+//          char[]  name, not null-terminated
+//     3  End: uint64 total number of dropped events. This is always the
+//        last chunk; it's missing if the server crashed.
+//
+//   Records:
+//     uint32    bits 0-29: function index, bits 30-31: record type
+//     uint32    time since the previous record in nanoseconds
+//     uint32    frame address of the call
+//
+//   Record types:
+//     0  Enter: a function was called.
+//     1  Leave: a function returned.
+//     2  Time: the two last fields hold the low and high 32 bits of the
+//        time since the start of the trace in nanoseconds. Written before
+//        an event whose time delta doesn't fit into 32 bits.
+//     3  Drop: the second field holds the number of events that were
+//        dropped at this point because the buffer was full.
+class TraceRecorder : private Thread::Runnable {
+ public:
+  static const uint32_t kFormatVersion = 1;
+
+  // Layout of Record::info.
+  static const uint32_t kIndexMask = 0x3FFFFFFF;
+  static const int kTypeShift = 30;
+
+  enum RecordType {
+    RECORD_ENTER,
+    RECORD_LEAVE,
+    RECORD_TIME,
+    RECORD_DROP
+  };
+
+  enum ChunkType {
+    CHUNK_EVENTS = 1,
+    CHUNK_FUNCTIONS = 2,
+    CHUNK_END = 3
+  };
+
+  struct Record {
+    uint32_t info;
+    uint32_t delta;
+    uint32_t frame;
+  };
+
+  // The buffer size is in records and is rounded up to a power of two.
+  explicit TraceRecorder(std::size_t buffer_size);
+  ~TraceRecorder();
+
+  bool is_started() const { return writer_thread_.is_running(); }
+
+  // Opens the trace file and starts the writer thread. Returns false if
+  // the file could not be opened.
+  bool Start(const std::string &filename);
+
+  // Writes the remaining events and the function table and closes the
+  // file.
+  void Stop(const Statistics *stats);
+
+  void RecordEnter(int index, Address frame) {
+    AddRecord(RECORD_ENTER, index, frame);
+  }
+  void RecordLeave(int index, Address frame) {
+    AddRecord(RECORD_LEAVE, index, frame);
+  }
+
+  // Returns the number of events lost because the buffer was full.
+  long num_dropped_events() const { return num_dropped_events_; }
+
+ private:
+  virtual void Run();
+
+  void AddRecord(RecordType type, int index, Address frame);
+  void PutRecord(std::size_t pos, RecordType type, int index,
+                 uint32_t delta, uint32_t frame);
+
+  // Moves records from the ring buffer to the current chunk. Returns the
+  // number of records moved.
+  std::size_t ReadRecords();
+
+  void WriteEventChunk();
+  void WriteFunctionChunk(const Statistics *stats);
+  void WriteEndChunk();
+  void WriteChunkHeader(ChunkType type, std::size_t size);
+
+ private:
+  std::vector<Record> buffer_;
+  std::size_t buffer_mask_;
+  volatile std::size_t read_pos_;
+  volatile std::size_t write_pos_;
+  volatile long num_dropped_events_;
+  volatile bool stopping_;
+
+  // Accessed only by the server thread.
+  TimePoint start_time_;
+  uint64_t last_time_;
+  uint32_t pending_drops_;
+
+  // Accessed only by the writer thread while it's running.
+  std::vector<Record> chunk_;
+  std::ofstream stream_;
+  Thread writer_thread_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(TraceRecorder);
+};
+
+} // namespace amxprof
+
+#endif // !AMXPROF_TRACE_RECORDER_H
@@ -0,0 +1,127 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+#include "duration.h"
+#include "output_buffer.h"
+#include "trace_reader.h"
+#include "trace_writer_chrome.h"
+
+namespace amxprof {
+
+namespace {
+
+void WriteFunctionName(OutputBuffer &out,
+                       const TraceReader *reader,
+                       int index) {
+  const TraceReader::FunctionInfo *info = reader->GetFunction(index);
+  if (info != 0) {
+    out << JsonEscaped(info->name);
+  } else {
+    out << "function#" << index;
+  }
+}
+
+const char *GetFunctionCategory(const TraceReader *reader, int index) {
+  const TraceReader::FunctionInfo *info = reader->GetFunction(index);
+  if (info != 0) {
+    switch (info->type) {
+      case Function::NORMAL:
+        return "normal";
+      case Function::PUBLIC:
+        return "public";
+      case Function::NATIVE:
+        return "native";
+    }
+  }
+  return "unknown";
+}
+
+} // anonymous namespace
+
+void TraceWriterChrome::Write(TraceReader *reader) {
+  OutputBuffer out(stream());
+
+  out
+    << "{\"displayTimeUnit\": \"ns\",\n"
+    << " \"otherData\": {\"script\": \"" << JsonEscaped(script_name())
+    << "\", \"startTime\": ";
+  out.WriteInteger(reader->start_time());
+  out
+    << "},\n"
+    << " \"traceEvents\": [\n"
+    << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, "
+       "\"args\": {\"name\": \"" << JsonEscaped(script_name()) << "\"}}";
+
+  // Events may be missing if the buffer overflowed while recording. Extra
+  // "E" events are skipped and calls that are still open at the end are
+  // closed, so that viewers don't choke on unbalanced events.
+  long depth = 0;
+  double last_time = 0;
+
+  TraceReader::Event event;
+  while (reader->ReadEvent(&event)) {
+    double time = Microseconds(event.time).count();
+    last_time = time;
+
+    switch (event.type) {
+      case TraceRecorder::RECORD_ENTER:
+        out << ",\n  {\"name\": \"";
+        WriteFunctionName(out, reader, event.function);
+        out
+          << "\", \"cat\": \"" << GetFunctionCategory(reader, event.function)
+          << "\", \"ph\": \"B\", \"ts\": " << Fixed(time, 3)
+          << ", \"pid\": 1, \"tid\": 1}";
+        depth++;
+        break;
+      case TraceRecorder::RECORD_LEAVE:
+        if (depth == 0) {
+          break;
+        }
+        out
+          << ",\n  {\"ph\": \"E\", \"ts\": " << Fixed(time, 3)
+          << ", \"pid\": 1, \"tid\": 1}";
+        depth--;
+        break;
+      case TraceRecorder::RECORD_DROP:
+        out
+          << ",\n  {\"name\": \"Dropped " << event.num_dropped_events
+          << " events\", \"ph\": \"i\", \"s\": \"g\", \"ts\": "
+          << Fixed(time, 3) << ", \"pid\": 1, \"tid\": 1}";
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (; depth > 0; depth--) {
+    out
+      << ",\n  {\"ph\": \"E\", \"ts\": " << Fixed(last_time, 3)
+      << ", \"pid\": 1, \"tid\": 1}";
+  }
+
+  out << "\n]}\n";
+}
+
+} // namespace amxprof
@@ -83,6 +83,14 @@ std::time_t GetModificationTime(const std::string &path) {
   return 0;
 }
 
+long GetFileSize(const std::string &path) {
+  struct stat attrib;
+  if (stat(path.c_str(), &attrib) == 0) {
+    return static_cast<long>(attrib.st_size);
+  }
+  return -1;
+}
+
 std::string ToUnixPath(std::string path) {
   std::replace(path.begin(), path.end(), '\\', '/');
   return path;
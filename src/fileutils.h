@@ -44,6 +44,7 @@ std::string GetFileExtension(const std::string &path);
 const char *GetFileExtensionPtr(const char *path);
 
 std::time_t GetModificationTime(const std::string &path);
+long GetFileSize(const std::string &path);
 
 void GetDirectoryFiles(const std::string &directory,
                        const std::string &pattern,
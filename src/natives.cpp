@@ -40,7 +40,7 @@ cell AMX_NATIVE_CALL Profiler_Stop(AMX *amx, cell *params) {
 }
 
 cell AMX_NATIVE_CALL Profiler_Dump(AMX *amx, cell *params) {
-  return ProfilerHandler::GetHandler(amx)->Dump();
+  return ProfilerHandler::GetHandler(amx)->Dump(false);
 }
 
 const AMX_NATIVE_INFO natives[] = {
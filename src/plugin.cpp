@@ -59,6 +59,10 @@ std::string last_amx_path;
 // an AMX instance.
 AMXPathFinder amx_path_finder;
 
+// Remembers headers of AMX files across server restarts so that they can be
+// found without scanning the search paths.
+const char kAMXPathCacheFile[] = "plugins/profiler_amxpaths.cache";
+
 #ifdef _WIN32
   subhook::Hook create_file_hook;
 
@@ -154,6 +158,7 @@ PLUGIN_EXPORT bool PLUGIN_CALL Load(void **ppData) {
 
   amx_path_finder.AddSearchPath("gamemodes");
   amx_path_finder.AddSearchPath("filterscripts");
+  amx_path_finder.SetCacheFile(kAMXPathCacheFile);
 
   const char *amx_path_var = getenv("AMX_PATH");
   if (amx_path_var != 0) {
@@ -164,6 +169,8 @@ PLUGIN_EXPORT bool PLUGIN_CALL Load(void **ppData) {
                    &amx_path_finder));
   }
 
+  ProfilerHandler::Init();
+
   logprintf("  Profiler plugin " PLUGIN_VERSION_STRING);
   return true;
 }
@@ -184,12 +191,15 @@ PLUGIN_EXPORT int PLUGIN_CALL AmxLoad(AMX *amx) {
   if (profiler->GetState() > PROFILER_DISABLED) {
     profiler->Start();
 
-    amx_SetDebugHook(amx, amx_Debug_Profiler);
-    amx_SetCallback(amx, amx_Callback_Profiler);
+    // In sampling mode the profiler doesn't need to see individual calls.
+    if (ProfilerHandler::GetMode() != PROFILER_MODE_SAMPLING) {
+      amx_SetDebugHook(amx, amx_Debug_Profiler);
+      amx_SetCallback(amx, amx_Callback_Profiler);
 
-    // This should stop the VM from replacing SYSREQ.C instructions with
-    // SYSREQ.D and allow us to profile native functions.
-    amx->sysreq_d = 0;
+      // This should stop the VM from replacing SYSREQ.C instructions with
+      // SYSREQ.D and allow us to profile native functions.
+      amx->sysreq_d = 0;
+    }
   }
 
   return RegisterNatives(amx);
@@ -200,7 +210,7 @@ PLUGIN_EXPORT int PLUGIN_CALL AmxUnload(AMX *amx) {
 
   int error = profiler->Unload();
   profiler->Stop();
-  profiler->Dump();
+  profiler->Dump(true);
 
   ProfilerHandler::DestroyHandler(amx);
   return error;
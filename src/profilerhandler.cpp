@@ -25,6 +25,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdarg>
+#include <cstdio>
+#include <ctime>
 #include <exception>
 #include <fstream>
 #include <iterator>
@@ -32,11 +34,24 @@
 #include <string>
 #include <amx/amxaux.h>
 #include <amxprof/call_graph_writer_dot.h>
+#include <amxprof/call_tree_writer_folded.h>
+#include <amxprof/call_tree_writer_pprof.h>
+#include <amxprof/call_tree_writer_text.h>
+#include <amxprof/clock.h>
 #include <amxprof/function.h>
 #include <amxprof/function_statistics.h>
+#include <amxprof/line_statistics.h>
+#include <amxprof/line_statistics_writer_text.h>
+#include <amxprof/sampler.h>
+#include <amxprof/statistics.h>
+#include <amxprof/statistics_writer_callgrind.h>
 #include <amxprof/statistics_writer_html.h>
 #include <amxprof/statistics_writer_json.h>
 #include <amxprof/statistics_writer_text.h>
+#include <amxprof/thread.h>
+#include <amxprof/time_series_recorder.h>
+#include <amxprof/trace_reader.h>
+#include <amxprof/trace_writer_chrome.h>
 #include "amxpathfinder.h"
 #include "fileutils.h"
 #include "logprintf.h"
@@ -60,6 +75,34 @@ bool call_graph =
     server_cfg.GetValueWithDefault("profiler_callgraph", false);
 std::string call_graph_format =
     server_cfg.GetValueWithDefault("profiler_callgraphformat", "dot");
+bool call_tree =
+    server_cfg.GetValueWithDefault("profiler_calltree", false);
+std::string call_tree_format =
+    server_cfg.GetValueWithDefault("profiler_calltreeformat", "txt");
+int call_tree_max_depth =
+    server_cfg.GetValueWithDefault("profiler_calltreemaxdepth", 64);
+int call_tree_max_nodes =
+    server_cfg.GetValueWithDefault("profiler_calltreemaxnodes", 100000);
+bool lines =
+    server_cfg.GetValueWithDefault("profiler_lines", false);
+bool trace =
+    server_cfg.GetValueWithDefault("profiler_trace", false);
+int trace_buffer_size =
+    server_cfg.GetValueWithDefault("profiler_tracebuffersize", 262144);
+std::string histograms =
+    server_cfg.GetValueWithDefault("profiler_histograms", "publics");
+std::string clock =
+    server_cfg.GetValueWithDefault("profiler_clock", "monotonic");
+std::string mode =
+    server_cfg.GetValueWithDefault("profiler_mode", "instrumentation");
+int sampling_interval =
+    server_cfg.GetValueWithDefault("profiler_samplinginterval", 1000);
+int dump_interval =
+    server_cfg.GetValueWithDefault("profiler_dumpinterval", 0);
+int dump_retention =
+    server_cfg.GetValueWithDefault("profiler_dumpretention", 24);
+int time_series_interval =
+    server_cfg.GetValueWithDefault("profiler_timeseriesinterval", 0);
 
 namespace old {
 
@@ -78,6 +121,34 @@ std::string call_graph_format =
 } // namespace old
 } // namespace cfg
 
+// Size of the sample buffer in cells, enough for a few minutes of samples
+// at the default interval.
+const std::size_t kSampleBufferSize = 1 << 20;
+
+ProfilerMode profiler_mode = PROFILER_MODE_INSTRUMENTATION;
+
+amxprof::Profiler::HistogramMode histogram_mode =
+  amxprof::Profiler::HISTOGRAMS_PUBLICS;
+
+bool interval_dumps_enabled = false;
+
+class SampleCollector : public amxprof::Sampler::Visitor {
+ public:
+  SampleCollector(amxprof::Profiler *profiler)
+   : profiler_(profiler),
+     duration_(amxprof::Sampler::interval())
+  {
+  }
+
+  virtual void Visit(const amxprof::Address *stack, int depth) {
+    profiler_->AddSample(stack, depth, duration_);
+  }
+
+ private:
+  amxprof::Profiler *profiler_;
+  amxprof::Nanoseconds duration_;
+};
+
 void Printf(const char *format, ...) {
   std::va_list va;
   va_start(va, format);
@@ -98,6 +169,30 @@ bool IsCallGraphEnabled() {
   return cfg::call_graph || cfg::old::call_graph;
 }
 
+std::string GetOutputFormat() {
+  std::string output_format = cfg::output_format;
+  if (output_format.empty()) {
+    output_format = cfg::old::profile_format;
+  }
+  stringutils::ToLower(output_format);
+  return output_format;
+}
+
+// The callgrind format includes call edges, which come from the call graph.
+bool IsCallGraphNeeded() {
+  return IsCallGraphEnabled() || GetOutputFormat() == "callgrind";
+}
+
+// Returns the local time in a form that sorts chronologically and can be
+// used in file names.
+std::string GetFileTimeStamp() {
+  std::time_t now = std::time(0);
+  char buffer[32] = "";
+  std::strftime(buffer, sizeof(buffer), "%Y%m%d-%H%M%S",
+                std::localtime(&now));
+  return buffer;
+}
+
 bool IsGameMode(const std::string &amx_path) {
   return amx_path.find("gamemodes/") != std::string::npos;
 }
@@ -144,13 +239,242 @@ bool ShouldBeProfiled(const std::string amx_path) {
 
 } // anonymous namespace
 
+// A dump job owns a snapshot of the profiler's data and writes it out on
+// a worker thread, so that the server doesn't stall while the files are
+// being written. Messages are collected and printed from the server thread
+// once the job is done, because logprintf() isn't thread-safe.
+class ProfilerHandler::DumpJob : public amxprof::Thread::Runnable {
+ public:
+  DumpJob(const std::string &amx_path, const std::string &amx_name);
+  virtual ~DumpJob();
+
+  // An empty format means no profile is written.
+  void set_output_format(const std::string &output_format) {
+    output_format_ = output_format;
+  }
+  void set_profile_filename(const std::string &profile_filename) {
+    profile_filename_ = profile_filename;
+  }
+  // The debug info is shared with the handler, which must not modify it
+  // until the job is done.
+  void set_debug_info(const amxprof::DebugInfo *debug_info) {
+    debug_info_ = debug_info;
+  }
+
+  // If set, the trace in this file is converted to the chrome format. The
+  // recorder must not be writing to it anymore.
+  void set_trace_filename(const std::string &trace_filename) {
+    trace_filename_ = trace_filename;
+  }
+
+  // If set, only this many of the most recent interval profiles are kept
+  // after the profile is written, the rest are deleted.
+  void set_interval_retention(int count) {
+    interval_retention_ = count;
+  }
+
+  // The job takes ownership of the snapshots.
+  void set_stats(const amxprof::Statistics *stats) {
+    stats_ = stats;
+  }
+  void set_call_graph(const amxprof::CallGraph *call_graph) {
+    call_graph_ = call_graph;
+  }
+  void set_call_context_tree(const amxprof::CallContextTree *tree) {
+    call_context_tree_ = tree;
+  }
+  void set_line_statistics(const amxprof::LineStatistics *line_stats) {
+    line_stats_ = line_stats;
+  }
+
+  // Makes the job write the difference between stats and base instead of
+  // the statistics set with set_stats(). The difference is computed on the
+  // worker thread. The job takes ownership of base but not of stats, which
+  // must not be modified or destroyed until the job is done.
+  void set_interval_stats(const amxprof::Statistics *stats,
+                          const amxprof::Statistics *base) {
+    interval_stats_ = stats;
+    interval_base_ = base;
+  }
+
+  // Runs the job on a new thread. Throws SystemError if the thread
+  // couldn't be created.
+  void Start();
+  void Join();
+
+  bool is_done() const;
+
+  // Only valid after the job is done.
+  const std::vector<std::string> &messages() const { return messages_; }
+  amxprof::Nanoseconds duration() const { return end_time_ - start_time_; }
+
+  virtual void Run();
+
+ private:
+  void Log(const std::string &message);
+
+  void WriteProfile();
+  void WriteCallGraph();
+  void WriteLineStatistics();
+  void WriteCallTree();
+  void RemoveOldIntervalProfiles();
+  void WriteTrace();
+
+ private:
+  std::string amx_path_;
+  std::string amx_name_;
+  std::string output_format_;
+  std::string profile_filename_;
+  std::string trace_filename_;
+  const amxprof::DebugInfo *debug_info_;
+  int interval_retention_;
+  const amxprof::Statistics *stats_;
+  const amxprof::CallGraph *call_graph_;
+  const amxprof::CallContextTree *call_context_tree_;
+  const amxprof::LineStatistics *line_stats_;
+  const amxprof::Statistics *interval_stats_;
+  const amxprof::Statistics *interval_base_;
+  std::vector<std::string> messages_;
+  amxprof::TimePoint start_time_;
+  amxprof::TimePoint end_time_;
+  amxprof::Thread thread_;
+  volatile bool done_;
+};
+
+// static
+void ProfilerHandler::Init() {
+  std::string clock = cfg::clock;
+  stringutils::ToLower(clock);
+
+  try {
+    if (clock == "tsc") {
+      if (!amxprof::Clock::SetSource(amxprof::Clock::TSC)) {
+        Printf("TSC is not available or not invariant, "
+               "using monotonic clock");
+      }
+    } else if (clock == "coarse") {
+      if (!amxprof::Clock::SetSource(amxprof::Clock::MONOTONIC_COARSE)) {
+        Printf("Coarse clock is not available, using monotonic clock");
+      }
+    } else if (clock != "monotonic") {
+      Printf("Unsupported clock '%s', using monotonic clock", clock.c_str());
+    }
+  } catch (const std::exception &e) {
+    PrintException(e);
+  }
+
+  std::string mode = cfg::mode;
+  stringutils::ToLower(mode);
+
+  try {
+    if (mode == "sampling") {
+      amxprof::Microseconds interval(cfg::sampling_interval);
+      if (interval.count() > 0 && amxprof::Sampler::IsSupported()) {
+        amxprof::Sampler::set_interval(interval);
+        profiler_mode = PROFILER_MODE_SAMPLING;
+      } else {
+        Printf("Sampling is not supported on this system, "
+               "using instrumentation");
+      }
+    } else if (mode == "bytecode") {
+      profiler_mode = PROFILER_MODE_BYTECODE;
+    } else if (mode != "instrumentation") {
+      Printf("Unsupported mode '%s', using instrumentation", mode.c_str());
+    }
+  } catch (const std::exception &e) {
+    PrintException(e);
+  }
+
+  std::string histograms = cfg::histograms;
+  stringutils::ToLower(histograms);
+
+  if (histograms == "none") {
+    histogram_mode = amxprof::Profiler::HISTOGRAMS_NONE;
+  } else if (histograms == "all") {
+    histogram_mode = amxprof::Profiler::HISTOGRAMS_ALL;
+  } else if (histograms != "publics") {
+    Printf("Unsupported histograms option '%s', using publics",
+           histograms.c_str());
+  }
+
+  // Samples don't tell how long individual calls take.
+  if (profiler_mode == PROFILER_MODE_SAMPLING) {
+    histogram_mode = amxprof::Profiler::HISTOGRAMS_NONE;
+  }
+
+  if (cfg::dump_interval > 0) {
+    if (GetOutputFormat() == "chrome") {
+      Printf("Interval dumps are not supported with the chrome output "
+             "format");
+    } else {
+      interval_dumps_enabled = true;
+    }
+  }
+}
+
+// static
+ProfilerMode ProfilerHandler::GetMode() {
+  return profiler_mode;
+}
+
 ProfilerHandler::ProfilerHandler(AMX *amx)
  : AMXHandler<ProfilerHandler>(amx),
    prev_debug_(amx->debug),
    prev_callback_(amx->callback),
-   profiler_(amx, IsCallGraphEnabled()),
+   profiler_(amx, IsCallGraphNeeded()),
+   sampler_(0),
+   call_context_tree_(0),
+   line_stats_(0),
+   trace_recorder_(0),
+   num_traces_(0),
+   time_series_recorder_(0),
+   dump_job_(0),
+   interval_stats_(0),
+   code_patcher_(amx),
    state_(PROFILER_DISABLED)
 {
+  profiler_.set_histogram_mode(histogram_mode);
+  if (profiler_mode == PROFILER_MODE_SAMPLING) {
+    sampler_ = new amxprof::Sampler(amx, kSampleBufferSize);
+  }
+  if (cfg::call_tree) {
+    call_context_tree_ = new amxprof::CallContextTree(
+      cfg::call_tree_max_depth,
+      cfg::call_tree_max_nodes);
+    profiler_.set_call_context_tree(call_context_tree_);
+  }
+  if (cfg::lines) {
+    if (profiler_mode == PROFILER_MODE_SAMPLING) {
+      Printf("Line statistics are not supported in sampling mode");
+    } else if (profiler_mode == PROFILER_MODE_BYTECODE) {
+      // Most BREAK instructions are removed in this mode, so the debug hook
+      // doesn't see most lines.
+      Printf("Line statistics are not supported in bytecode mode");
+    } else {
+      line_stats_ = new amxprof::LineStatistics(amx);
+      profiler_.set_line_statistics(line_stats_);
+    }
+  }
+  if (cfg::trace) {
+    if (profiler_mode == PROFILER_MODE_SAMPLING) {
+      Printf("Tracing is not supported in sampling mode");
+    } else {
+      trace_recorder_ = new amxprof::TraceRecorder(cfg::trace_buffer_size);
+    }
+  }
+  if (cfg::time_series_interval > 0) {
+    time_series_recorder_ = new amxprof::TimeSeriesRecorder;
+  }
+}
+
+ProfilerHandler::~ProfilerHandler() {
+  FinishDump(true);
+  delete interval_stats_;
+  delete sampler_;
+  delete call_context_tree_;
+  delete line_stats_;
+  delete trace_recorder_;
+  delete time_series_recorder_;
 }
 
 int ProfilerHandler::Load() {
@@ -169,6 +493,9 @@ int ProfilerHandler::Load() {
 }
 
 int ProfilerHandler::Unload() {
+  StopTrace();
+  StopTimeSeries();
+  code_patcher_.Restore();
   return AMX_ERR_NONE;
 }
 
@@ -198,7 +525,8 @@ int ProfilerHandler::Callback(cell index, cell *result, cell *params) {
 }
 
 int ProfilerHandler::Exec(cell *retval, int index) {
-  if (profiler_.call_stack()->is_empty()) {
+  if (!IsExecuting()) {
+    FinishDump(false);
     switch (state_) {
       case PROFILER_ATTACHING:
         if (!Attach()) {
@@ -209,12 +537,35 @@ int ProfilerHandler::Exec(cell *retval, int index) {
         CompleteStart();
         break;
     }
+    if (state_ == PROFILER_STARTED) {
+      try {
+        if (profiler_.has_missed_functions()) {
+          profiler_.DiscoverFunctions();
+        }
+        profiler_.ReserveCallGraph();
+      } catch (const std::exception &e) {
+        PrintException(e);
+      }
+    }
+    if (state_ == PROFILER_STARTED && interval_dumps_enabled) {
+      DumpIntervalIfDue();
+    }
+    if (state_ == PROFILER_STARTED && time_series_recorder_ != 0) {
+      RecordTimeSeriesIfDue();
+    }
   }
   if (state_ == PROFILER_STARTED) {
     try {
-      int error = profiler_.ExecHook(retval, index, amx_Exec);
-      if (state_ == PROFILER_STOPPING
-          && profiler_.call_stack()->is_empty()) {
+      int error;
+      if (sampler_ != 0) {
+        error = sampler_->ExecHook(retval, index, amx_Exec);
+        if (!sampler_->is_executing()) {
+          CollectSamples();
+        }
+      } else {
+        error = profiler_.ExecHook(retval, index, amx_Exec);
+      }
+      if (state_ == PROFILER_STOPPING && !IsExecuting()) {
         CompleteStop();
       }
       return error;
@@ -238,6 +589,9 @@ bool ProfilerHandler::Attach() {
       return false;
     }
 
+    // The debug info is loaded only once and shared with dump jobs, so
+    // dumps keep describing the running code after the script has been
+    // recompiled.
     if (amxprof::HasDebugInfo(amx())) {
       if (debug_info_.Load(amx_path_)) {
         profiler_.set_debug_info(&debug_info_);
@@ -247,6 +601,18 @@ bool ProfilerHandler::Attach() {
       }
     }
 
+    profiler_.DiscoverFunctions();
+
+    if (profiler_mode == PROFILER_MODE_BYTECODE) {
+      int num_removed = code_patcher_.RemoveRedundantBreaks();
+      if (num_removed >= 0) {
+        Printf("Removed %d redundant BREAK instructions", num_removed);
+      } else {
+        Printf("Could not analyze code of %s, debug hook will run on "
+               "every line", amx_name_.c_str());
+      }
+    }
+
     if (debug_info_.is_loaded()) {
       Printf("Attached profiler to %s", amx_name_.c_str());
     } else {
@@ -275,6 +641,25 @@ bool ProfilerHandler::Start() {
 }
 
 void ProfilerHandler::CompleteStart() {
+  try {
+    // Pick up natives registered after the profiler was attached.
+    profiler_.DiscoverFunctions();
+  } catch (const std::exception &e) {
+    PrintException(e);
+  }
+  if (interval_dumps_enabled && interval_stats_ == 0) {
+    interval_stats_ = profiler_.stats()->Snapshot();
+    last_interval_dump_time_ = amxprof::Clock::Now();
+  }
+  if (sampler_ != 0) {
+    try {
+      sampler_->Start();
+    } catch (const std::exception &e) {
+      PrintException(e);
+    }
+  }
+  StartTrace();
+  StartTimeSeries();
   Printf("Started profiling %s", amx_name_.c_str());
   state_ = PROFILER_STARTED;
 }
@@ -288,18 +673,154 @@ bool ProfilerHandler::Stop() {
 }
 
 void ProfilerHandler::CompleteStop() {
+  if (sampler_ != 0) {
+    sampler_->Stop();
+  }
+  StopTrace();
+  StopTimeSeries();
   Printf("Stopped profiling %s", amx_name_.c_str());
   state_ = PROFILER_STOPPED;
 }
 
-bool ProfilerHandler::Dump() const {
+void ProfilerHandler::StartTrace() {
+  if (trace_recorder_ == 0 || trace_recorder_->is_started()) {
+    return;
+  }
+  std::ostringstream trace_filename;
+  trace_filename << amx_name_ << "-trace";
+  if (num_traces_ > 0) {
+    trace_filename << "-" << num_traces_ + 1;
+  }
+  trace_filename << ".bin";
+  try {
+    if (trace_recorder_->Start(trace_filename.str())) {
+      Printf("Writing trace to %s", trace_filename.str().c_str());
+      profiler_.set_trace_recorder(trace_recorder_);
+      trace_filename_ = trace_filename.str();
+      num_traces_++;
+    } else {
+      Printf("Error opening %s for writing", trace_filename.str().c_str());
+    }
+  } catch (const std::exception &e) {
+    PrintException(e);
+  }
+}
+
+void ProfilerHandler::ExportTrace(DumpJob *job) {
+  if (trace_recorder_ == 0) {
+    Printf("The chrome output format requires profiler_trace to be enabled");
+    return;
+  }
+  if (trace_filename_.empty()) {
+    Printf("No trace has been recorded for %s", amx_name_.c_str());
+    return;
+  }
+
+  // The trace file is only complete after the recorder has been stopped.
+  bool restart = trace_recorder_->is_started();
+  StopTrace();
+  job->set_trace_filename(trace_filename_);
+  if (restart) {
+    StartTrace();
+  }
+}
+
+void ProfilerHandler::StopTrace() {
+  if (trace_recorder_ == 0 || !trace_recorder_->is_started()) {
+    return;
+  }
+  profiler_.set_trace_recorder(0);
+  trace_recorder_->Stop(profiler_.stats());
+  if (trace_recorder_->num_dropped_events() > 0) {
+    Printf("Trace events dropped due to full buffer: %ld",
+           trace_recorder_->num_dropped_events());
+  }
+}
+
+void ProfilerHandler::StartTimeSeries() {
+  if (time_series_recorder_ == 0 || time_series_recorder_->is_started()) {
+    return;
+  }
+  std::string time_series_filename = amx_name_ + "-timeseries.jsonl";
+  try {
+    if (sampler_ != 0) {
+      CollectSamples();
+    }
+    if (time_series_recorder_->Start(time_series_filename,
+                                     profiler_.stats())) {
+      Printf("Writing time series to %s", time_series_filename.c_str());
+    } else {
+      Printf("Error opening %s for writing", time_series_filename.c_str());
+    }
+  } catch (const std::exception &e) {
+    PrintException(e);
+  }
+}
+
+void ProfilerHandler::RecordTimeSeriesIfDue() {
+  if (!time_series_recorder_->is_started()) {
+    return;
+  }
+  amxprof::Seconds interval(cfg::time_series_interval);
+  amxprof::TimePoint now = amxprof::Clock::Now();
+  if (now - time_series_recorder_->last_record_time() < interval) {
+    return;
+  }
+  if (sampler_ != 0) {
+    CollectSamples();
+  }
+  time_series_recorder_->RecordInterval(profiler_.stats());
+}
+
+void ProfilerHandler::StopTimeSeries() {
+  if (time_series_recorder_ == 0 || !time_series_recorder_->is_started()) {
+    return;
+  }
+  try {
+    if (sampler_ != 0) {
+      CollectSamples();
+    }
+    time_series_recorder_->RecordInterval(profiler_.stats());
+  } catch (const std::exception &e) {
+    PrintException(e);
+  }
+  time_series_recorder_->Stop();
+}
+
+bool ProfilerHandler::IsExecuting() const {
+  if (sampler_ != 0) {
+    return sampler_->is_executing();
+  }
+  return !profiler_.call_stack()->is_empty();
+}
+
+void ProfilerHandler::CollectSamples() {
+  SampleCollector collector(&profiler_);
+  sampler_->ReadSamples(&collector);
+}
+
+bool ProfilerHandler::Dump(bool wait) {
   try {
     if (state_ < PROFILER_ATTACHED) {
       return false;
     }
 
+    FinishDump(wait);
+    if (dump_job_ != 0) {
+      Printf("Previous dump of %s is still in progress", amx_name_.c_str());
+      return false;
+    }
+
     Printf("Dumping profiling statistics for %s", amx_name_.c_str());
 
+    if (sampler_ != 0) {
+      CollectSamples();
+      if (sampler_->num_dropped_samples() > 0) {
+        Printf("Samples dropped due to full buffer: %ld",
+               sampler_->num_dropped_samples());
+      }
+    }
+
     std::vector<amxprof::FunctionStatistics*> fn_stats;
     profiler_.stats()->GetStatistics(fn_stats);
 
@@ -330,81 +851,390 @@ bool ProfilerHandler::Dump() const {
            num_other_functions);
     Printf("Total function calls logged: %ld", num_calls);
 
-    std::string output_format = cfg::output_format;
-    if (output_format.empty()) {
-      output_format = cfg::old::profile_format;
+    if (profiler_.call_graph()->num_dropped_calls() > 0) {
+      Printf("Calls missing from the call graph: %ld",
+             profiler_.call_graph()->num_dropped_calls());
+    }
+    if (call_context_tree_ != 0) {
+      Printf("Call tree nodes: %d (max. %d), truncated calls: %ld",
+             call_context_tree_->num_nodes() - 1,
+             call_context_tree_->max_nodes(),
+             call_context_tree_->num_truncated_calls());
+    }
+
+    std::string output_format = GetOutputFormat();
+
+    DumpJob *job = new DumpJob(amx_path_, amx_name_);
+    if (output_format == "chrome") {
+      ExportTrace(job);
+      output_format.clear();
+    }
+    job->set_output_format(output_format);
+    job->set_profile_filename(amx_name_ + "-profile." + output_format);
+    if (debug_info_.is_loaded()) {
+      job->set_debug_info(&debug_info_);
     }
-    stringutils::ToLower(output_format);
-    std::string profile_filename =
-        amx_name_ + "-profile." + output_format;
-    std::ofstream profile_stream(profile_filename.c_str());
 
-    if (profile_stream.is_open()) {
-      amxprof::StatisticsWriter *writer = 0;
+    const amxprof::Statistics *stats = profiler_.stats()->Snapshot();
+    job->set_stats(stats);
+    if (IsCallGraphNeeded()) {
+      job->set_call_graph(profiler_.call_graph()->Snapshot(stats));
+    }
+    if (call_context_tree_ != 0) {
+      job->set_call_context_tree(call_context_tree_->Snapshot(stats));
+    }
+    if (line_stats_ != 0) {
+      job->set_line_statistics(line_stats_->Snapshot());
+    }
 
-      if (output_format == "html") {
-        writer = new amxprof::StatisticsWriterHtml;
-      } else if (output_format == "txt" || output_format == "text") {
-        writer = new amxprof::StatisticsWriterText;
-      } else if (output_format == "json") {
-        writer = new amxprof::StatisticsWriterJson;
-      } else {
-        Printf("Unsupported output format '%s'", output_format.c_str());
+    StartDump(job);
+    return true;
+  }
+  catch (const std::exception &e) {
+    PrintException(e);
+  }
+  return false;
+}
+
+void ProfilerHandler::DumpIntervalIfDue() {
+  amxprof::Seconds interval(cfg::dump_interval);
+  if (amxprof::Clock::Now() - last_interval_dump_time_ < interval) {
+    return;
+  }
+  // If the previous dump is still being written, this interval is merged
+  // into the next one.
+  if (dump_job_ != 0) {
+    return;
+  }
+  DumpInterval();
+}
+
+void ProfilerHandler::DumpInterval() {
+  try {
+    if (sampler_ != 0) {
+      CollectSamples();
+    }
+
+    // The live counters are never reset: the interval profile is the
+    // difference between two snapshots. Only one snapshot is taken here,
+    // it's kept as the base of the next interval and the job computes the
+    // difference. No other dump can run until the job is done, so the
+    // snapshot isn't touched in the meantime.
+    const amxprof::Statistics *base = interval_stats_;
+    interval_stats_ = profiler_.stats()->Snapshot();
+    last_interval_dump_time_ = amxprof::Clock::Now();
+
+    std::string output_format = GetOutputFormat();
+
+    DumpJob *job = new DumpJob(amx_path_, amx_name_);
+    job->set_output_format(output_format);
+    job->set_profile_filename(amx_name_ + "-profile-" + GetFileTimeStamp()
+                              + "." + output_format);
+    if (debug_info_.is_loaded()) {
+      job->set_debug_info(&debug_info_);
+    }
+    job->set_interval_retention(cfg::dump_retention);
+    job->set_interval_stats(interval_stats_, base);
+
+    StartDump(job);
+  }
+  catch (const std::exception &e) {
+    PrintException(e);
+  }
+}
+
+void ProfilerHandler::StartDump(DumpJob *job) {
+  dump_job_ = job;
+  try {
+    job->Start();
+  } catch (const std::exception &e) {
+    PrintException(e);
+    job->Run();
+    FinishDump(true);
+  }
+}
+
+void ProfilerHandler::FinishDump(bool wait) {
+  if (dump_job_ == 0) {
+    return;
+  }
+  if (!wait && !dump_job_->is_done()) {
+    return;
+  }
+  dump_job_->Join();
+
+  const std::vector<std::string> &messages = dump_job_->messages();
+  for (std::vector<std::string>::const_iterator iterator = messages.begin();
+       iterator != messages.end(); ++iterator) {
+    Printf("%s", iterator->c_str());
+  }
+  Printf("Finished dumping profiling statistics for %s (%.1f ms)",
+         amx_name_.c_str(),
+         amxprof::Milliseconds(dump_job_->duration()).count());
+
+  delete dump_job_;
+  dump_job_ = 0;
+}
+
+ProfilerHandler::DumpJob::DumpJob(const std::string &amx_path,
+                                  const std::string &amx_name)
+ : amx_path_(amx_path),
+   amx_name_(amx_name),
+   debug_info_(0),
+   interval_retention_(0),
+   stats_(0),
+   call_graph_(0),
+   call_context_tree_(0),
+   line_stats_(0),
+   interval_stats_(0),
+   interval_base_(0),
+   thread_(this),
+   done_(false)
+{
+}
+
+ProfilerHandler::DumpJob::~DumpJob() {
+  thread_.Join();
+  // The call graph and tree refer to the function statistics.
+  delete call_graph_;
+  delete call_context_tree_;
+  delete line_stats_;
+  delete stats_;
+  delete interval_base_;
+}
+
+void ProfilerHandler::DumpJob::Start() {
+  start_time_ = amxprof::Clock::Now();
+  thread_.Start();
+}
+
+void ProfilerHandler::DumpJob::Join() {
+  thread_.Join();
+}
+
+bool ProfilerHandler::DumpJob::is_done() const {
+  amxprof::Thread::MemoryFence();
+  return done_;
+}
+
+void ProfilerHandler::DumpJob::Run() {
+  try {
+    if (interval_stats_ != 0 && stats_ == 0) {
+      amxprof::Statistics *delta = interval_stats_->Snapshot();
+      delta->Subtract(interval_base_);
+      stats_ = delta;
+    }
+
+    if (!output_format_.empty()) {
+      WriteProfile();
+      if (interval_retention_ > 0) {
+        RemoveOldIntervalProfiles();
       }
+    }
+    if (IsCallGraphEnabled() && call_graph_ != 0) {
+      WriteCallGraph();
+    }
+    if (line_stats_ != 0) {
+      WriteLineStatistics();
+    }
+    if (call_context_tree_ != 0) {
+      WriteCallTree();
+    }
+    if (!trace_filename_.empty()) {
+      WriteTrace();
+    }
+  } catch (const std::exception &e) {
+    Log(std::string("Error: ") + e.what());
+  }
+
+  end_time_ = amxprof::Clock::Now();
+  amxprof::Thread::MemoryFence();
+  done_ = true;
+}
+
+void ProfilerHandler::DumpJob::Log(const std::string &message) {
+  messages_.push_back(message);
+}
+
+void ProfilerHandler::DumpJob::WriteProfile() {
+  std::ofstream profile_stream(profile_filename_.c_str());
+
+  if (profile_stream.is_open()) {
+    amxprof::StatisticsWriter *writer = 0;
 
-      if (writer != 0) {
-        Printf("Writing profile to %s", profile_filename.c_str());
-        writer->set_stream(&profile_stream);
-        writer->set_script_name(amx_path_);
-        writer->set_print_date(true);
-        writer->set_print_run_time(true);
-        writer->Write(profiler_.stats());
-        delete writer;
+    if (output_format_ == "html") {
+      writer = new amxprof::StatisticsWriterHtml;
+    } else if (output_format_ == "txt" || output_format_ == "text") {
+      writer = new amxprof::StatisticsWriterText;
+    } else if (output_format_ == "json") {
+      writer = new amxprof::StatisticsWriterJson;
+    } else if (output_format_ == "callgrind") {
+      amxprof::StatisticsWriterCallgrind *callgrind_writer =
+        new amxprof::StatisticsWriterCallgrind;
+      callgrind_writer->set_call_graph(call_graph_);
+      if (debug_info_ != 0) {
+        callgrind_writer->set_debug_info(debug_info_);
+        callgrind_writer->set_line_statistics(line_stats_);
       }
+      writer = callgrind_writer;
+    } else {
+      Log("Unsupported output format '" + output_format_ + "'");
+    }
+
+    if (writer != 0) {
+      Log("Writing profile to " + profile_filename_);
+      writer->set_stream(&profile_stream);
+      writer->set_script_name(amx_path_);
+      writer->set_print_date(true);
+      writer->set_print_run_time(true);
+      writer->Write(stats_);
+      delete writer;
+    }
+
+    profile_stream.close();
+  } else {
+    Log("Error opening '" + profile_filename_ + "' for writing");
+  }
+}
+
+void ProfilerHandler::DumpJob::RemoveOldIntervalProfiles() {
+  // Time stamps in the file names sort in chronological order.
+  std::string directory = fileutils::GetDirectory(amx_path_);
+  std::string pattern = fileutils::GetBaseName(amx_path_)
+                      + "-profile-" + std::string(8, '?')
+                      + "-" + std::string(6, '?')
+                      + "." + output_format_;
+  std::vector<std::string> filenames;
+  fileutils::GetDirectoryFiles(directory, pattern, filenames);
+  std::sort(filenames.begin(), filenames.end());
+
+  int num_old = static_cast<int>(filenames.size()) - interval_retention_;
+  for (int i = 0; i < num_old; i++) {
+    std::string filename = directory + "/" + filenames[i];
+    if (std::remove(filename.c_str()) != 0) {
+      Log("Error removing " + filename);
+    }
+  }
+}
 
-      profile_stream.close();
+void ProfilerHandler::DumpJob::WriteTrace() {
+  amxprof::TraceReader reader;
+  if (!reader.Open(trace_filename_)) {
+    Log("Error reading trace from " + trace_filename_);
+    return;
+  }
+
+  // <script>-trace[-N].bin -> <script>-trace[-N].json
+  std::string json_filename =
+    trace_filename_.substr(0, trace_filename_.rfind('.')) + ".json";
+  std::ofstream json_stream(json_filename.c_str());
+
+  if (json_stream.is_open()) {
+    Log("Writing trace to " + json_filename);
+    amxprof::TraceWriterChrome writer;
+    writer.set_stream(&json_stream);
+    writer.set_script_name(amx_path_);
+    writer.Write(&reader);
+    json_stream.close();
+  } else {
+    Log("Error opening " + json_filename + " for writing");
+  }
+}
+
+void ProfilerHandler::DumpJob::WriteCallGraph() {
+  std::string call_graph_format = cfg::call_graph_format;
+  if (call_graph_format.empty()) {
+    call_graph_format = cfg::old::call_graph_format;
+  }
+  stringutils::ToLower(call_graph_format);
+  std::string call_graph_filename =
+      amx_name_ + "-calls." + call_graph_format;
+  std::ofstream call_graph_stream(call_graph_filename.c_str());
+
+  if (call_graph_stream.is_open()) {
+    amxprof::CallGraphWriterDot *writer = 0;
+
+    if (call_graph_format == "dot") {
+      writer = new amxprof::CallGraphWriterDot;
     } else {
-      Printf("Error opening '%s' for writing", profile_filename.c_str());
+      Log("Unsupported call graph format '" + call_graph_format + "'");
     }
 
-    if (IsCallGraphEnabled()) {
-      std::string call_graph_format = cfg::call_graph_format;
-      if (call_graph_format.empty()) {
-        call_graph_format = cfg::old::call_graph_format;
-      }
-      stringutils::ToLower(call_graph_format);
-      std::string call_graph_filename =
-          amx_name_ + "-calls." + call_graph_format;
-      std::ofstream call_graph_stream(call_graph_filename.c_str());
-
-      if (call_graph_stream.is_open()) {
-        amxprof::CallGraphWriterDot *writer = 0;
-
-        if (call_graph_format == "dot") {
-          writer = new amxprof::CallGraphWriterDot;
-        } else {
-          Printf("Unsupported call graph format '%s'",
-                  call_graph_format.c_str());
-        }
+    if (writer != 0) {
+      Log("Writing call graph to " + call_graph_filename);
+      writer->set_stream(&call_graph_stream);
+      writer->set_script_name(amx_path_);
+      writer->set_root_node_name("Server");
+      writer->Write(call_graph_);
+      delete writer;
+    }
 
-        if (writer != 0) {
-          Printf("Writing call graph to %s", call_graph_filename.c_str());
-          writer->set_stream(&call_graph_stream);
-          writer->set_script_name(amx_path_);
-          writer->set_root_node_name("Server");
-          writer->Write(profiler_.call_graph());
-          delete writer;
-        }
+    call_graph_stream.close();
+  } else {
+    Log("Error opening " + call_graph_filename + " for writing");
+  }
+}
 
-        call_graph_stream.close();
-      } else {
-        Printf("Error opening %s for writing", call_graph_filename.c_str());
-      }
+void ProfilerHandler::DumpJob::WriteLineStatistics() {
+  std::string lines_filename = amx_name_ + "-lines.txt";
+  std::ofstream lines_stream(lines_filename.c_str());
+
+  if (lines_stream.is_open()) {
+    Log("Writing line statistics to " + lines_filename);
+    amxprof::LineStatisticsWriterText writer;
+    writer.set_stream(&lines_stream);
+    writer.set_script_name(amx_path_);
+    if (debug_info_ != 0) {
+      writer.set_debug_info(debug_info_);
     }
-    return true;
+    writer.Write(line_stats_);
+    lines_stream.close();
+  } else {
+    Log("Error opening " + lines_filename + " for writing");
   }
-  catch (const std::exception &e) {
-    PrintException(e);
+}
+
+void ProfilerHandler::DumpJob::WriteCallTree() {
+  std::string call_tree_format = cfg::call_tree_format;
+  stringutils::ToLower(call_tree_format);
+  std::string call_tree_filename =
+      amx_name_ + "-calltree." + call_tree_format;
+  std::ios::openmode call_tree_mode = std::ios::out;
+  if (call_tree_format == "pprof") {
+    call_tree_mode |= std::ios::binary;
+  }
+  std::ofstream call_tree_stream(call_tree_filename.c_str(),
+                                 call_tree_mode);
+
+  if (call_tree_stream.is_open()) {
+    amxprof::CallTreeWriter *writer = 0;
+
+    if (call_tree_format == "txt" || call_tree_format == "text") {
+      writer = new amxprof::CallTreeWriterText;
+    } else if (call_tree_format == "folded") {
+      writer = new amxprof::CallTreeWriterFolded;
+    } else if (call_tree_format == "pprof") {
+      amxprof::CallTreeWriterPprof *pprof_writer =
+        new amxprof::CallTreeWriterPprof;
+      if (debug_info_ != 0) {
+        pprof_writer->set_debug_info(debug_info_);
+      }
+      writer = pprof_writer;
+    } else {
+      Log("Unsupported call tree format '" + call_tree_format + "'");
+    }
+
+    if (writer != 0) {
+      Log("Writing call tree to " + call_tree_filename);
+      writer->set_stream(&call_tree_stream);
+      writer->set_script_name(amx_path_);
+      writer->set_root_node_name("Server");
+      writer->Write(call_context_tree_);
+      delete writer;
+    }
+
+    call_tree_stream.close();
+  } else {
+    Log("Error opening " + call_tree_filename + " for writing");
   }
-  return false;
 }
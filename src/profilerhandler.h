@@ -26,6 +26,8 @@
 #define PROFILERHANDLER_H
 
 #include <configreader.h>
+#include <amxprof/clock.h>
+#include <amxprof/code_patcher.h>
 #include <amxprof/debug_info.h>
 #include <amxprof/profiler.h>
 #include "amxhandler.h"
@@ -42,11 +44,32 @@ enum ProfilerState {
   PROFILER_STOPPED
 };
 
+enum ProfilerMode {
+  PROFILER_MODE_INSTRUMENTATION,
+  PROFILER_MODE_BYTECODE,
+  PROFILER_MODE_SAMPLING
+};
+
+namespace amxprof {
+  class Sampler;
+  class TimeSeriesRecorder;
+}
+
 class AMXPathFinder;
 
 class ProfilerHandler : public AMXHandler<ProfilerHandler> {
  friend class AMXHandler<ProfilerHandler>;
 
+ public:
+  // Applies global settings from server.cfg. Must be called once when the
+  // plugin is loaded, before any scripts are profiled.
+  static void Init();
+
+  // Returns the profiling mode selected in server.cfg.
+  static ProfilerMode GetMode();
+
+  ~ProfilerHandler();
+
  public:
   void set_amx_path_finder(AMXPathFinder *finder) {
     amx_path_finder_ = finder;
@@ -64,14 +87,51 @@ class ProfilerHandler : public AMXHandler<ProfilerHandler> {
   bool Attach();
   bool Start();
   bool Stop();
-  bool Dump() const;
+
+  // Writes the statistics in the background. If the previous dump is still
+  // being written, waits for it to finish if wait is true, otherwise does
+  // nothing and returns false.
+  bool Dump(bool wait);
 
  private:
+  class DumpJob;
+
   ProfilerHandler(AMX *amx);
 
   void CompleteStart();
   void CompleteStop();
 
+  // Each trace after the first one goes to a new numbered file, so that
+  // a restarted trace doesn't overwrite one that is still being exported.
+  void StartTrace();
+  void StopTrace();
+
+  // Finishes the current trace and hands it over to the job for conversion
+  // to the chrome format. If the profiler is running, a new trace is started.
+  void ExportTrace(DumpJob *job);
+
+  // The time series is written while the profiler is running. Stopping it
+  // records the last, usually shorter, interval.
+  void StartTimeSeries();
+  void RecordTimeSeriesIfDue();
+  void StopTimeSeries();
+
+  // Reports the results of the current dump job and destroys it if it's
+  // done, or waits for it to finish if wait is true.
+  void FinishDump(bool wait);
+
+  // Writes the statistics collected since the previous interval dump if
+  // profiler_dumpinterval seconds have passed.
+  void DumpIntervalIfDue();
+  void DumpInterval();
+
+  // Takes ownership of the job and starts it. If no thread can be created,
+  // the job is run synchronously.
+  void StartDump(DumpJob *job);
+
+  bool IsExecuting() const;
+  void CollectSamples();
+
  private:
   AMXPathFinder *amx_path_finder_;
   std::string amx_path_;
@@ -79,7 +139,18 @@ class ProfilerHandler : public AMXHandler<ProfilerHandler> {
   AMX_DEBUG prev_debug_;
   AMX_CALLBACK prev_callback_;
   amxprof::Profiler profiler_;
+  amxprof::Sampler *sampler_;
+  amxprof::CallContextTree *call_context_tree_;
+  amxprof::LineStatistics *line_stats_;
+  amxprof::TraceRecorder *trace_recorder_;
+  std::string trace_filename_;
+  int num_traces_;
+  amxprof::TimeSeriesRecorder *time_series_recorder_;
+  DumpJob *dump_job_;
+  const amxprof::Statistics *interval_stats_;
+  amxprof::TimePoint last_interval_dump_time_;
   amxprof::DebugInfo debug_info_;
+  amxprof::CodePatcher code_patcher_;
   ProfilerState state_;
 };
 
@@ -0,0 +1,85 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "amxprof/call_context_tree.h"
+#include "amxprof/duration.h"
+#include "amxprof/function_statistics.h"
+#include "test.h"
+
+using namespace amxprof;
+
+TEST(CallContextTreeMaxDepth) {
+  FunctionStatistics f(0, 0);
+  FunctionStatistics g(0, 1);
+  CallContextTree tree(2, 100);
+
+  // f -> g -> f -> g: the last two calls are deeper than the limit and
+  // are accounted to the node of the second call.
+  tree.PushCall(&f);
+  tree.PushCall(&g);
+  tree.PushCall(&f);
+  tree.PushCall(&g);
+  tree.PopCall(Nanoseconds(1.0));
+  tree.PopCall(Nanoseconds(3.0));
+  tree.PopCall(Nanoseconds(10.0));
+  tree.PopCall(Nanoseconds(15.0));
+
+  EXPECT_EQ(3, tree.num_nodes());
+  EXPECT_EQ(2L, tree.num_truncated_calls());
+
+  const CallContextNode &f_node = tree.node(tree.root().first_child());
+  const CallContextNode &g_node = tree.node(f_node.first_child());
+  EXPECT_EQ(-1, g_node.first_child());
+  EXPECT_EQ(1L, g_node.num_calls());
+  EXPECT_EQ(10.0, g_node.total_time().count());
+  EXPECT_EQ(10.0, g_node.self_time().count());
+  EXPECT_EQ(15.0, f_node.total_time().count());
+  EXPECT_EQ(5.0, f_node.self_time().count());
+}
+
+TEST(CallContextTreeMaxNodes) {
+  FunctionStatistics f(0, 0);
+  FunctionStatistics g(0, 1);
+  FunctionStatistics h(0, 2);
+  CallContextTree tree(64, 3);
+  const CallContextNode *nodes = &tree.root();
+
+  // The root and f -> g fill the tree, f -> h doesn't get a node.
+  tree.PushCall(&f);
+  tree.PushCall(&g);
+  tree.PopCall(Nanoseconds(2.0));
+  tree.PushCall(&h);
+  tree.PopCall(Nanoseconds(4.0));
+  tree.PopCall(Nanoseconds(10.0));
+
+  EXPECT_EQ(3, tree.num_nodes());
+  EXPECT_EQ(1L, tree.num_truncated_calls());
+
+  const CallContextNode &f_node = tree.node(tree.root().first_child());
+  EXPECT_EQ(8.0, f_node.self_time().count());
+
+  // Nodes are never moved, because space for all of them is reserved when
+  // the tree is created.
+  EXPECT_TRUE(nodes == &tree.root());
+}
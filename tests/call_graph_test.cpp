@@ -0,0 +1,143 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <vector>
+#include "amxprof/call_graph.h"
+#include "amxprof/duration.h"
+#include "amxprof/function.h"
+#include "amxprof/function_statistics.h"
+#include "amxprof/statistics.h"
+#include "fake_amx.h"
+#include "test.h"
+
+using namespace amxprof;
+
+namespace {
+
+class Functions {
+ public:
+  explicit Functions(int count) : stats_(amx_.amx()) {
+    for (int i = 0; i < count; i++) {
+      Function *fn = Function::Normal(static_cast<Address>(i * sizeof(cell)));
+      functions_.push_back(fn);
+      stats_.AddFunction(fn);
+    }
+  }
+
+  ~Functions() {
+    for (std::size_t i = 0; i < functions_.size(); i++) {
+      delete functions_[i];
+    }
+  }
+
+  const Statistics *stats() const { return &stats_; }
+
+  FunctionStatistics *operator[](int index) {
+    return stats_.GetFunctionStatisticsByIndex(index);
+  }
+
+ private:
+  test::FakeAmx amx_;
+  Statistics stats_;
+  std::vector<Function*> functions_;
+};
+
+} // anonymous namespace
+
+TEST(CallGraphEdges) {
+  Functions functions(2);
+  CallGraph graph;
+  graph.AddNodes(functions.stats());
+
+  // f -> g -> f -> g: the inner calls add to the call counts but not to
+  // the total times of the edges.
+  graph.PushCall(functions[0]);
+  graph.PushCall(functions[1]);
+  graph.PushCall(functions[0]);
+  graph.PushCall(functions[1]);
+  graph.PopCall(Nanoseconds(1.0));
+  graph.PopCall(Nanoseconds(3.0));
+  graph.PopCall(Nanoseconds(6.0));
+  graph.PopCall(Nanoseconds(10.0));
+
+  EXPECT_EQ(3, graph.num_edges());
+  EXPECT_EQ(0L, graph.num_dropped_calls());
+
+  const CallGraphEdge &f_g = graph.edge(1);
+  EXPECT_TRUE(f_g.caller()->stats() == functions[0]);
+  EXPECT_TRUE(f_g.callee()->stats() == functions[1]);
+  EXPECT_EQ(2L, f_g.num_calls());
+  EXPECT_EQ(6.0, f_g.total_time().count());
+
+  const CallGraphEdge &g_f = graph.edge(2);
+  EXPECT_EQ(1L, g_f.num_calls());
+  EXPECT_EQ(3.0, g_f.total_time().count());
+
+  CallGraph *snapshot = graph.Snapshot(functions.stats());
+  const CallGraphNode *f = snapshot->edge(0).callee();
+  EXPECT_EQ(1, static_cast<int>(f->callee_edges().size()));
+  EXPECT_EQ(1, f->callee_edges()[0]);
+  delete snapshot;
+}
+
+TEST(CallGraphDoesNotAllocateInPushCall) {
+  Functions functions(100);
+  CallGraph graph;
+
+  // Calls to functions without nodes are not recorded.
+  graph.PushCall(functions[0]);
+  graph.PopCall(Nanoseconds(1.0));
+  EXPECT_EQ(0, graph.num_edges());
+  EXPECT_EQ(1L, graph.num_dropped_calls());
+
+  graph.AddNodes(functions.stats());
+
+  // Add edges until the reserved space runs out.
+  long num_calls = 0;
+  while (graph.num_dropped_calls() == 1) {
+    const CallGraphEdge *edges = graph.num_edges() > 0 ? &graph.edge(0) : 0;
+    int i = static_cast<int>(num_calls / 100);
+    int j = static_cast<int>(num_calls % 100);
+    graph.PushCall(functions[i % 100]);
+    graph.PushCall(functions[j]);
+    graph.PopCall(Nanoseconds(1.0));
+    graph.PopCall(Nanoseconds(2.0));
+    EXPECT_TRUE(edges == 0 || edges == &graph.edge(0));
+    num_calls++;
+  }
+
+  // Reserve() makes room for as many edges again.
+  int num_edges = graph.num_edges();
+  long num_dropped_calls = graph.num_dropped_calls();
+  graph.Reserve();
+  const CallGraphEdge *edges = &graph.edge(0);
+  for (int i = 0; i < num_edges; i++) {
+    graph.PushCall(functions[99]);
+    graph.PushCall(functions[i % 100]);
+    graph.PopCall(Nanoseconds(1.0));
+    graph.PopCall(Nanoseconds(2.0));
+  }
+  EXPECT_TRUE(edges == &graph.edge(0));
+  EXPECT_EQ(num_dropped_calls, graph.num_dropped_calls());
+}
@@ -0,0 +1,278 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <list>
+#include <vector>
+#include "amxprof/call_stack.h"
+#include "amxprof/function.h"
+#include "amxprof/function_call.h"
+#include "amxprof/function_statistics.h"
+#include "amxprof/performance_counter.h"
+#include "fake_clock.h"
+#include "test.h"
+
+using namespace amxprof;
+
+namespace {
+
+// Times of a single call as seen by Profiler::LeaveFunction().
+struct CallTimes {
+  int function;
+  Nanoseconds self_time;
+  Nanoseconds total_time;
+  Nanoseconds latest_self_time;
+  Nanoseconds latest_total_time;
+};
+
+// The way the shadow of a recursive call was found before CallStack kept
+// track of active calls per function: by walking up the parents of the
+// new call until one of the same function is found.
+class ParentWalkCallStack {
+ public:
+  void Push(int function) {
+    Call call;
+    call.function = function;
+    calls_.push_back(call);
+
+    PerformanceCounter *timer = &calls_.back().timer;
+    std::list<Call>::reverse_iterator iterator = ++calls_.rbegin();
+    if (iterator != calls_.rend()) {
+      timer->set_parent(&iterator->timer);
+    }
+    for (; iterator != calls_.rend(); ++iterator) {
+      if (iterator->function == function) {
+        timer->set_shadow(&iterator->timer);
+        break;
+      }
+    }
+    timer->Start();
+  }
+
+  CallTimes Pop() {
+    Call call = calls_.back();
+    calls_.pop_back();
+    call.timer.Stop();
+
+    CallTimes times;
+    times.function = call.function;
+    times.self_time = call.timer.self_time();
+    times.total_time = call.timer.total_time();
+    times.latest_self_time = call.timer.latest_self_time();
+    times.latest_total_time = call.timer.latest_total_time();
+    return times;
+  }
+
+ private:
+  struct Call {
+    int function;
+    PerformanceCounter timer;
+  };
+
+  std::list<Call> calls_;
+};
+
+// Runs the same sequence of calls through CallStack and through the
+// parent-walking implementation and records the times of each call.
+class CallStackComparison {
+ public:
+  explicit CallStackComparison(int num_functions) {
+    for (int i = 0; i < num_functions; i++) {
+      Address address = static_cast<Address>((i + 1) * sizeof(cell));
+      functions_.push_back(Function::Normal(address));
+      stats_.push_back(new FunctionStatistics(functions_.back(), i));
+    }
+  }
+
+  ~CallStackComparison() {
+    for (std::size_t i = 0; i < stats_.size(); i++) {
+      delete stats_[i];
+      delete functions_[i];
+    }
+  }
+
+  void Enter(int function) {
+    call_stack_.Push(stats_[function], 0);
+    reference_.Push(function);
+  }
+
+  void Work(long nanoseconds) {
+    test::AdvanceClock(Nanoseconds(nanoseconds));
+  }
+
+  void Leave() {
+    FunctionCall *call = call_stack_.Pop();
+
+    CallTimes times;
+    times.function = call->stats()->index();
+    times.self_time = call->timer()->self_time();
+    times.total_time = call->timer()->total_time();
+    times.latest_self_time = call->timer()->latest_self_time();
+    times.latest_total_time = call->timer()->latest_total_time();
+    times_.push_back(times);
+
+    reference_times_.push_back(reference_.Pop());
+  }
+
+  // Returns the call on top of the stack.
+  const FunctionCall *top() const { return call_stack_.top(); }
+
+  const FunctionStatistics *stats(int function) const {
+    return stats_[function];
+  }
+
+  void ExpectSameTimes() const {
+    EXPECT_EQ(reference_times_.size(), times_.size());
+    for (std::size_t i = 0;
+         i < times_.size() && i < reference_times_.size(); i++) {
+      const CallTimes &expected = reference_times_[i];
+      const CallTimes &actual = times_[i];
+      EXPECT_EQ(expected.function, actual.function);
+      EXPECT_EQ(expected.self_time.count(), actual.self_time.count());
+      EXPECT_EQ(expected.total_time.count(), actual.total_time.count());
+      EXPECT_EQ(expected.latest_self_time.count(),
+                actual.latest_self_time.count());
+      EXPECT_EQ(expected.latest_total_time.count(),
+                actual.latest_total_time.count());
+    }
+  }
+
+ private:
+  std::vector<Function*> functions_;
+  std::vector<FunctionStatistics*> stats_;
+  CallStack call_stack_;
+  ParentWalkCallStack reference_;
+  std::vector<CallTimes> times_;
+  std::vector<CallTimes> reference_times_;
+};
+
+} // anonymous namespace
+
+TEST(CallStackNonRecursiveCalls) {
+  CallStackComparison calls(3);
+
+  calls.Enter(0);
+  calls.Work(10);
+  calls.Enter(1);
+  EXPECT_TRUE(calls.top()->shadow() == 0);
+  calls.Work(20);
+  calls.Enter(2);
+  EXPECT_TRUE(calls.top()->shadow() == 0);
+  calls.Work(30);
+  calls.Leave();
+  calls.Leave();
+  calls.Enter(1);
+  EXPECT_TRUE(calls.top()->shadow() == 0);
+  calls.Work(40);
+  calls.Leave();
+  calls.Leave();
+
+  calls.ExpectSameTimes();
+}
+
+TEST(CallStackDirectRecursion) {
+  CallStackComparison calls(2);
+
+  calls.Enter(0);
+  calls.Work(10);
+  const FunctionCall *outer = calls.top();
+  calls.Enter(0);
+  EXPECT_TRUE(calls.top()->shadow() == outer);
+  calls.Work(20);
+  const FunctionCall *middle = calls.top();
+  calls.Enter(0);
+  EXPECT_TRUE(calls.top()->shadow() == middle);
+  EXPECT_EQ(3, calls.stats(0)->active_depth());
+  calls.Work(30);
+  calls.Enter(1);
+  EXPECT_TRUE(calls.top()->shadow() == 0);
+  calls.Work(5);
+  calls.Leave();
+  calls.Leave();
+  EXPECT_TRUE(calls.stats(0)->active_call() == middle);
+  calls.Work(40);
+  calls.Leave();
+  EXPECT_TRUE(calls.stats(0)->active_call() == outer);
+  calls.Work(50);
+  calls.Leave();
+  EXPECT_TRUE(calls.stats(0)->active_call() == 0);
+  EXPECT_EQ(0, calls.stats(0)->active_depth());
+
+  calls.ExpectSameTimes();
+}
+
+TEST(CallStackIndirectRecursion) {
+  CallStackComparison calls(3);
+
+  // 0 -> 1 -> 0 -> 1 -> 2, with 2 called again from the outer 1.
+  calls.Enter(0);
+  calls.Work(10);
+  const FunctionCall *outer0 = calls.top();
+  calls.Enter(1);
+  calls.Work(20);
+  const FunctionCall *outer1 = calls.top();
+  calls.Enter(0);
+  EXPECT_TRUE(calls.top()->shadow() == outer0);
+  calls.Work(30);
+  calls.Enter(1);
+  EXPECT_TRUE(calls.top()->shadow() == outer1);
+  calls.Work(40);
+  calls.Enter(2);
+  EXPECT_TRUE(calls.top()->shadow() == 0);
+  calls.Work(50);
+  calls.Leave();
+  calls.Work(60);
+  calls.Leave();
+  calls.Work(70);
+  calls.Leave();
+  calls.Work(80);
+  calls.Enter(2);
+  EXPECT_TRUE(calls.top()->shadow() == 0);
+  calls.Work(90);
+  calls.Leave();
+  calls.Leave();
+  calls.Work(100);
+  calls.Leave();
+
+  calls.ExpectSameTimes();
+}
+
+TEST(CallStackDeepRecursion) {
+  // Deep enough to span several chunks of the call stack.
+  const int kDepth = 1000;
+  CallStackComparison calls(2);
+
+  for (int i = 0; i < kDepth; i++) {
+    calls.Enter(i % 2);
+    calls.Work(i % 7 + 1);
+  }
+  EXPECT_EQ(kDepth / 2, calls.stats(0)->active_depth());
+  EXPECT_EQ(kDepth / 2, calls.stats(1)->active_depth());
+  for (int i = 0; i < kDepth; i++) {
+    calls.Work(i % 5 + 1);
+    calls.Leave();
+  }
+
+  calls.ExpectSameTimes();
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "amxprof/call_context_tree.h"
+#include "amxprof/call_tree_writer_folded.h"
+#include "amxprof/function.h"
+#include "amxprof/function_statistics.h"
+#include "fake_amx.h"
+#include "test.h"
+
+using namespace amxprof;
+
+namespace {
+
+// Functions named after natives of a fake AMX.
+class NamedFunctions {
+ public:
+  explicit NamedFunctions(const char *const *names) {
+    for (const char *const *name = names; *name != 0; name++) {
+      amx_.AddNative(*name);
+    }
+    for (std::size_t i = 0; names[i] != 0; i++) {
+      NativeTableIndex index = static_cast<NativeTableIndex>(i);
+      functions_.push_back(Function::Native(amx_.amx(), index));
+      stats_.push_back(new FunctionStatistics(functions_.back(), index));
+    }
+  }
+
+  ~NamedFunctions() {
+    for (std::size_t i = 0; i < stats_.size(); i++) {
+      delete stats_[i];
+      delete functions_[i];
+    }
+  }
+
+  FunctionStatistics *operator[](int index) { return stats_[index]; }
+
+ private:
+  test::FakeAmx amx_;
+  std::vector<Function*> functions_;
+  std::vector<FunctionStatistics*> stats_;
+};
+
+std::string WriteFolded(const CallContextTree *tree) {
+  std::ostringstream stream;
+  CallTreeWriterFolded writer;
+  writer.set_stream(&stream);
+  writer.Write(tree);
+  return stream.str();
+}
+
+} // anonymous namespace
+
+TEST(CallTreeWriterFoldedPaths) {
+  const char *names[] = {"OnPlayerUpdate", "GetPlayerPos", "SetTimer", 0};
+  NamedFunctions functions(names);
+  CallContextTree tree(64, 1000);
+
+  tree.PushCall(functions[0]);
+  tree.PushCall(functions[1]);
+  tree.PopCall(Nanoseconds(30));
+  tree.PushCall(functions[2]);
+  tree.PopCall(Nanoseconds(20));
+  tree.PopCall(Nanoseconds(100));
+
+  // Calls on the same path are added up.
+  tree.PushCall(functions[0]);
+  tree.PushCall(functions[1]);
+  tree.PopCall(Nanoseconds(5));
+  tree.PopCall(Nanoseconds(10));
+
+  // A path without self time is left out.
+  tree.PushCall(functions[2]);
+  tree.PushCall(functions[1]);
+  tree.PopCall(Nanoseconds(7));
+  tree.PopCall(Nanoseconds(7));
+
+  // Children are written starting from the most recently added one.
+  EXPECT_EQ(std::string("SetTimer;GetPlayerPos 7\n"
+                        "OnPlayerUpdate 55\n"
+                        "OnPlayerUpdate;SetTimer 20\n"
+                        "OnPlayerUpdate;GetPlayerPos 35\n"),
+            WriteFolded(&tree));
+}
+
+TEST(CallTreeWriterFoldedEscapesNames) {
+  const char *names[] = {"a;b", "with space", "tab\there", "new\nline", 0};
+  NamedFunctions functions(names);
+  CallContextTree tree(64, 1000);
+
+  tree.PushCall(functions[0]);
+  tree.PushCall(functions[1]);
+  tree.PushCall(functions[2]);
+  tree.PushCall(functions[3]);
+  tree.PopCall(Nanoseconds(1));
+  tree.PopCall(Nanoseconds(3));
+  tree.PopCall(Nanoseconds(6));
+  tree.PopCall(Nanoseconds(10));
+
+  EXPECT_EQ(std::string("a_b 4\n"
+                        "a_b;with_space 3\n"
+                        "a_b;with_space;tab_here 2\n"
+                        "a_b;with_space;tab_here;new_line 1\n"),
+            WriteFolded(&tree));
+}
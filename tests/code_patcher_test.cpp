@@ -0,0 +1,128 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <vector>
+#include "amxprof/amx_utils.h"
+#include "amxprof/code_patcher.h"
+#include "fake_amx.h"
+#include "test.h"
+
+using namespace amxprof;
+
+namespace {
+
+// Enumerators of unnamed enums can't be passed to templates in C++98.
+const cell kBreak = OP_BREAK;
+const cell kNop = OP_NOP;
+
+cell GetOpcode(test::FakeAmx &amx, Address address) {
+  return amx.code()[address / sizeof(cell)];
+}
+
+} // anonymous namespace
+
+TEST(CodePatcherRemoveRedundantBreaks) {
+  test::CodeBuilder code;
+
+  // f() {
+  //   new i = 0;
+  //   do {
+  //     g();
+  //     i++;
+  //   } while (i < 10);
+  // }
+  code.Emit(OP_PROC);
+  Address f_entry = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_STACK, -4);
+  code.Emit(OP_ZERO_S, -4);
+  Address loop = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_PUSH_C, 0);
+  Address call = code.offset();
+  code.EmitJump(OP_CALL);
+  Address after_call = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_INC_S, -4);
+  Address loop_end = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_LOAD_S_PRI, -4);
+  code.Emit(OP_CONST_ALT, 10);
+  code.EmitJump(OP_JSLESS, loop);
+  Address exit = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_STACK, 4);
+  code.Emit(OP_ZERO_PRI);
+  code.Emit(OP_RETN);
+
+  // g() {}
+  Address g = code.offset();
+  code.Emit(OP_PROC);
+  Address g_entry = code.offset();
+  code.Emit(OP_BREAK);
+  code.Emit(OP_ZERO_PRI);
+  code.Emit(OP_RETN);
+  code.SetTarget(call, g);
+
+  test::FakeAmx amx;
+  amx.SetCode(code.code(), code.targets());
+  std::vector<cell> original(amx.code(),
+                             amx.code() + code.code().size());
+
+  CodePatcher patcher(amx.amx());
+  EXPECT_EQ(3, patcher.RemoveRedundantBreaks());
+
+  // The hook must still run when a function is entered or a call returns.
+  EXPECT_EQ(kBreak, GetOpcode(amx, f_entry));
+  EXPECT_EQ(kBreak, GetOpcode(amx, after_call));
+  EXPECT_EQ(kBreak, GetOpcode(amx, g_entry));
+
+  // In the loop body (and after it) the frame is always the same as on the
+  // previous BREAK.
+  EXPECT_EQ(kNop, GetOpcode(amx, loop));
+  EXPECT_EQ(kNop, GetOpcode(amx, loop_end));
+  EXPECT_EQ(kNop, GetOpcode(amx, exit));
+
+  patcher.Restore();
+  EXPECT_TRUE(std::vector<cell>(amx.code(), amx.code() + original.size())
+              == original);
+}
+
+TEST(CodePatcherIndirectJump) {
+  test::CodeBuilder code;
+  code.Emit(OP_PROC);
+  code.Emit(OP_BREAK);
+  code.Emit(OP_ZERO_PRI);
+  code.Emit(OP_BREAK);
+  code.Emit(OP_JUMP_PRI);
+  code.Emit(OP_RETN);
+
+  test::FakeAmx amx;
+  amx.SetCode(code.code(), code.targets());
+
+  // The targets of the jump are unknown, so nothing can be removed.
+  CodePatcher patcher(amx.amx());
+  EXPECT_EQ(-1, patcher.RemoveRedundantBreaks());
+  EXPECT_EQ(kBreak, GetOpcode(amx, 3 * sizeof(cell)));
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <fstream>
+#include <amx/amx.h>
+#include <amx/amxdbg.h>
+#include "debug_info_builder.h"
+
+namespace amxprof {
+namespace test {
+
+namespace {
+
+template<typename T>
+void Append(std::string &data, T value) {
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string &data, const std::string &s) {
+  data.append(s.c_str(), s.length() + 1);
+}
+
+} // anonymous namespace
+
+DebugInfoBuilder::DebugInfoBuilder()
+ : num_files_(0),
+   num_lines_(0),
+   num_symbols_(0)
+{
+}
+
+void DebugInfoBuilder::AddFile(ucell address, const std::string &name) {
+  Append(files_, address);
+  AppendString(files_, name);
+  num_files_++;
+}
+
+void DebugInfoBuilder::AddLine(ucell address, int32_t line) {
+  Append(lines_, address);
+  Append(lines_, line);
+  num_lines_++;
+}
+
+void DebugInfoBuilder::AddSymbol(const std::string &name,
+                                 char ident,
+                                 ucell address,
+                                 ucell codestart,
+                                 ucell codeend,
+                                 int num_dims) {
+  Append(symbols_, address);
+  Append(symbols_, static_cast<uint16_t>(0));             // tag
+  Append(symbols_, codestart);
+  Append(symbols_, codeend);
+  Append(symbols_, ident);
+  Append(symbols_, static_cast<char>(0));                 // vclass
+  Append(symbols_, static_cast<uint16_t>(num_dims));
+  AppendString(symbols_, name);
+  for (int i = 0; i < num_dims; i++) {
+    Append(symbols_, static_cast<uint16_t>(0));           // tag
+    Append(symbols_, static_cast<ucell>(10));             // size
+  }
+  num_symbols_++;
+}
+
+void DebugInfoBuilder::AddFunction(const std::string &name,
+                                   ucell codestart,
+                                   ucell codeend) {
+  AddSymbol(name, iFUNCTN, codestart, codestart, codeend);
+}
+
+bool DebugInfoBuilder::Write(const std::string &filename) const {
+  AMX_DBG_HDR dbghdr = AMX_DBG_HDR();
+  dbghdr.size = static_cast<uint32_t>(sizeof(dbghdr)
+                                      + files_.size()
+                                      + lines_.size()
+                                      + symbols_.size());
+  dbghdr.magic = AMX_DBG_MAGIC;
+  dbghdr.files = static_cast<uint16_t>(num_files_);
+  dbghdr.lines = static_cast<uint16_t>(num_lines_);
+  dbghdr.symbols = static_cast<uint16_t>(num_symbols_);
+
+  AMX_HEADER amxhdr = AMX_HEADER();
+  amxhdr.size = sizeof(amxhdr);
+  amxhdr.magic = AMX_MAGIC;
+  amxhdr.flags = AMX_FLAG_DEBUG;
+  amxhdr.defsize = sizeof(AMX_FUNCSTUBNT);
+
+  std::ofstream file(filename.c_str(), std::ios::binary);
+  file.write(reinterpret_cast<const char*>(&amxhdr), sizeof(amxhdr));
+  file.write(reinterpret_cast<const char*>(&dbghdr), sizeof(dbghdr));
+  file.write(files_.data(), files_.size());
+  file.write(lines_.data(), lines_.size());
+  file.write(symbols_.data(), symbols_.size());
+  return file.good();
+}
+
+} // namespace test
+} // namespace amxprof
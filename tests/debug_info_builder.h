@@ -0,0 +1,71 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_DEBUG_INFO_BUILDER_H
+#define AMXPROF_DEBUG_INFO_BUILDER_H
+
+#include <string>
+#include "amxprof/amx_types.h"
+#include "amxprof/stdint.h"
+
+namespace amxprof {
+namespace test {
+
+// Writes an AMX file without code but with debug info made of the added
+// files, lines and symbols, in the layout produced by the Pawn compiler.
+// Entries are written in the order in which they are added.
+class DebugInfoBuilder {
+ public:
+  DebugInfoBuilder();
+
+  void AddFile(ucell address, const std::string &name);
+
+  // The line count in the header is 16 bits wide, so like in scripts
+  // compiled by the Pawn compiler it overflows after 65535 lines.
+  void AddLine(ucell address, int32_t line);
+
+  // Symbols with num_dims > 0 are followed by as many array dimensions.
+  void AddSymbol(const std::string &name,
+                 char ident,
+                 ucell address,
+                 ucell codestart,
+                 ucell codeend,
+                 int num_dims = 0);
+  void AddFunction(const std::string &name, ucell codestart, ucell codeend);
+
+  bool Write(const std::string &filename) const;
+
+ private:
+  std::string files_;
+  std::string lines_;
+  std::string symbols_;
+  int num_files_;
+  int num_lines_;
+  int num_symbols_;
+};
+
+} // namespace test
+} // namespace amxprof
+
+#endif // !AMXPROF_DEBUG_INFO_BUILDER_H
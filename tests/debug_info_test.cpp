@@ -0,0 +1,187 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <amx/amx.h>
+#include <amx/amxdbg.h>
+#include "amxprof/debug_info.h"
+#include "debug_info_builder.h"
+#include "test.h"
+
+using namespace amxprof;
+
+namespace {
+
+const char kFilename[] = "debug_info_test.amx";
+
+std::string ToString(const char *s) {
+  return s != 0 ? std::string(s) : std::string();
+}
+
+// Checks that DebugInfo gives the same results as amxdbg for all addresses
+// in [0, end).
+void ExpectSameAsAmxDbg(const test::DebugInfoBuilder &builder, ucell end) {
+  EXPECT_TRUE(builder.Write(kFilename));
+
+  DebugInfo debug_info(kFilename);
+  EXPECT_TRUE(debug_info.is_loaded());
+
+  AMX_DBG amxdbg;
+  FILE *fp = std::fopen(kFilename, "rb");
+  EXPECT_TRUE(fp != 0);
+  int error = dbg_LoadInfo(&amxdbg, fp);
+  std::fclose(fp);
+  EXPECT_TRUE(error == AMX_ERR_NONE);
+
+  if (debug_info.is_loaded() && error == AMX_ERR_NONE) {
+    for (ucell address = 0; address < end; address += sizeof(cell)) {
+      const char *name = 0;
+      long line = 0;
+
+      dbg_LookupFile(&amxdbg, address, &name);
+      EXPECT_EQ(ToString(name), debug_info.LookupFile(address));
+
+      dbg_LookupLine(&amxdbg, address, &line);
+      EXPECT_EQ(line, debug_info.LookupLine(address));
+
+      dbg_LookupFunction(&amxdbg, address, &name);
+      EXPECT_EQ(ToString(name), debug_info.LookupFunction(address));
+
+      dbg_LookupFunctionExact(&amxdbg, address, &name);
+      EXPECT_EQ(ToString(name), debug_info.LookupFunctionExact(address));
+    }
+  }
+
+  if (error == AMX_ERR_NONE) {
+    dbg_FreeInfo(&amxdbg);
+  }
+  debug_info.Unload();
+  std::remove(kFilename);
+}
+
+} // anonymous namespace
+
+TEST(DebugInfoLookups) {
+  test::DebugInfoBuilder builder;
+  builder.AddFile(0, "main.pwn");
+  builder.AddFile(40, "a.inc");
+  builder.AddFile(120, "main.pwn");
+  for (int i = 0; i < 50; i++) {
+    builder.AddLine(i * 4, i + 1);
+  }
+  builder.AddSymbol("global", iVARIABLE, 0, 0, 0);
+  builder.AddFunction("f", 0, 40);
+  builder.AddSymbol("local", iVARIABLE, -4, 8, 40);
+  builder.AddSymbol("array", iARRAY, -84, 12, 40, 2);
+  // Functions with a state have an '@' entry per state that covers the
+  // same code, those aren't reported.
+  builder.AddFunction("@g", 40, 80);
+  builder.AddFunction("g", 40, 80);
+  builder.AddFunction("@h", 80, 100);
+  // A gap between 100 and 120 that is in no function.
+  builder.AddFunction("i", 120, 200);
+  ExpectSameAsAmxDbg(builder, 240);
+}
+
+TEST(DebugInfoLineCountOverflow) {
+  // More than 65535 lines: the count in the header is what's left after
+  // the overflow.
+  const int kNumLines = 0x10000 + 100;
+  test::DebugInfoBuilder builder;
+  builder.AddFile(0, "main.pwn");
+  for (int i = 0; i < kNumLines; i++) {
+    builder.AddLine(i * 4, i + 1);
+  }
+  builder.AddFunction("f", 0, kNumLines * 4);
+  ExpectSameAsAmxDbg(builder, (kNumLines + 10) * 4);
+
+  EXPECT_TRUE(builder.Write(kFilename));
+  DebugInfo debug_info(kFilename);
+  EXPECT_EQ(static_cast<long>(kNumLines),
+            debug_info.LookupLine((kNumLines - 1) * 4));
+  debug_info.Unload();
+  std::remove(kFilename);
+}
+
+TEST(DebugInfoEmptyLineTable) {
+  test::DebugInfoBuilder builder;
+  builder.AddFile(0, "main.pwn");
+  builder.AddFunction("f", 0, 40);
+  builder.AddFunction("g", 40, 80);
+  ExpectSameAsAmxDbg(builder, 100);
+}
+
+TEST(DebugInfoEmptyLineTableBeforeLargeSymbolTable) {
+  // With no lines there is no last line to compare the first symbol with
+  // when checking whether the line count has overflowed. amxdbg reads the
+  // end of the file table instead, which here looks like a line with a
+  // lower address than the symbol, so it can't be compared with.
+  test::DebugInfoBuilder builder;
+  builder.AddFile(0, "main.pwn");
+  builder.AddSymbol("global", iVARIABLE, 0x40000000, 0, 0);
+  for (int i = 0; i < 30000; i++) {
+    std::ostringstream name;
+    name << "global" << i;
+    builder.AddSymbol(name.str(), iVARIABLE, i * sizeof(cell), 0, 0);
+  }
+  builder.AddFunction("f", 0, 40);
+  EXPECT_TRUE(builder.Write(kFilename));
+
+  DebugInfo debug_info(kFilename);
+  EXPECT_TRUE(debug_info.is_loaded());
+  EXPECT_EQ(0L, debug_info.LookupLine(0));
+  EXPECT_EQ(0L, debug_info.LookupLine(0x40000000));
+  EXPECT_EQ(std::string("main.pwn"), debug_info.LookupFile(0));
+  EXPECT_EQ(std::string("f"), debug_info.LookupFunction(20));
+  EXPECT_EQ(std::string("f"), debug_info.LookupFunctionExact(0));
+  debug_info.Unload();
+  std::remove(kFilename);
+}
+
+TEST(DebugInfoFileReplacedAfterLoad) {
+  test::DebugInfoBuilder builder;
+  builder.AddFile(0, "main.pwn");
+  builder.AddLine(0, 1);
+  builder.AddLine(20, 2);
+  builder.AddFunction("f", 0, 40);
+  EXPECT_TRUE(builder.Write(kFilename));
+
+  DebugInfo debug_info(kFilename);
+  EXPECT_TRUE(debug_info.is_loaded());
+
+  // Like recompiling the script: the file is truncated and written again.
+  test::DebugInfoBuilder new_builder;
+  new_builder.AddFile(0, "new.pwn");
+  new_builder.AddFunction("g", 0, 40);
+  EXPECT_TRUE(new_builder.Write(kFilename));
+
+  EXPECT_EQ(2L, debug_info.LookupLine(20));
+  EXPECT_EQ(std::string("main.pwn"), debug_info.LookupFile(20));
+  EXPECT_EQ(std::string("f"), debug_info.LookupFunction(20));
+  EXPECT_EQ(std::string("f"), debug_info.LookupFunctionExact(0));
+  debug_info.Unload();
+  std::remove(kFilename);
+}
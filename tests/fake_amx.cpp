@@ -0,0 +1,179 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <cstring>
+#include <amx/amx.h>
+#include "fake_amx.h"
+
+namespace amxprof {
+namespace test {
+
+FakeAmx::FakeAmx() {
+  std::memset(&amx_, 0, sizeof(amx_));
+  BuildImage();
+}
+
+NativeTableIndex FakeAmx::AddNative(const std::string &name) {
+  native_names_.push_back(name);
+  BuildImage();
+  return static_cast<NativeTableIndex>(native_names_.size() - 1);
+}
+
+void FakeAmx::SetCode(const std::vector<cell> &code,
+                      const std::vector<int> &targets) {
+  code_ = code;
+  targets_ = targets;
+  BuildImage();
+}
+
+cell *FakeAmx::code() {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(&image_[0]);
+  return reinterpret_cast<cell*>(&image_[0] + hdr->cod);
+}
+
+void FakeAmx::BuildImage() {
+  std::size_t natives = sizeof(AMX_HEADER);
+  std::size_t names = natives + native_names_.size() * sizeof(AMX_FUNCSTUBNT);
+  std::size_t cod = names;
+  for (std::size_t i = 0; i < native_names_.size(); i++) {
+    cod += native_names_[i].length() + 1;
+  }
+  cod = (cod + sizeof(cell) - 1) / sizeof(cell) * sizeof(cell);
+  std::size_t size = cod + code_.size() * sizeof(cell);
+
+  image_.assign(size, 0);
+
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(&image_[0]);
+  hdr->size = static_cast<int32_t>(size);
+  hdr->magic = AMX_MAGIC;
+  hdr->defsize = sizeof(AMX_FUNCSTUBNT);
+  hdr->publics = static_cast<int32_t>(natives);
+  hdr->natives = static_cast<int32_t>(natives);
+  hdr->libraries = static_cast<int32_t>(names);
+  hdr->pubvars = static_cast<int32_t>(names);
+  hdr->tags = static_cast<int32_t>(names);
+  hdr->nametable = static_cast<int32_t>(names);
+  hdr->cod = static_cast<int32_t>(cod);
+  hdr->dat = static_cast<int32_t>(size);
+
+  AMX_FUNCSTUBNT *stubs =
+    reinterpret_cast<AMX_FUNCSTUBNT*>(&image_[0] + natives);
+  std::size_t name_offset = names;
+  for (std::size_t i = 0; i < native_names_.size(); i++) {
+    // Natives only need distinct non-zero addresses.
+    stubs[i].address = static_cast<ucell>(i + 1);
+    stubs[i].nameofs = static_cast<uint32_t>(name_offset);
+    std::memcpy(&image_[name_offset],
+                native_names_[i].c_str(),
+                native_names_[i].length());
+    name_offset += native_names_[i].length() + 1;
+  }
+
+  if (!code_.empty()) {
+    std::memcpy(&image_[cod], &code_[0], code_.size() * sizeof(cell));
+    cell base = static_cast<cell>(
+      reinterpret_cast<std::size_t>(&image_[cod]));
+    for (std::size_t i = 0; i < targets_.size(); i++) {
+      code()[targets_[i]] += base;
+    }
+  }
+
+  amx_.base = &image_[0];
+}
+
+void CodeBuilder::Emit(cell opcode) {
+  code_.push_back(opcode);
+}
+
+void CodeBuilder::Emit(cell opcode, cell operand) {
+  code_.push_back(opcode);
+  code_.push_back(operand);
+}
+
+void CodeBuilder::EmitJump(cell opcode, Address target) {
+  code_.push_back(opcode);
+  targets_.push_back(static_cast<int>(code_.size()));
+  code_.push_back(target);
+}
+
+void CodeBuilder::SetTarget(Address instruction, Address target) {
+  code_[instruction / sizeof(cell) + 1] = target;
+}
+
+} // namespace test
+} // namespace amxprof
+
+// The AMX API is normally provided by the server. These are the parts the
+// profiler library uses, implemented just well enough for the tests.
+
+extern "C" {
+
+int AMXAPI amx_Exec(AMX *amx, cell *retval, int index) {
+  (void)index;
+  if ((amx->flags & AMX_FLAG_BROWSE) != 0) {
+    // Opcodes are not relocated: each opcode is its own number.
+    static cell opcode_table[256];
+    for (int i = 0; i < 256; i++) {
+      opcode_table[i] = i;
+    }
+    *reinterpret_cast<cell**>(retval) = opcode_table;
+  }
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Callback(AMX *amx, cell index, cell *result, cell *params) {
+  (void)amx;
+  (void)index;
+  (void)params;
+  *result = 0;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_Flags(AMX *amx, uint16_t *flags) {
+  *flags = amx->flags;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumNatives(AMX *amx, int *number) {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+  *number = (hdr->libraries - hdr->natives) / hdr->defsize;
+  return AMX_ERR_NONE;
+}
+
+int AMXAPI amx_NumPublics(AMX *amx, int *number) {
+  AMX_HEADER *hdr = reinterpret_cast<AMX_HEADER*>(amx->base);
+  *number = (hdr->natives - hdr->publics) / hdr->defsize;
+  return AMX_ERR_NONE;
+}
+
+uint16_t * AMXAPI amx_Align16(uint16_t *v) {
+  return v;
+}
+
+uint32_t * AMXAPI amx_Align32(uint32_t *v) {
+  return v;
+}
+
+} // extern "C"
@@ -0,0 +1,98 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_FAKE_AMX_H
+#define AMXPROF_FAKE_AMX_H
+
+#include <string>
+#include <vector>
+#include "amxprof/amx_types.h"
+#include "amxprof/macros.h"
+
+namespace amxprof {
+namespace test {
+
+// An AMX image with just a header, a table of natives and optionally some
+// code, for tests that need functions with particular names (see
+// Function::Native()) or code to analyze.
+class FakeAmx {
+ public:
+  FakeAmx();
+
+  // Adds a native and returns its index. The image is rebuilt, so
+  // pointers into it become invalid.
+  NativeTableIndex AddNative(const std::string &name);
+
+  // Replaces the code section. Opcodes are numbers from amx_utils.h. The
+  // cells at the given indexes are jump or call targets, which are given
+  // as offsets into the code and are converted to addresses like the VM
+  // does when it loads a script.
+  void SetCode(const std::vector<cell> &code,
+               const std::vector<int> &targets);
+
+  AMX *amx() { return &amx_; }
+  cell *code();
+
+ private:
+  void BuildImage();
+
+ private:
+  AMX amx_;
+  std::vector<std::string> native_names_;
+  std::vector<cell> code_;
+  std::vector<int> targets_;
+  std::vector<unsigned char> image_;
+
+ private:
+  AMXPROF_DISALLOW_COPY_AND_ASSIGN(FakeAmx);
+};
+
+// Assembles code for FakeAmx::SetCode().
+class CodeBuilder {
+ public:
+  // Offset of the next instruction.
+  Address offset() const {
+    return static_cast<Address>(code_.size() * sizeof(cell));
+  }
+
+  void Emit(cell opcode);
+  void Emit(cell opcode, cell operand);
+
+  // Emits an instruction with a jump or call target. Forward targets can
+  // be set later with SetTarget(), passing the offset of the instruction.
+  void EmitJump(cell opcode, Address target = 0);
+  void SetTarget(Address instruction, Address target);
+
+  const std::vector<cell> &code() const { return code_; }
+  const std::vector<int> &targets() const { return targets_; }
+
+ private:
+  std::vector<cell> code_;
+  std::vector<int> targets_;
+};
+
+} // namespace test
+} // namespace amxprof
+
+#endif // !AMXPROF_FAKE_AMX_H
@@ -0,0 +1,77 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "amxprof/duration.h"
+#include "amxprof/function_statistics.h"
+#include "test.h"
+
+using namespace amxprof;
+
+TEST(FunctionStatisticsSubtract) {
+  FunctionStatistics base(0);
+  base.AdjustNumCalls(2);
+  base.AdjustSelfTime(Nanoseconds(100.0));
+  base.AdjustTotalTime(Nanoseconds(300.0));
+
+  FunctionStatistics stats(0);
+  stats.AdjustNumCalls(5);
+  stats.AdjustSelfTime(Nanoseconds(250.0));
+  stats.AdjustTotalTime(Nanoseconds(1000.0));
+
+  stats.Subtract(&base);
+  EXPECT_EQ(3L, stats.num_calls());
+  EXPECT_EQ(150.0, stats.self_time().count());
+  EXPECT_EQ(700.0, stats.total_time().count());
+}
+
+TEST(FunctionStatisticsSubtractWorstTimes) {
+  FunctionStatistics base(0);
+  base.set_worst_self_time(Nanoseconds(5000.0));
+  base.set_worst_total_time(Nanoseconds(9000.0));
+
+  FunctionStatistics stats(0);
+  stats.set_worst_self_time(Nanoseconds(5000.0));
+  stats.set_worst_total_time(Nanoseconds(9000.0));
+
+  // Without histograms there is no way to tell when the worst call was
+  // made, so the worst times of the difference are unknown.
+  stats.Subtract(&base);
+  EXPECT_EQ(0.0, stats.worst_self_time().count());
+  EXPECT_EQ(0.0, stats.worst_total_time().count());
+
+  base.EnableHistograms();
+  base.RecordCall(Nanoseconds(5000.0), Nanoseconds(9000.0));
+
+  FunctionStatistics hist_stats(0);
+  hist_stats.EnableHistograms();
+  hist_stats.RecordCall(Nanoseconds(5000.0), Nanoseconds(9000.0));
+  hist_stats.RecordCall(Nanoseconds(10.0), Nanoseconds(20.0));
+  hist_stats.set_worst_self_time(Nanoseconds(5000.0));
+  hist_stats.set_worst_total_time(Nanoseconds(9000.0));
+
+  // Only the second call was made after the base snapshot.
+  hist_stats.Subtract(&base);
+  EXPECT_TRUE(hist_stats.worst_self_time() < Nanoseconds(100.0));
+  EXPECT_TRUE(hist_stats.worst_total_time() < Nanoseconds(100.0));
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "test.h"
+
+namespace amxprof {
+namespace test {
+
+namespace {
+
+struct TestInfo {
+  const char *name;
+  TestFunction function;
+};
+
+std::vector<TestInfo> &GetTests() {
+  // Registrars run during static initialization, possibly before globals
+  // of this file are constructed.
+  static std::vector<TestInfo> tests;
+  return tests;
+}
+
+bool current_test_failed = false;
+
+} // anonymous namespace
+
+TestRegistrar::TestRegistrar(const char *name, TestFunction function) {
+  TestInfo info;
+  info.name = name;
+  info.function = function;
+  GetTests().push_back(info);
+}
+
+int RunAllTests() {
+  const std::vector<TestInfo> &tests = GetTests();
+  int num_failed = 0;
+
+  for (std::size_t i = 0; i < tests.size(); i++) {
+    std::cout << "[ RUN    ] " << tests[i].name << std::endl;
+    current_test_failed = false;
+    tests[i].function();
+    if (current_test_failed) {
+      std::cout << "[ FAILED ] " << tests[i].name << std::endl;
+      num_failed++;
+    } else {
+      std::cout << "[     OK ] " << tests[i].name << std::endl;
+    }
+  }
+
+  std::cout << tests.size() - num_failed << " of " << tests.size()
+            << " tests passed" << std::endl;
+  return num_failed;
+}
+
+void Fail(const char *file, int line, const std::string &message) {
+  std::cout << file << ":" << line << ": Failure\n  " << message << std::endl;
+  current_test_failed = true;
+}
+
+} // namespace test
+} // namespace amxprof
+
+int main() {
+  return amxprof::test::RunAllTests() == 0 ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "amxprof/output_buffer.h"
+#include "amxprof/stdint.h"
+#include "test.h"
+
+using namespace amxprof;
+
+namespace {
+
+std::string FormatFixed(double value, int precision) {
+  std::ostringstream stream;
+  {
+    OutputBuffer out(&stream);
+    out << Fixed(value, precision);
+  }
+  return stream.str();
+}
+
+std::string FormatFixedWithStream(double value, int precision) {
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(precision) << value;
+  return stream.str();
+}
+
+void ExpectSameFixed(double value) {
+  for (int precision = 0; precision <= 9; precision++) {
+    EXPECT_EQ(FormatFixedWithStream(value, precision),
+              FormatFixed(value, precision));
+  }
+}
+
+// Values that are exactly halfway between two results, or within a few
+// units in the last place of it, at every precision.
+std::vector<double> GetNearTies() {
+  static const double kPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+  };
+  static const double kOffsets[] = {
+    0.0, 1e-15, -1e-15, 1e-12, -1e-12, 1e-9, -1e-9
+  };
+  std::vector<double> values;
+  for (int precision = 0; precision <= 9; precision++) {
+    for (int64_t n = 0; n < 2000; n += 7) {
+      double tie = (static_cast<double>(n) + 0.5) / kPowersOf10[precision];
+      for (std::size_t i = 0; i < sizeof(kOffsets) / sizeof(*kOffsets); i++) {
+        values.push_back(tie * (1.0 + kOffsets[i]));
+      }
+    }
+  }
+  return values;
+}
+
+} // anonymous namespace
+
+TEST(OutputBufferFixedMatchesStream) {
+  static const double kValues[] = {
+    0.0, 1.0, 0.1, 0.5, 1.5, 2.5, 0.125, 0.0005, 1.0005, 2.675, 1e-10,
+    123.456, 999.9999999999, 999999.9999995, 3.14159265358979,
+    // Around the limits of the fast path.
+    999999999.4, 999999999.5, 1e9, 1e9 + 0.5, 4294967296.5,
+    9.0e18, 9.2e18, 1.8446744073709552e19, 1e20, 1e300,
+    std::numeric_limits<double>::max(),
+    std::numeric_limits<double>::min(),
+    std::numeric_limits<double>::denorm_min(),
+    std::numeric_limits<double>::infinity(),
+    std::numeric_limits<double>::quiet_NaN()
+  };
+  for (std::size_t i = 0; i < sizeof(kValues) / sizeof(*kValues); i++) {
+    ExpectSameFixed(kValues[i]);
+    ExpectSameFixed(-kValues[i]);
+  }
+}
+
+TEST(OutputBufferFixedNearTies) {
+  std::vector<double> values = GetNearTies();
+  for (std::size_t i = 0; i < values.size(); i++) {
+    ExpectSameFixed(values[i]);
+    ExpectSameFixed(-values[i]);
+  }
+}
+
+TEST(OutputBufferFixedRandomValues) {
+  uint64_t state = 12345;
+  for (int i = 0; i < 10000; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    // Magnitudes from 1e-6 to 1e12, which covers times in any unit.
+    double mantissa = static_cast<double>(state >> 11) / 9007199254740992.0;
+    int exponent = static_cast<int>((state >> 3) % 19) - 6;
+    double value = mantissa;
+    for (int j = 0; j < exponent; j++) {
+      value *= 10;
+    }
+    for (int j = 0; j > exponent; j--) {
+      value /= 10;
+    }
+    ExpectSameFixed(value);
+    ExpectSameFixed(-value);
+  }
+}
+
+TEST(OutputBufferWidth) {
+  std::ostringstream stream;
+  std::ostringstream expected;
+  {
+    OutputBuffer out(&stream);
+    out << Left(8) << "abc" << '|'
+        << Right(8) << "abc" << '|'
+        << Right(8, '0') << 42 << '|'
+        << Left(8, '.') << -42L << '|'
+        << Right(10) << Fixed(-3.14159, 2) << '|'
+        << Left(10, '*') << Fixed(2.5, 0) << '|'
+        << Right(2) << "longer than width" << '|'
+        << "no width";
+    expected << std::left << std::setw(8) << "abc" << '|'
+             << std::right << std::setw(8) << "abc" << '|'
+             << std::setfill('0') << std::setw(8) << 42 << '|'
+             << std::left << std::setfill('.') << std::setw(8) << -42L << '|'
+             << std::setfill(' ')
+             << std::right << std::fixed << std::setprecision(2)
+             << std::setw(10) << -3.14159 << '|'
+             << std::left << std::setfill('*') << std::setprecision(0)
+             << std::setw(10) << 2.5 << '|'
+             << std::right << std::setw(2) << "longer than width" << '|'
+             << "no width";
+  }
+  EXPECT_EQ(expected.str(), stream.str());
+}
+
+TEST(OutputBufferWriteInteger) {
+  static const int64_t kValues[] = {
+    0, 1, -1, 9, 10, -10, 1234567890, -1234567890,
+    std::numeric_limits<int64_t>::max(),
+    std::numeric_limits<int64_t>::min()
+  };
+  for (std::size_t i = 0; i < sizeof(kValues) / sizeof(*kValues); i++) {
+    std::ostringstream stream;
+    std::ostringstream expected;
+    {
+      OutputBuffer out(&stream);
+      out.WriteInteger(kValues[i]);
+      out << Right(24);
+      out.WriteInteger(kValues[i]);
+      out << Left(24, '_');
+      out.WriteInteger(kValues[i]);
+    }
+    expected << kValues[i]
+             << std::setw(24) << kValues[i]
+             << std::left << std::setfill('_') << std::setw(24) << kValues[i];
+    EXPECT_EQ(expected.str(), stream.str());
+  }
+}
+
+TEST(OutputBufferSmallCapacity) {
+  // Writes that don't fit in the buffer go through WriteSlow() and Fill()
+  // flushes as it goes.
+  std::ostringstream stream;
+  std::string expected;
+  {
+    OutputBuffer out(&stream, 4);
+    out << "ab" << "cdefgh" << Right(10, '-') << "x" << Fixed(1.25, 1);
+    expected = "abcdefgh---------x1.2";
+  }
+  EXPECT_EQ(expected, stream.str());
+}
@@ -0,0 +1,293 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <string>
+#include "diff_report.h"
+#include "profile.h"
+#include "profile_diff.h"
+#include "test.h"
+
+namespace {
+
+const char kFilename[] = "profile_diff_test.json";
+
+// Builds a profile in the format written by StatisticsWriterJson.
+class ProfileBuilder {
+ public:
+  explicit ProfileBuilder(double duration) {
+    char buffer[64];
+    std::sprintf(buffer, "%g", duration);
+    json_ = "{\n  \"script\": \"test.amx\",\n  \"duration\": ";
+    json_ += buffer;
+    json_ += ",\n  \"functions\": [\n";
+  }
+
+  ProfileBuilder &Add(const char *type,
+                      const char *name,
+                      double calls,
+                      double self_time,
+                      double total_time) {
+    char buffer[256];
+    std::sprintf(buffer,
+                 "    {\"type\": \"%s\", \"name\": \"%s\", \"calls\": %.0f, "
+                 "\"selfTime\": %.0f, \"totalTime\": %.0f},\n",
+                 type, name, calls, self_time, total_time);
+    json_ += buffer;
+    return *this;
+  }
+
+  // Times are in nanoseconds.
+  ProfileBuilder &Add(const char *name, double self_time) {
+    return Add("normal", name, 1, self_time, self_time);
+  }
+
+  Profile Build() const {
+    Profile profile;
+    std::string error;
+    EXPECT_TRUE(profile.Parse(json_ + "    {}\n  ]\n}\n", error));
+    EXPECT_EQ(std::string(), error);
+    return profile;
+  }
+
+ private:
+  std::string json_;
+};
+
+const double kMs = 1e6;
+
+} // anonymous namespace
+
+TEST(ProfileParse) {
+  Profile profile;
+  std::string error;
+  EXPECT_TRUE(profile.Parse(
+    "{\n"
+    "  \"timestamp\": 1234567890,\n"
+    "  \"script\": \"gamemodes/\\\"test\\\"\\u00e9.amx\",\n"
+    "  \"duration\": 12.5,\n"
+    "  \"functions\": [\n"
+    "    {\"type\": \"public\", \"name\": \"OnGameModeInit\", \"calls\": 1,"
+    "     \"selfTime\": 100, \"worstSelfTime\": 100, \"totalTime\": 2.5e3,"
+    "     \"histogram\": {\"p50\": [1, 2, {\"x\": null}], \"ok\": true}},\n"
+    "    {\"type\": \"native\", \"name\": \"printf\", \"calls\": 3,"
+    "     \"selfTime\": 30, \"totalTime\": 30},\n"
+    "    {}\n"
+    "  ]\n"
+    "}\n",
+    error));
+  EXPECT_EQ(std::string(), error);
+  EXPECT_EQ(std::string("gamemodes/\"test\"\xC3\xA9.amx"), profile.script());
+  EXPECT_EQ(12.5, profile.duration());
+  EXPECT_EQ(2u, profile.functions().size());
+
+  const FunctionProfile &fn = profile.functions()[0];
+  EXPECT_EQ(std::string("public"), fn.type);
+  EXPECT_EQ(std::string("OnGameModeInit"), fn.name);
+  EXPECT_EQ(1.0, fn.calls);
+  EXPECT_EQ(100.0, fn.self_time);
+  EXPECT_EQ(2500.0, fn.total_time);
+  EXPECT_EQ(std::string("printf"), profile.functions()[1].name);
+}
+
+TEST(ProfileParseErrors) {
+  Profile profile;
+  std::string error;
+
+  EXPECT_TRUE(!profile.Parse("{\"functions\": [{\"name\": \"f\"", error));
+  EXPECT_TRUE(error.find("at offset") != std::string::npos);
+
+  error.clear();
+  EXPECT_TRUE(!profile.Parse("{\"functions\": [{\"calls\": x}]}", error));
+  EXPECT_EQ(std::string("expected a number at offset 25"), error);
+
+  error.clear();
+  EXPECT_TRUE(!profile.Parse("{\"script\": \"test.amx\"}", error));
+  EXPECT_EQ(std::string("no function list, is this a JSON profile?"), error);
+}
+
+TEST(ProfileLoad) {
+  std::FILE *file = std::fopen(kFilename, "wb");
+  EXPECT_TRUE(file != 0);
+  if (file != 0) {
+    std::fputs("{\"duration\": 2, \"functions\": "
+               "[{\"type\": \"normal\", \"name\": \"f\"}, {}]}", file);
+    std::fclose(file);
+  }
+
+  Profile profile;
+  std::string error;
+  EXPECT_TRUE(profile.Load(kFilename, error));
+  EXPECT_EQ(2.0, profile.duration());
+  EXPECT_EQ(1u, profile.functions().size());
+  std::remove(kFilename);
+
+  EXPECT_TRUE(!profile.Load(kFilename, error));
+  EXPECT_EQ(std::string("could not open file"), error);
+}
+
+TEST(ProfileDiffMergesFunctions) {
+  Profile old_profile = ProfileBuilder(10)
+    .Add("normal", "f", 10, 2 * kMs, 4 * kMs)
+    .Add("normal", "f", 10, 3 * kMs, 6 * kMs)   // same name, other file
+    .Add("public", "f", 1, 1 * kMs, 1 * kMs)    // same name, other type
+    .Add("normal", "gone", 1, 1 * kMs, 1 * kMs)
+    .Build();
+  Profile new_profile = ProfileBuilder(20)
+    .Add("normal", "added", 4, 8 * kMs, 8 * kMs)
+    .Add("normal", "f", 40, 20 * kMs, 40 * kMs)
+    .Build();
+
+  ProfileDiff diff;
+  diff.Compute(old_profile, new_profile);
+
+  // Sorted by type and name.
+  const std::vector<FunctionDiff> &functions = diff.functions();
+  EXPECT_EQ(4u, functions.size());
+  EXPECT_EQ(std::string("added"), functions[0].name);
+  EXPECT_EQ(std::string("f"), functions[1].name);
+  EXPECT_EQ(std::string("gone"), functions[2].name);
+  EXPECT_EQ(std::string("public"), functions[3].type);
+
+  EXPECT_TRUE(!functions[0].in_old && functions[0].in_new);
+  EXPECT_TRUE(functions[1].in_old && functions[1].in_new);
+  EXPECT_TRUE(functions[2].in_old && !functions[2].in_new);
+
+  // Values are per second of run time, absolute values aren't.
+  const FunctionDiff &f = functions[1];
+  EXPECT_EQ(5 * kMs, f.old_absolute_values[METRIC_SELF_TIME]);
+  EXPECT_EQ(0.5 * kMs, f.old_values[METRIC_SELF_TIME]);
+  EXPECT_EQ(20 * kMs, f.new_absolute_values[METRIC_SELF_TIME]);
+  EXPECT_EQ(1 * kMs, f.new_values[METRIC_SELF_TIME]);
+  EXPECT_EQ(2.0, f.old_values[METRIC_CALLS]);
+  EXPECT_EQ(0.5 * kMs, f.old_values[METRIC_AVERAGE_TIME]);
+  EXPECT_EQ(1 * kMs, f.new_values[METRIC_AVERAGE_TIME]);
+  EXPECT_EQ(100.0, f.GetRelativeChange(METRIC_SELF_TIME));
+
+  const FunctionDiff &total = diff.total();
+  EXPECT_EQ(7 * kMs, total.old_absolute_values[METRIC_SELF_TIME]);
+  EXPECT_EQ(28 * kMs, total.new_absolute_values[METRIC_SELF_TIME]);
+  EXPECT_EQ(1.4 * kMs, total.new_values[METRIC_SELF_TIME]);
+
+  diff.set_normalize(false);
+  diff.Compute(old_profile, new_profile);
+  EXPECT_EQ(5 * kMs, diff.functions()[1].old_values[METRIC_SELF_TIME]);
+}
+
+TEST(DiffReportThreshold) {
+  Profile old_profile = ProfileBuilder(1)
+    .Add("small_change", 100 * kMs)
+    .Add("big_change", 100 * kMs)
+    .Add("faster", 100 * kMs)
+    .Build();
+  Profile new_profile = ProfileBuilder(1)
+    .Add("small_change", 104 * kMs)
+    .Add("big_change", 110 * kMs)
+    .Add("faster", 50 * kMs)
+    .Build();
+
+  ProfileDiff diff;
+  diff.Compute(old_profile, new_profile);
+  DiffReport report((ReportOptions()));
+  report.Compute(diff);
+
+  EXPECT_EQ(3, report.num_matched());
+  EXPECT_EQ(1u, report.regressions().size());
+  EXPECT_EQ(std::string("big_change"), report.regressions()[0]->name);
+  EXPECT_EQ(1u, report.improvements().size());
+  EXPECT_EQ(std::string("faster"), report.improvements()[0]->name);
+  EXPECT_TRUE(!report.budget_exceeded());
+}
+
+TEST(DiffReportMinTimeUsesAbsoluteTimes) {
+  // 0.5 ms in 0.1 s is 5 ms per second, but the function is still below
+  // the minimum time of 1 ms.
+  Profile old_profile = ProfileBuilder(0.1).Add("f", 0.5 * kMs).Build();
+  Profile new_profile = ProfileBuilder(0.1).Add("f", 0.9 * kMs).Build();
+
+  ProfileDiff diff;
+  diff.Compute(old_profile, new_profile);
+  ReportOptions options;
+  options.min_time = 1 * kMs;
+  DiffReport report(options);
+  report.Compute(diff);
+  EXPECT_EQ(0u, report.regressions().size());
+
+  options.min_time = 0.9 * kMs;
+  DiffReport report2(options);
+  report2.Compute(diff);
+  EXPECT_EQ(1u, report2.regressions().size());
+}
+
+TEST(DiffReportBudget) {
+  Profile old_profile = ProfileBuilder(1)
+    .Add("f", 100 * kMs)
+    .Add("g", 100 * kMs)
+    .Build();
+  Profile new_profile = ProfileBuilder(1)
+    .Add("f", 120 * kMs)
+    .Add("g", 100 * kMs)
+    .Add("new", 10 * kMs)
+    .Build();
+
+  ProfileDiff diff;
+  diff.Compute(old_profile, new_profile);
+
+  ReportOptions options;
+  options.budget = 25;
+  DiffReport report(options);
+  report.Compute(diff);
+  // The new function is reported, but has no relative change to check
+  // against the budget.
+  EXPECT_EQ(2u, report.regressions().size());
+  EXPECT_EQ(1, report.num_added());
+  EXPECT_EQ(1, report.num_new_over_min_time());
+  EXPECT_EQ(0, report.num_over_budget());
+  EXPECT_TRUE(!report.budget_exceeded());
+
+  options.budget = 15;
+  DiffReport over_budget(options);
+  over_budget.Compute(diff);
+  EXPECT_EQ(1, over_budget.num_over_budget());
+  EXPECT_TRUE(over_budget.budget_exceeded());
+
+  options.budget = -1;
+  options.fail_on_new = true;
+  DiffReport fail_on_new(options);
+  fail_on_new.Compute(diff);
+  EXPECT_TRUE(fail_on_new.budget_exceeded());
+
+  // The total grows by 30 ms (15%), 10 ms of which are the new function.
+  options.fail_on_new = false;
+  options.total_budget = 12;
+  DiffReport total(options);
+  total.Compute(diff);
+  EXPECT_TRUE(total.total_over_budget());
+  EXPECT_TRUE(total.budget_exceeded());
+
+  options.total_budget = 16;
+  DiffReport total_ok(options);
+  total_ok.Compute(diff);
+  EXPECT_TRUE(!total_ok.budget_exceeded());
+}
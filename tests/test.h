@@ -0,0 +1,84 @@
+// Copyright (c) 2026 Zeex
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef AMXPROF_TEST_H
+#define AMXPROF_TEST_H
+
+#include <sstream>
+#include <string>
+
+namespace amxprof {
+namespace test {
+
+typedef void (*TestFunction)();
+
+// Adds a test to the list of tests run by RunAllTests(). Use the TEST
+// macro instead of creating these directly.
+class TestRegistrar {
+ public:
+  TestRegistrar(const char *name, TestFunction function);
+};
+
+// Runs all registered tests and returns the number of failed ones.
+int RunAllTests();
+
+// Marks the current test as failed.
+void Fail(const char *file, int line, const std::string &message);
+
+template<typename T, typename U>
+void ExpectEqual(const T &expected,
+                 const U &actual,
+                 const char *expected_text,
+                 const char *actual_text,
+                 const char *file,
+                 int line) {
+  if (!(expected == actual)) {
+    std::ostringstream message;
+    message << "Expected: " << expected_text << " == " << actual_text
+            << "\n  Expected value: " << expected
+            << "\n  Actual value: " << actual;
+    Fail(file, line, message.str());
+  }
+}
+
+} // namespace test
+} // namespace amxprof
+
+#define TEST(name) \
+  static void name##Test(); \
+  static amxprof::test::TestRegistrar name##Registrar(#name, name##Test); \
+  static void name##Test()
+
+#define EXPECT_TRUE(condition) \
+  do { \
+    if (!(condition)) { \
+      amxprof::test::Fail(__FILE__, __LINE__, "Expected: " #condition); \
+    } \
+  } while (false)
+
+#define EXPECT_EQ(expected, actual) \
+  amxprof::test::ExpectEqual((expected), (actual), #expected, #actual, \
+                             __FILE__, __LINE__)
+
+#endif // !AMXPROF_TEST_H